@@ -3,5 +3,5 @@ export PREFIX="$HOME/opt64/cross"
 export TARGET=x86_64-elf-cpp
 export PATH="$PREFIX/bin:$PATH"
 
-mkdir -p ./bin ./build ./build/mouse ./build/graphics ./build/graphics/image ./build/lib ./build/lib/vector ./build/loader ./build/loader/formats ./build/isr80h ./build/keyboard ./build/gdt ./build/disk ./build/disk/drivers ./build/task ./build/fs ./build/fs/fat ./build/memory ./build/io ./build/memory/paging ./build/memory/heap ./build/string ./build/idt  
+mkdir -p ./bin ./build ./build/mouse ./build/graphics ./build/graphics/image ./build/lib ./build/lib/vector ./build/lib/list ./build/lib/hashmap ./build/lib/tilegrid ./build/loader ./build/loader/formats ./build/isr80h ./build/keyboard ./build/gdt ./build/disk ./build/disk/drivers ./build/task ./build/fs ./build/fs/fat ./build/memory ./build/io ./build/boot ./build/memory/paging ./build/memory/heap ./build/memory/vma ./build/memory/frame ./build/string ./build/idt  
 make all
@@ -123,6 +123,9 @@ struct gui_element *gui_element_button_create(struct gui *gui, struct gui_elemen
         return NULL;
     }
 
+    // Only the text is drawn, the plane under it draws the background
+    btn_element->flags |= GUI_ELEMENT_REDRAW_WITH_PARENT;
+
     struct gui_button_element_private *button_element_private_data = calloc(1, sizeof(struct gui_button_element_private));
     if (!button_element_private_data)
     {
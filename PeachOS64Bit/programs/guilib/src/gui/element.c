@@ -53,6 +53,7 @@
 struct framebuffer_pixel;
 
 void gui_element_focus(struct gui_element *element);
+static void gui_element_unlink(struct gui_element *element);
 
 GUI_EVENT_HANDLER_RESPONSE gui_element_event_handler(struct gui_event *gui_event)
 {
@@ -107,11 +108,92 @@ void gui_element_draw(struct gui_element *element)
 
     // Call the function. element shall draw its self
     element->functions.draw(element);
+    gui_element_redrawn(element);
 
     // Let's now draw the childen, its a vector
     gui_element_draw_children(element);
 }
 
+void gui_element_draw_dirty(struct gui_element *element)
+{
+    if (!element)
+    {
+        return;
+    }
+
+    if (gui_element_should_redraw(element))
+    {
+        // Drawing the element paints over its children so they are all drawn again
+        gui_element_draw(element);
+        gui_damage_add(element->gui, element->x, element->y, element->width, element->height);
+        return;
+    }
+
+    if (!(element->flags & GUI_ELEMENT_CHILD_REDRAW_REQUIRED))
+    {
+        return;
+    }
+
+    element->flags &= ~GUI_ELEMENT_CHILD_REDRAW_REQUIRED;
+    size_t total_children = vector_count(element->children);
+    for (size_t i = 0; i < total_children; i++)
+    {
+        struct gui_element *child_elem = NULL;
+        vector_at(element->children, i, &child_elem, sizeof(child_elem));
+        gui_element_draw_dirty(child_elem);
+    }
+}
+
+bool gui_element_redraw_pending(struct gui_element *element)
+{
+    for (; element; element = element->parent)
+    {
+        if (gui_element_should_redraw(element))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void gui_element_damage(struct gui_element *element, int x, int y, int width, int height)
+{
+    gui_damage_add(element->gui, element->x + x, element->y + y, width, height);
+
+    // The damage is sent to the kernel by the next redraw
+    gui_mark_for_redraw(element->gui);
+}
+
+void gui_element_pixels_scroll(struct gui_element *element, int dy)
+{
+    int width = element->width;
+    int height = element->height;
+    if (element->rel_root_x + width > element->real_width)
+    {
+        width = element->real_width - element->rel_root_x;
+    }
+    if (element->rel_root_y + height > element->real_height)
+    {
+        height = element->real_height - element->rel_root_y;
+    }
+
+    int distance = dy < 0 ? -dy : dy;
+    if (dy == 0 || width <= 0 || distance >= height)
+    {
+        return;
+    }
+
+    struct framebuffer_pixel *first_row = &element->pixels[element->rel_root_y * element->real_width + element->rel_root_x];
+    size_t row_size = width * sizeof(struct framebuffer_pixel);
+    for (int i = 0; i < height - distance; i++)
+    {
+        // Copy rows in the direction of the move so none is read after it was overwritten
+        int y = dy > 0 ? i : height - 1 - i;
+        memcpy(&first_row[y * element->real_width], &first_row[(y + dy) * element->real_width], row_size);
+    }
+}
+
 void gui_element_draw_border(struct gui_element *gui_element, int border_width, struct framebuffer_pixel *color)
 {
     // Top border
@@ -178,14 +260,27 @@ bool gui_element_should_redraw(struct gui_element *element)
 
 void gui_element_mark_for_redraw(struct gui_element *element)
 {
+    // Elements that only draw over their parent need the parent drawn under them
+    while ((element->flags & GUI_ELEMENT_REDRAW_WITH_PARENT) && element->parent)
+    {
+        element = element->parent;
+    }
+
     element->flags |= GUI_ELEMENT_REDRAW_REQUIRED;
+
+    // The ancestors lead the redraw down to this element
+    for (struct gui_element *parent = element->parent; parent; parent = parent->parent)
+    {
+        parent->flags |= GUI_ELEMENT_CHILD_REDRAW_REQUIRED;
+    }
+
     // GUI Must be aware of the redraw.
     gui_mark_for_redraw(element->gui);
 }
 
 void gui_element_redrawn(struct gui_element *element)
 {
-    element->flags &= ~GUI_ELEMENT_REDRAW_REQUIRED;
+    element->flags &= ~(GUI_ELEMENT_REDRAW_REQUIRED | GUI_ELEMENT_CHILD_REDRAW_REQUIRED);
 }
 
 void gui_element_draw_rect(struct gui_element *element, int x, int y, int width, int height, struct framebuffer_pixel *pixel_color)
@@ -289,6 +384,7 @@ struct gui_element *gui_element_create(struct gui *gui, struct gui_element *pare
     element->properties = vector_new(sizeof(struct gui_element_property *), 4, 0);
 
     element->gui = gui;
+    gui->flags |= GUI_FLAG_EVENT_ORDER_STALE;
 
     // Create new graphics on kernel
     // only if theirs no parent
@@ -374,14 +470,7 @@ out:
         if (element)
         {
             // TODO free graphics...
-            if (parent)
-            {
-                vector_pop_element(parent->children, &element, sizeof(element));
-            }
-            else
-            {
-                vector_pop_element(gui->elements, &element, sizeof(element));
-            }
+            gui_element_unlink(element);
             free(element);
             element = NULL;
         }
@@ -389,8 +478,55 @@ out:
     return element;
 }
 
+bool gui_element_is_within(struct gui_element *element, struct gui_element *ancestor)
+{
+    for (; element; element = element->parent)
+    {
+        if (element == ancestor)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Takes the element and its children out of the gui so nothing reaches
+ * them once they are freed, events already queued for them are dropped
+ */
+static void gui_element_unlink(struct gui_element *element)
+{
+    struct gui *gui = element->gui;
+    if (!gui)
+    {
+        return;
+    }
+
+    if (gui->focused_element && gui_element_is_within(gui->focused_element, element))
+    {
+        // No unfocus event, it would only point at freed memory
+        gui->focused_element = NULL;
+    }
+
+    gui_element_events_remove(gui, element);
+    if (element->parent)
+    {
+        vector_pop_element(element->parent->children, &element, sizeof(element));
+    }
+    else
+    {
+        vector_pop_element(gui->elements, &element, sizeof(element));
+    }
+
+    // The event order still points at the element
+    gui->flags |= GUI_FLAG_EVENT_ORDER_STALE;
+}
+
 void gui_element_free(struct gui_element *element)
 {
+    gui_element_unlink(element);
+
     // Call the inner free function so private can be freed
     if (element->functions.free)
     {
@@ -69,6 +69,11 @@ enum
     // element dimensions
     // and a scrollable section shall exist.
     GUI_ELEMENT_IS_SCROLLABLE   = 0b00000100,
+    // A child of this element needs to be redrawn
+    GUI_ELEMENT_CHILD_REDRAW_REQUIRED = 0b00001000,
+    // The element does not fill its rectangle, it only draws over its parent
+    // so the parent is redrawn with it whenever it changes
+    GUI_ELEMENT_REDRAW_WITH_PARENT = 0b00010000,
 };
 
 struct gui_element
@@ -129,6 +134,9 @@ struct gui_element
 
     struct gui* gui;
 
+    // Position of the element in the gui event order
+    size_t event_order_index;
+
     // Private data belonging to the gui element
     void* private;
 };
@@ -138,6 +146,30 @@ void gui_element_mark_for_redraw(struct gui_element* element);
 void gui_element_redrawn(struct gui_element* element);
 
 void gui_element_draw(struct gui_element* element);
+
+/**
+ * Returns true when the element or one of its ancestors will be drawn in full
+ * by the next redraw, pixels drawn into it before then are painted over
+ */
+bool gui_element_redraw_pending(struct gui_element* element);
+
+/**
+ * Adds a rectangle relative to the element to the gui damage, used by
+ * elements that draw part of themselves outside of their draw function
+ */
+void gui_element_damage(struct gui_element* element, int x, int y, int width, int height);
+
+/**
+ * Moves the pixels of the element up by dy rows or down when dy is negative,
+ * the uncovered rows keep their old pixels for the caller to draw over
+ */
+void gui_element_pixels_scroll(struct gui_element* element, int dy);
+
+/**
+ * Draws only the elements of the tree marked for redraw and adds what
+ * was drawn to the gui damage, unchanged children are skipped
+ */
+void gui_element_draw_dirty(struct gui_element* element);
 struct gui_element* gui_element_parent(struct gui_element* element);
 
 /**
@@ -165,6 +197,11 @@ void gui_element_draw_border(struct gui_element *gui_element, int border_width,
  */
 void gui_element_free(struct gui_element* element);
 
+/**
+ * \return Returns true when the element is the ancestor or one of its descendants
+ */
+bool gui_element_is_within(struct gui_element* element, struct gui_element* ancestor);
+
 void gui_element_private_set(struct gui_element* element, void* private);
 
 
@@ -52,27 +52,6 @@
 #include <stddef.h>
 #include <stdarg.h>
 
-struct gui_event *gui_event_new()
-{
-    return calloc(1, sizeof(struct gui_event));
-}
-
-void gui_event_free(struct gui_event *gui_event)
-{
-    free(gui_event);
-}
-
-struct gui_event *gui_event_clone(struct gui_event *event)
-{
-    struct gui_event *new_event = gui_event_new();
-    if (!new_event)
-        return NULL;
-
-    // We have the new event copy over the old one clone it
-    memcpy(new_event, event, sizeof(*new_event));
-    return new_event;
-}
-
 bool gui_event_condition_mouse_click(struct gui_event *event, struct gui_element *recv_element, va_list va_list)
 {
     // Not mouse click dont deal with it
@@ -179,7 +158,7 @@ int gui_event_push(struct gui *gui, struct gui_event *event, GUI_EVENT_CONDITION
     va_list ap;
     va_start(ap, chck_func);
 
-    // Let's clone the event this will allow people
+    // The event is copied into the queue this will allow people
     // to pass events on the stack much simpler for them
     // with initializers too i.e {.type=ABC,.data.click=1}
 
@@ -196,8 +175,8 @@ int gui_event_push(struct gui *gui, struct gui_event *event, GUI_EVENT_CONDITION
     // heap_event->element.id = heap_event->element.ptr.id;
     // TODO IMPLEMENT AN ID FOR GUI ELEMENS
 
-    // Now we have the clone lets call each childs handler
-    // it will be responsible for its own children
+    // Queue the event for each root that should see it
+    // it will be passed on to its own children
 
     size_t total_root_children = vector_count(gui->elements);
     for (size_t i = 0; i < total_root_children; i++)
@@ -211,7 +190,7 @@ int gui_event_push(struct gui *gui, struct gui_event *event, GUI_EVENT_CONDITION
             bool send_to_child = chck_func ? chck_func(event, child_elem, ap) : true;
             if (send_to_child)
             {
-                gui_element_event_clone_push(child_elem, event);
+                gui_element_event_push(child_elem, event);
             }
         }
     }
@@ -227,80 +206,175 @@ bool gui_event_should_continue_propergating_childern(GUI_EVENT_HANDLER_RESPONSE
            res == GUI_EVENT_HANDLER_RESPONSE_PROCESSED_CONTINUE_WITH_CHILDREN;
 }
 
-void gui_event_propergate_through_children(struct gui_event *gui_event)
+static void gui_event_order_push(struct gui *gui, struct gui_element *element)
 {
-    struct gui_element *element = gui_event->element.ptr;
+    size_t index = vector_count(gui->event_order);
+    struct gui_event_order_entry entry = {.element = element, .subtree_end = index + 1};
+    element->event_order_index = index;
+    vector_push(gui->event_order, &entry);
+
     size_t total_children = vector_count(element->children);
     for (size_t i = 0; i < total_children; i++)
     {
         struct gui_element *child = NULL;
         vector_at(element->children, i, &child, sizeof(child));
-        if (child && child->functions.event_handler)
+        if (child)
         {
-            gui_element_event_clone_push(child, gui_event);
+            gui_event_order_push(gui, child);
         }
     }
+
+    // Now the children are in we know where the subtree ends
+    entry.subtree_end = vector_count(gui->event_order);
+    vector_overwrite(gui->event_order, index, &entry, sizeof(entry));
 }
 
-void gui_element_call_event_handlers(struct gui_element *element, struct gui_event *event)
+static void gui_event_order_rebuild(struct gui *gui)
 {
-    GUI_EVENT_HANDLER_FUNCTION func = element->functions.event_handler;
-    if (func)
+    if (!(gui->flags & GUI_FLAG_EVENT_ORDER_STALE))
+    {
+        return;
+    }
+
+    // Popping keeps the vector memory so rebuilding rarely allocates
+    while (vector_count(gui->event_order) > 0)
+    {
+        vector_pop(gui->event_order);
+    }
+
+    size_t total_root_children = vector_count(gui->elements);
+    for (size_t i = 0; i < total_root_children; i++)
     {
-        int res = func(event);
-        if (gui_event_should_continue_propergating_childern(res))
+        struct gui_element *root_elem = NULL;
+        vector_at(gui->elements, i, &root_elem, sizeof(root_elem));
+        if (root_elem)
         {
-            // We are expected to propergate the event
-            // down the children tree
-            gui_event_propergate_through_children(event);
+            gui_event_order_push(gui, root_elem);
         }
     }
+
+    gui->flags &= ~GUI_FLAG_EVENT_ORDER_STALE;
 }
 
-void gui_element_events_process_event(struct gui_event* event)
+/**
+ * Passes the event down from its element to every descendant in one flat
+ * walk of the event order, a handler that finishes the event skips its subtree
+ */
+static void gui_event_dispatch(struct gui *gui, struct gui_event *event)
 {
-    struct gui_element* element = event->element.ptr;
+    struct gui_element *target = event->element.ptr;
+    struct gui_event_order_entry entry = {0};
+    size_t index = target->event_order_index;
+    if (vector_at(gui->event_order, index, &entry, sizeof(entry)) < 0 || entry.element != target)
+    {
+        // The element is not part of this gui
+        return;
+    }
 
-    // Properties may want to capture the incoming event early.
-    gui_event_push_to_properties(event);
+    size_t end = entry.subtree_end;
+    while (index < end)
+    {
+        vector_at(gui->event_order, index, &entry, sizeof(entry));
+        struct gui_element *element = entry.element;
+        GUI_EVENT_HANDLER_FUNCTION func = element->functions.event_handler;
+        if (!func && element != target)
+        {
+            // Children without a handler dont get the event nor do theirs
+            index = entry.subtree_end;
+            continue;
+        }
 
-    gui_element_call_event_handlers(element, event);
+        // The same event is handed to each element in turn
+        event->element.ptr = element;
+        event->element.id = element->id;
+
+        // Properties may want to capture the incoming event early.
+        gui_event_push_to_properties(event);
+
+        if (func && gui_event_should_continue_propergating_childern(func(event)))
+        {
+            index++;
+            continue;
+        }
+
+        index = entry.subtree_end;
+    }
 }
+
 void gui_element_events_process(struct gui* gui)
 {
-    struct gui_event* event = NULL;
-    while (vector_count(gui->gui_events) > 0)
+    struct gui_event event;
+    while (gui->event_queue.total > 0)
     {
-        // Pull the newest queued event off the queue
-        vector_back(gui->gui_events, &event, sizeof(event));
-        vector_pop(gui->gui_events);
-        if (!event)
+        // Copied out of the queue as handlers may queue more events
+        memcpy(&event, &gui->event_queue.events[gui->event_queue.head], sizeof(event));
+        gui->event_queue.head = (gui->event_queue.head + 1) % GUI_MAX_QUEUED_EVENTS;
+        gui->event_queue.total--;
+
+        gui_event_order_rebuild(gui);
+        gui_event_dispatch(gui, &event);
+    }
+}
+
+static bool gui_event_refers_to(struct gui_event *event, struct gui_element *element)
+{
+    if (gui_element_is_within(event->element.ptr, element))
+    {
+        return true;
+    }
+
+    switch (event->type)
+    {
+    case GUI_EVENT_TYPE_ELEMENT_FOCUSED:
+        return gui_element_is_within(event->data.element_focus.element, element);
+    case GUI_EVENT_TYPE_ELEMENT_UNFOCUSED:
+        return gui_element_is_within(event->data.element_unfocus.element, element);
+    default:
+        break;
+    }
+
+    return false;
+}
+
+void gui_element_events_remove(struct gui *gui, struct gui_element *element)
+{
+    // The events that are kept are moved down to close the gaps
+    size_t kept = 0;
+    for (size_t i = 0; i < gui->event_queue.total; i++)
+    {
+        struct gui_event *event = &gui->event_queue.events[(gui->event_queue.head + i) % GUI_MAX_QUEUED_EVENTS];
+        if (gui_event_refers_to(event, element))
         {
             continue;
         }
 
-        gui_element_events_process_event(event);
-        gui_event_free(event);
+        struct gui_event *kept_event = &gui->event_queue.events[(gui->event_queue.head + kept) % GUI_MAX_QUEUED_EVENTS];
+        if (kept_event != event)
+        {
+            memcpy(kept_event, event, sizeof(*kept_event));
+        }
+        kept++;
     }
+
+    gui->event_queue.total = kept;
 }
-void gui_element_event_push(struct gui_element *element, struct gui_event *event)
+
+int gui_element_event_push(struct gui_element *element, struct gui_event *event)
 {
+    struct gui *gui = element->gui;
+    if (gui->event_queue.total >= GUI_MAX_QUEUED_EVENTS)
+    {
+        return -ENOMEM;
+    }
 
-    struct gui_event *heap_event = gui_event_clone(event);
-    if (!heap_event)
-        return ;
+    size_t tail = (gui->event_queue.head + gui->event_queue.total) % GUI_MAX_QUEUED_EVENTS;
+    struct gui_event *queued_event = &gui->event_queue.events[tail];
+    memcpy(queued_event, event, sizeof(*queued_event));
 
-    heap_event->gui = element->gui;
+    queued_event->gui = gui;
     // Let's update the element to be the one we are pushing
-    heap_event->element.ptr = element;
-    heap_event->element.id = element->id;
-
-    vector_push(element->gui->gui_events, &heap_event);
-}
-
-#warning "DEPRECATED DONT USE THIS FUCNTION"
-int gui_element_event_clone_push(struct gui_element *element, struct gui_event *event)
-{   
-    gui_element_event_push(element, event);
+    queued_event->element.ptr = element;
+    queued_event->element.id = element->id;
+    gui->event_queue.total++;
     return 0;
 }
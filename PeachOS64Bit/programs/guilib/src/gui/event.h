@@ -150,19 +150,38 @@ struct gui_event
     
 };
 
-struct gui_event* gui_event_new();
-void gui_event_free(struct gui_event* gui_event);
-struct gui_event* gui_event_clone(struct gui_event* event);
+// Most events waiting to be dispatched, further events are dropped until the queue drains
+#define GUI_MAX_QUEUED_EVENTS 64
+
+// An element in the order events are passed through the gui, parents before their children
+struct gui_event_order_entry
+{
+    struct gui_element* element;
+
+    // Index just past the last descendant of the element
+    // jumping here skips the children
+    size_t subtree_end;
+};
+
 int gui_event_push_event_element_focus(struct gui* gui, struct gui_element* element);
 int gui_event_push_event_element_unfocus(struct gui *gui, struct gui_element *element);
 
 int gui_event_push_event_mouse_click(struct gui* gui, int window_rel_click_x, int window_rel_click_y, int type);
 int gui_event_push(struct gui* gui, struct gui_event* event, GUI_EVENT_CONDITION_CHECK chck_func, ...);
-void gui_event_propergate_through_children(struct gui_event* gui_event);
 bool gui_event_should_continue_propergating_childern(GUI_EVENT_HANDLER_RESPONSE res);
-void gui_element_event_push(struct gui_element* element, struct gui_event* event);
-int gui_element_event_clone_push(struct gui_element* element, struct gui_event* event);
+
+/**
+ * Queues a copy of the event for the element and its children
+ * \return Returns -ENOMEM when the event queue is full and the event was dropped
+ */
+int gui_element_event_push(struct gui_element* element, struct gui_event* event);
 
 void gui_element_events_process(struct gui* gui);
 
+/**
+ * Drops the queued events that start at the element or one of its children
+ * or that are about its focus, called before the element is freed
+ */
+void gui_element_events_remove(struct gui* gui, struct gui_element* element);
+
 #endif
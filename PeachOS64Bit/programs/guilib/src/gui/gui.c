@@ -121,29 +121,103 @@ void gui_focus_on_element(struct gui* gui, struct gui_element* element)
     // Let's push this event
     gui_event_push_event_element_focus(gui, element);
 }
-int gui_redraw(struct gui *gui)
+static bool gui_rect_overlaps(struct peachos_window_rect *a, struct peachos_window_rect *b)
+{
+    return a->x < b->x + b->width && b->x < a->x + a->width &&
+           a->y < b->y + b->height && b->y < a->y + a->height;
+}
+
+static struct peachos_window_rect gui_rect_union(struct peachos_window_rect *a, struct peachos_window_rect *b)
+{
+    struct peachos_window_rect rect = {0};
+    rect.x = a->x < b->x ? a->x : b->x;
+    rect.y = a->y < b->y ? a->y : b->y;
+    int right = a->x + a->width > b->x + b->width ? a->x + a->width : b->x + b->width;
+    int bottom = a->y + a->height > b->y + b->height ? a->y + a->height : b->y + b->height;
+    rect.width = right - rect.x;
+    rect.height = bottom - rect.y;
+    return rect;
+}
+
+void gui_damage_add(struct gui *gui, int x, int y, int width, int height)
+{
+    if (width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    struct peachos_window_rect rect = {x, y, width, height};
+
+    // Overlapping rectangles are merged, the merged rectangle may overlap
+    // ones that were already checked so start again
+    size_t i = 0;
+    while (i < gui->damage.total)
+    {
+        if (gui_rect_overlaps(&gui->damage.rects[i], &rect))
+        {
+            rect = gui_rect_union(&gui->damage.rects[i], &rect);
+            gui->damage.total--;
+            gui->damage.rects[i] = gui->damage.rects[gui->damage.total];
+            i = 0;
+            continue;
+        }
+        i++;
+    }
+
+    if (gui->damage.total < GUI_MAX_DAMAGE_RECTS)
+    {
+        gui->damage.rects[gui->damage.total] = rect;
+        gui->damage.total++;
+        return;
+    }
+
+    // No room left, merge with the rectangle that grows the least
+    size_t best_index = 0;
+    long best_growth = 0;
+    for (i = 0; i < gui->damage.total; i++)
+    {
+        struct peachos_window_rect *current = &gui->damage.rects[i];
+        struct peachos_window_rect merged = gui_rect_union(current, &rect);
+        long growth = (long)merged.width * merged.height - (long)current->width * current->height;
+        if (i == 0 || growth < best_growth)
+        {
+            best_index = i;
+            best_growth = growth;
+        }
+    }
+
+    gui->damage.rects[best_index] = gui_rect_union(&gui->damage.rects[best_index], &rect);
+}
+
+/**
+ * Sends every damaged rectangle to the kernel in one call
+ */
+static int gui_damage_flush(struct gui *gui)
 {
     int res = 0;
-    
-    // The region to redraw
+    if (gui->damage.total == 0)
+    {
+        goto out;
+    }
 
-    // Get the window
-    struct window *win = gui->window;
-    // Loop through all elements and call their redraw
+    res = window_redraw_regions(gui->window, gui->damage.rects, gui->damage.total);
+    gui->damage.total = 0;
+out:
+    return res;
+}
+
+int gui_redraw(struct gui *gui)
+{
+    // Loop through all root elements, only what changed is drawn
     size_t total_elements = vector_count(gui->elements);
     struct gui_element *element = NULL;
     for (size_t i = 0; i < total_elements; i++)
     {
         vector_at(gui->elements, i, &element, sizeof(element));
-        if (element && gui_element_should_redraw(element))
-        {
-            gui_element_draw(element);
-             // Let's redraw the rectangle of the element
-            window_redraw_region(win, element->x, element->y, element->real_width, element->real_height);
-        }
+        gui_element_draw_dirty(element);
     }
 
-    return res;
+    return gui_damage_flush(gui);
 }
 int gui_add_element(struct gui *gui, struct gui_element *element)
 {
@@ -164,11 +238,10 @@ int gui_add_element(struct gui *gui, struct gui_element *element)
 
     // Push the element to the GUI so its visible.
     vector_push(gui->elements, &root_element);
+    gui->flags |= GUI_FLAG_EVENT_ORDER_STALE;
 
-    // Redraw the scene
-    // FUTURE: HAVE REGION REDRAWING, YET MAYBE THE KERNEL ALREADY
-    // HANDLES THAT..
-    gui_redraw(gui);
+    // Drawn along with everything else that changed at the end of gui_process
+    gui_element_mark_for_redraw(root_element);
     return 0;
 }
 struct gui *gui_bind_to_window(struct window *window, GUI_EVENT_HANDLER_FUNCTION event_handler_func)
@@ -184,8 +257,8 @@ struct gui *gui_bind_to_window(struct window *window, GUI_EVENT_HANDLER_FUNCTION
     gui->win_graphics = window_graphics(window);
     gui->handlers.event = event_handler_func;
     gui->elements = vector_new(sizeof(struct gui_element *), 8, 0);
-    gui->gui_events = vector_new(sizeof(struct gui_event*), 4, 0);
-    if (!gui->elements)
+    gui->event_order = vector_new(sizeof(struct gui_event_order_entry), 16, 0);
+    if (!gui->elements || !gui->event_order)
     {
         // Vector issue.
         return NULL;
@@ -243,7 +316,7 @@ int gui_process_event_keypress(struct gui* gui, struct window_event* win_event)
 
     // Better to call this function than interate
     // with a condition over the whole list.
-    gui_element_event_clone_push(focused_elem, &keypress_event);
+    gui_element_event_push(focused_elem, &keypress_event);
     
     return 0;
 }
@@ -328,7 +401,6 @@ out:
 int gui_process(struct gui *gui)
 {
     int res = 0;
-    gui_redraw_if_required(gui);
 
     // Is there any events that we need to process?
     res = gui_process_events(gui);
@@ -337,6 +409,9 @@ int gui_process(struct gui *gui)
         goto out;
     }
 
+    // Everything the events changed reaches the screen in one redraw call
+    gui_redraw_if_required(gui);
+
 out:
     return res;
 }
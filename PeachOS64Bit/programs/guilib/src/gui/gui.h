@@ -44,6 +44,7 @@
 
 #include "window.h"
 #include "vector.h"
+#include "peachos.h"
 
 // Seperate header file because the function pointers
 // might be used in other parts of the project
@@ -53,8 +54,13 @@ enum
 {
     // Set if the GUI Must redraw its self fully.
     GUI_FLAG_MUST_DRAW = 0b00000001,
+    // Elements were added so the event order must be rebuilt
+    GUI_FLAG_EVENT_ORDER_STALE = 0b00000010,
 };
 
+// Most damaged rectangles kept apart, more than this are merged together
+#define GUI_MAX_DAMAGE_RECTS PEACHOS_WINDOW_MAX_REDRAW_RECTS
+
 
 struct gui_event;
 
@@ -74,8 +80,16 @@ struct gui
     // priority for events.
     struct gui_element* focused_element;
 
-    // vector of struct event*
-    struct vector* gui_events;
+    // Ring of events waiting to be dispatched, each holds the element it starts at
+    struct
+    {
+        struct gui_event events[GUI_MAX_QUEUED_EVENTS];
+        size_t head;
+        size_t total;
+    } event_queue;
+
+    // vector of struct gui_event_order_entry, every element parents first
+    struct vector* event_order;
     
     struct 
     {
@@ -86,6 +100,14 @@ struct gui
     // Window graphics.
     struct graphics* win_graphics;
     struct window* window;
+
+    // Rectangles of the window body drawn since the last redraw call
+    // they are sent to the kernel in one call at the end of gui_redraw
+    struct
+    {
+        struct peachos_window_rect rects[GUI_MAX_DAMAGE_RECTS];
+        size_t total;
+    } damage;
 };
 
 
@@ -100,6 +122,11 @@ int gui_redraw(struct gui* gui);
 void gui_element_private_set(struct gui_element* gui_element, void* private_data);
 void gui_mark_for_redraw(struct gui* gui);
 
+/**
+ * Adds a rectangle relative to the window body to be redrawn by the kernel
+ */
+void gui_damage_add(struct gui* gui, int x, int y, int width, int height);
+
 void gui_focus_on_element(struct gui* gui, struct gui_element* element);
 struct gui_element* gui_focused_element(struct gui* gui);
 
@@ -69,43 +69,139 @@ struct framebuffer_pixel gui_element_listarea_background_color(struct gui_elemen
     return color;
 }
 
-void gui_element_listarea_draw(struct gui_element* element)
+size_t gui_element_listarea_visible_rows(struct gui_element* listarea_element)
+{
+    size_t visible_rows = listarea_element->height / gui_element_listarea_height_per_element(listarea_element);
+    if (visible_rows == 0)
+    {
+        // Too small to fit a row we still show the one partly
+        visible_rows = 1;
+    }
+    return visible_rows;
+}
+
+size_t gui_element_listarea_scroll_row(struct gui_element* listarea_element)
+{
+    struct listarea_private_data* private_data = listarea_element->private;
+    return private_data->scroll_row;
+}
+
+static void gui_element_listarea_draw_row(struct gui_element* element, size_t index, int y)
 {
-    // We shall loop through every element and draw it
     struct listarea_private_data* private_data = element->private;
-    size_t total_elements = vector_count(private_data->elements);
-    int x_rel_pos = 0;
-    int y_rel_pos = 0;
+    struct listarea_list_element* list_element = NULL;
+    vector_at(private_data->elements, index, &list_element, sizeof(list_element));
+    if (!list_element)
+    {
+        return;
+    }
+
     struct font* font = gui_element_listarea_font(element);
     size_t size_per_element = gui_element_listarea_height_per_element(element);
-    struct framebuffer_pixel selected_color = gui_element_listarea_selected_color(element);
+    struct framebuffer_pixel row_color = gui_element_listarea_background_color(element);
+
+    // Is this element selected if so we need to draw it as so
+    if ((int) index == private_data->selected_index)
+    {
+        row_color = gui_element_listarea_selected_color(element);
+    }
+    gui_element_draw_rect(element, 0, y, element->width, size_per_element, &row_color);
+
+    // We have a valid element lets draw the thing
+    font_draw_text(element->graphics, font, element->rel_root_x, element->rel_root_y + y, list_element->text, private_data->font_color);
+
+    // We need to now draw a border under the text
+    gui_element_draw_rect(element, 0, y + font->bits_height_per_character, element->width, LISTAREA_BORDER_WIDTH_PX, &private_data->border_color);
+}
+
+/**
+ * Draws the rows of the listarea that cover the element relative y range
+ * rows scrolled out of view are never touched
+ */
+static void gui_element_listarea_draw_rows(struct gui_element* element, int start_y, int end_y)
+{
+    struct listarea_private_data* private_data = element->private;
+    size_t total_elements = vector_count(private_data->elements);
+    int size_per_element = gui_element_listarea_height_per_element(element);
     struct framebuffer_pixel bg_color = gui_element_listarea_background_color(element);
-    // Since this is a fresh redraw we must first redraw the whole listarea as solid color
-    graphics_draw_rect(element->graphics, 0, 0, element->width, element->height, bg_color);
-    for(size_t i = 0 ;i < total_elements; i++)
+
+    // Clear the range first so the space below the last row is empty
+    gui_element_draw_rect(element, 0, start_y, element->width, end_y - start_y, &bg_color);
+
+    size_t first_row = private_data->scroll_row + start_y / size_per_element;
+    size_t end_row = private_data->scroll_row + (end_y + size_per_element - 1) / size_per_element;
+    if (end_row > total_elements)
     {
-        struct listarea_list_element* list_element = NULL;
-        vector_at(private_data->elements,i,  &list_element, sizeof(list_element));
-        if (list_element)
-        {
-            // Is this element selected if so we need to draw it as so
-            if (i == private_data->selected_index)
-            {
-                // Yep, then lets draw the border
-                graphics_draw_rect(element->graphics, 0, i * (int) size_per_element, element->width, size_per_element, selected_color);
-            }
-            // We have a valid element lets draw the thing
-            font_draw_text(element->graphics, font, x_rel_pos, y_rel_pos, list_element->text, private_data->font_color);
-            // We need to now draw a border
-            // and make room for the text height
-            y_rel_pos += font->bits_height_per_character;
-            graphics_draw_rect(element->graphics, x_rel_pos, y_rel_pos, element->width, LISTAREA_BORDER_WIDTH_PX, private_data->border_color);
-            // Now we have drawn the border letsm ake room for the next text element
-            y_rel_pos += LISTAREA_BORDER_WIDTH_PX;
-        }
+        end_row = total_elements;
+    }
+
+    for (size_t i = first_row; i < end_row; i++)
+    {
+        gui_element_listarea_draw_row(element, i, (int) (i - private_data->scroll_row) * size_per_element);
+    }
+}
+
+void gui_element_listarea_draw(struct gui_element* element)
+{
+    gui_element_listarea_draw_rows(element, 0, element->height);
+}
+
+static void gui_element_listarea_row_redraw(struct gui_element* element, int index)
+{
+    struct listarea_private_data* private_data = element->private;
+    size_t visible_rows = gui_element_listarea_visible_rows(element);
+    if (index < (int) private_data->scroll_row || index > (int) (private_data->scroll_row + visible_rows))
+    {
+        // Not on screen
+        return;
     }
+
+    int size_per_element = gui_element_listarea_height_per_element(element);
+    int y = (index - (int) private_data->scroll_row) * size_per_element;
+    gui_element_listarea_draw_row(element, index, y);
+    gui_element_damage(element, 0, y, element->width, size_per_element);
 }
 
+int gui_element_listarea_scroll_set(struct gui_element* listarea_element, size_t scroll_row)
+{
+    struct listarea_private_data* private_data = listarea_element->private;
+    size_t total_elements = vector_count(private_data->elements);
+    size_t visible_rows = gui_element_listarea_visible_rows(listarea_element);
+    size_t max_scroll_row = total_elements > visible_rows ? total_elements - visible_rows : 0;
+    if (scroll_row > max_scroll_row)
+    {
+        scroll_row = max_scroll_row;
+    }
+
+    int rows_moved = (int) scroll_row - (int) private_data->scroll_row;
+    int distance = rows_moved < 0 ? -rows_moved : rows_moved;
+    if (rows_moved == 0)
+    {
+        return 0;
+    }
+
+    private_data->scroll_row = scroll_row;
+    if (gui_element_redraw_pending(listarea_element) || distance >= (int) visible_rows)
+    {
+        // Nothing on screen can be reused
+        gui_element_mark_for_redraw(listarea_element);
+        return 0;
+    }
+
+    // Keep the rows still in view and only draw the ones scrolled in
+    int size_per_element = gui_element_listarea_height_per_element(listarea_element);
+    gui_element_pixels_scroll(listarea_element, rows_moved * size_per_element);
+    if (rows_moved > 0)
+    {
+        gui_element_listarea_draw_rows(listarea_element, (visible_rows - distance) * size_per_element, listarea_element->height);
+    }
+    else
+    {
+        gui_element_listarea_draw_rows(listarea_element, 0, distance * size_per_element);
+    }
+    gui_element_damage(listarea_element, 0, 0, listarea_element->width, listarea_element->height);
+    return 0;
+}
 
 void gui_element_listarea_list_element_free(struct listarea_list_element* element)
 {
@@ -181,6 +277,17 @@ int gui_element_listarea_list_add(struct gui_element* gui_element, const char* t
     strncpy(list_element->text, title, sizeof(list_element->text));
     list_element->private = private;
     res = vector_push(private_data->elements, &list_element);
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    // Rows added below the view are drawn once scrolled to
+    size_t index = vector_count(private_data->elements) - 1;
+    if (index <= private_data->scroll_row + gui_element_listarea_visible_rows(gui_element))
+    {
+        gui_element_mark_for_redraw(gui_element);
+    }
 out:
     return res;
 }   
@@ -210,14 +317,32 @@ int gui_element_listarea_select(struct gui_element* listarea_element, int index)
     {
         return -EINVARG;
     }
+    int old_selected_index = private_data->selected_index;
     private_data->selected_index = index;
-    gui_element_mark_for_redraw(listarea_element);
+
+    // Bring the row into view, scrolling draws it if it was hidden
+    size_t visible_rows = gui_element_listarea_visible_rows(listarea_element);
+    if (index < private_data->scroll_row)
+    {
+        gui_element_listarea_scroll_set(listarea_element, index);
+    }
+    else if (index >= private_data->scroll_row + visible_rows)
+    {
+        gui_element_listarea_scroll_set(listarea_element, index - visible_rows + 1);
+    }
+
+    // Only the rows that changed colour are drawn again
+    if (!gui_element_redraw_pending(listarea_element))
+    {
+        gui_element_listarea_row_redraw(listarea_element, old_selected_index);
+        gui_element_listarea_row_redraw(listarea_element, index);
+    }
 
     // Select shall invoke the select event handler
     struct gui_event event = {0};
     event.type = GUI_EVENT_TYPE_LISTAREA_ITEM_SELECTED;
     event.data.listarea_item_selected.selected_index = index;
-    gui_element_event_clone_push(listarea_element, &event);
+    gui_element_event_push(listarea_element, &event);
     return 0;
 }
 
@@ -231,14 +356,20 @@ int gui_element_listarea_selected_index(struct gui_element* listarea_element)
 void gui_element_listarea_event_handler_click(struct gui_event* gui_event)
 {
     struct gui_element* listarea_element = gui_event->element.ptr;
-    int y = gui_event->data.click.coords.y;
-    struct font* font = gui_element_listarea_font(listarea_element);
+    struct listarea_private_data* private_data = listarea_element->private;
+
+    // Click coordinates are relative to the window body
+    int y = gui_event->data.click.coords.y - listarea_element->y;
+    if (y < 0)
+    {
+        return;
+    }
 
     // We need to determine which element was clicked, we know how to do this
     // because we understand the size of each element in height.
     // 3 PIXELS for border + height per characater, this is the height of each possible element
     size_t total_elements = gui_element_listarea_total_elements(listarea_element);
-    int calculated_selected_index = y / (font->bits_height_per_character + 3);
+    size_t calculated_selected_index = private_data->scroll_row + y / gui_element_listarea_height_per_element(listarea_element);
     if (calculated_selected_index >= total_elements)
     {
         // Clicked out of bounds
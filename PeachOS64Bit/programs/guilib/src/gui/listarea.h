@@ -65,6 +65,9 @@ struct listarea_private_data
     // The index in the vector that is selected.
     int selected_index;
 
+    // Index of the row shown at the top, rows above it are scrolled out of view
+    size_t scroll_row;
+
     struct framebuffer_pixel selected_bg_color;
     struct framebuffer_pixel border_color;
     struct framebuffer_pixel font_color;
@@ -84,4 +87,16 @@ struct font* gui_element_listarea_font(struct gui_element* listarea_element);
 int gui_element_listarea_select(struct gui_element* listarea_element, int index);
 int gui_element_listarea_selected_index(struct gui_element* listarea_element);
 
+/**
+ * Total rows that fit in the listarea at once
+ */
+size_t gui_element_listarea_visible_rows(struct gui_element* listarea_element);
+
+/**
+ * Scrolls so the given row is at the top of the listarea. Rows still in view are
+ * moved rather than drawn again, only the rows scrolled into view are drawn
+ */
+int gui_element_listarea_scroll_set(struct gui_element* listarea_element, size_t scroll_row);
+size_t gui_element_listarea_scroll_row(struct gui_element* listarea_element);
+
 #endif
\ No newline at end of file
@@ -50,6 +50,8 @@
 #include "stdlib.h"
 #include "stdio.h"
 int gui_element_textfield_realloc_text(struct gui_element *element, size_t new_size);
+static bool gui_element_textfield_draw_char(struct gui_element *element, char c);
+static bool gui_element_textfield_erase_char(struct gui_element *element);
 
 /**
  * TODO: MANY SHARED PROPERTIES BETWEEN BUTTON AND TEXTFIELD
@@ -81,14 +83,17 @@ void gui_element_textfield_put_char(struct gui_element *element, char c)
         }
     }
     private_data->text.text[private_data->index] = c;
+    if (!gui_element_textfield_draw_char(element, c))
+    {
+        // we must redraw this next cycle.
+        gui_element_mark_for_redraw(element);
+    }
+
     private_data->index++;
     if (private_data->index >= private_data->text.current_len - 1)
     {
         private_data->text.current_len = private_data->index + 1;
     }
-
-    // we must redraw this next cycle.
-    gui_element_mark_for_redraw(element);
 }
 
 void gui_element_textfield_clear(struct gui_element *element)
@@ -97,6 +102,7 @@ void gui_element_textfield_clear(struct gui_element *element)
     private_data->index = 0;
     private_data->text.current_len = 0;
     memset(private_data->text.text, 0x00, private_data->text.current_allocated_len);
+    gui_element_mark_for_redraw(element);
 }
 void gui_element_textfield_cursor_set(struct gui_element *element, int index)
 {
@@ -130,10 +136,13 @@ void gui_element_textfield_backspace(struct gui_element *element)
         return;
     }
 
+    if (!gui_element_textfield_erase_char(element))
+    {
+        gui_element_mark_for_redraw(element);
+    }
+
     private_data->text.text[private_data->index - 1] = 0x00;
     private_data->index--;
-
-    gui_element_mark_for_redraw(element);
 }
 
 GUI_EVENT_HANDLER_RESPONSE gui_element_textfield_event_handler(struct gui_event *gui_event)
@@ -161,6 +170,124 @@ GUI_EVENT_HANDLER_RESPONSE gui_element_textfield_event_handler(struct gui_event
     gui_element_textfield_put_char(element, key);
     return GUI_EVENT_HANDLER_RESPONSE_PROCESSED_CONTINUE_WITH_CHILDREN;
 }
+static struct framebuffer_pixel gui_element_textfield_bg_color(struct gui_element *gui_element)
+{
+    struct framebuffer_pixel bg_color = {0};
+    struct gui_element *plane_parent = gui_element->parent;
+    bg_color = gui_element_plane_bg_color_get(plane_parent);
+
+    // If its a read only textfield then we should draw the background slightly darker
+    if (gui_element_textfield_read_only(gui_element))
+    {
+        // Now we have the actual colour of the plane parent
+        // lets darken it slightly to give illusion of read only.
+        // Not sure if this will work though we shall see.
+        bg_color.red -= 10;
+        bg_color.blue -= 10;
+        bg_color.green -= 10;
+    }
+    return bg_color;
+}
+
+/**
+ * Works out where the pen ends up after the text is drawn from x, y
+ * following the same wrapping as font_draw_text_wrap
+ */
+static void gui_element_textfield_pen_measure(struct gui_element *gui_element, int x, int y)
+{
+    struct textfield_private_data *private = gui_element->private;
+    struct font *font = font_get_system_font();
+    private->pen.valid = false;
+    if (!font)
+    {
+        return;
+    }
+
+    private->pen.x = x;
+    private->pen.y = y;
+    private->pen.index = 0;
+    for (const char *c = private->text.text; *c; c++)
+    {
+        if (*c == 0x0D)
+        {
+            // Carriage returns are only handled by a full draw
+            return;
+        }
+
+        if ((private->flags & GUI_TEXTFIELD_IS_MULTILINE_FLAG) && private->pen.x >= gui_element->width)
+        {
+            private->pen.x = 0;
+            private->pen.y += font->bits_height_per_character;
+        }
+        private->pen.x += font->bits_width_per_character;
+        private->pen.index++;
+    }
+
+    private->pen.valid = true;
+}
+
+/**
+ * Draws the character typed at the end of the text at the pen
+ * \return Returns false when the whole textfield must be drawn instead
+ */
+static bool gui_element_textfield_draw_char(struct gui_element *element, char c)
+{
+    struct textfield_private_data *private = element->private;
+    struct font *font = font_get_system_font();
+    if (!font || !private->pen.valid || private->pen.index != private->index ||
+        c == 0x0D || gui_element_redraw_pending(element))
+    {
+        return false;
+    }
+
+    if ((private->flags & GUI_TEXTFIELD_IS_MULTILINE_FLAG) && private->pen.x >= element->width)
+    {
+        private->pen.x = 0;
+        private->pen.y += font->bits_height_per_character;
+    }
+
+    bool clipped = (private->flags & GUI_TEXTFIELD_IS_MULTILINE_FLAG) && private->pen.y >= element->height;
+    if (!clipped)
+    {
+        font_draw(element->graphics, font, private->pen.x, private->pen.y, c, private->text.color);
+        gui_element_damage(element, private->pen.x, private->pen.y, font->bits_width_per_character, font->bits_height_per_character);
+    }
+
+    private->pen.x += font->bits_width_per_character;
+    private->pen.index++;
+    return true;
+}
+
+/**
+ * Erases the last character of the text by painting the background over it
+ * \return Returns false when the whole textfield must be drawn instead
+ */
+static bool gui_element_textfield_erase_char(struct gui_element *element)
+{
+    struct textfield_private_data *private = element->private;
+    struct font *font = font_get_system_font();
+    if (!font || !private->pen.valid || private->pen.index != private->index ||
+        private->pen.index == 0 || gui_element_redraw_pending(element))
+    {
+        return false;
+    }
+
+    private->pen.x -= font->bits_width_per_character;
+    if (private->pen.x < 0)
+    {
+        // The character was the last on the row above
+        int columns = (element->width + font->bits_width_per_character - 1) / font->bits_width_per_character;
+        private->pen.x = (columns - 1) * font->bits_width_per_character;
+        private->pen.y -= font->bits_height_per_character;
+    }
+    private->pen.index--;
+
+    struct framebuffer_pixel bg_color = gui_element_textfield_bg_color(element);
+    gui_element_draw_rect(element, private->pen.x, private->pen.y, font->bits_width_per_character, font->bits_height_per_character, &bg_color);
+    gui_element_damage(element, private->pen.x, private->pen.y, font->bits_width_per_character, font->bits_height_per_character);
+    return true;
+}
+
 void gui_element_textfield_draw(struct gui_element *gui_element)
 {
     struct textfield_private_data *private = gui_element->private;
@@ -182,16 +309,7 @@ void gui_element_textfield_draw(struct gui_element *gui_element)
     // If its a read only textfield then we should draw the background slightly darker
     if (gui_element_textfield_read_only(gui_element))
     {
-        struct framebuffer_pixel bg_color = {0};
-        struct gui_element *plane_parent = gui_element->parent;
-        bg_color = gui_element_plane_bg_color_get(plane_parent);
-        // Now we have the actual colour of the plane parent
-        // lets darken it slightly to give illusion of read only.
-        // Not sure if this will work though we shall see.
-        bg_color.red -= 10;
-        bg_color.blue -= 10;
-        bg_color.green -= 10;
-
+        struct framebuffer_pixel bg_color = gui_element_textfield_bg_color(gui_element);
         gui_element_draw_rect(gui_element, 0, 0, gui_element->width, gui_element->height, &bg_color);
     }
 
@@ -227,6 +345,9 @@ void gui_element_textfield_draw(struct gui_element *gui_element)
         // Not multiline? great draw the text as seen.
         font_draw_text(gui_element->graphics, NULL, x_pos, y_pos, private->text.text, colour);
     }
+
+    // Typing from here on draws only the new characters
+    gui_element_textfield_pen_measure(gui_element, x_pos, y_pos);
 }
 
 void gui_element_textfield_free(struct gui_element *gui_element)
@@ -255,6 +376,7 @@ void gui_element_textfield_text_vertical_alignment_set(struct gui_element *eleme
 {
     struct textfield_private_data *private_data = element->private;
     private_data->text_alignment.vertical = alignment;
+    gui_element_mark_for_redraw(element);
 }
 
 int gui_element_textfield_realloc_text(struct gui_element *element, size_t new_size)
@@ -335,6 +457,9 @@ struct gui_element *gui_element_textfield_create(struct gui *gui, struct gui_ele
         goto out;
     }
 
+    // Only the text is drawn, the plane under it draws the background
+    element->flags |= GUI_ELEMENT_REDRAW_WITH_PARENT;
+
     // Background color for the textfield, light gray color. #d3d3d3
     gui_element_plane_bg_color_set(plane_bg_element, 0xd3, 0xd3, 0xd3);
 
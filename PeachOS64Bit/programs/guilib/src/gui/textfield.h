@@ -95,6 +95,17 @@ struct textfield_private_data
     // Next index where next char will be put
     int index;
 
+    // Where the character after the drawn text goes, measured as the text is drawn
+    // so typing at the end draws one character instead of the whole text
+    struct textfield_pen
+    {
+        int x;
+        int y;
+        // Characters drawn before the pen
+        int index;
+        bool valid;
+    } pen;
+
     // The font of the text to use.
     struct font *font;
 };
@@ -60,8 +60,17 @@
 
 #include "bmp.h"
 
+struct image_cache_entry
+{
+    char path[IMAGE_CACHE_MAX_PATH];
+    struct image *image;
+};
+
 struct vector *image_formats;
 
+// Images decoded by this program, vector of struct image_cache_entry
+struct vector *image_cache;
+
 struct image_format *graphics_image_format_get(const char *mime_type)
 {
     struct image_format *format = NULL;
@@ -119,6 +128,41 @@ image_pixel_data graphics_image_get_pixel(struct image *image, int x, int y)
     return pixel_data;
 }
 
+static struct image *graphics_image_cache_get(const char *path)
+{
+    size_t total_entries = vector_count(image_cache);
+    for (size_t i = 0; i < total_entries; i++)
+    {
+        struct image_cache_entry entry = {0};
+        vector_at(image_cache, i, &entry, sizeof(entry));
+        if (strncmp(entry.path, path, sizeof(entry.path)) == 0)
+        {
+            return entry.image;
+        }
+    }
+
+    return NULL;
+}
+
+static void graphics_image_cache_add(const char *path, struct image *image)
+{
+    struct image_cache_entry entry = {0};
+    if (strnlen(path, sizeof(entry.path)) >= sizeof(entry.path))
+    {
+        // Too long to key on, the caller keeps ownership
+        return;
+    }
+
+    strncpy(entry.path, path, sizeof(entry.path));
+    entry.image = image;
+    if (vector_push(image_cache, &entry) < 0)
+    {
+        return;
+    }
+
+    image->flags |= IMAGE_FLAG_CACHED;
+}
+
 struct image *graphics_image_load(const char *path)
 {
     struct image *img = NULL;
@@ -126,6 +170,12 @@ struct image *graphics_image_load(const char *path)
     int fd = 0;
     int res = 0;
 
+    img = graphics_image_cache_get(path);
+    if (img)
+    {
+        return img;
+    }
+
     fd = fopen(path, "r");
     if (fd < 0)
     {
@@ -161,6 +211,8 @@ struct image *graphics_image_load(const char *path)
         goto out;
     }
 
+    graphics_image_cache_add(path, img);
+
 out:
     // We can close the file and free the memory now
     fclose(fd);
@@ -193,36 +245,44 @@ bool image_in_bounds(struct image* img, size_t x, size_t y)
 
 void graphics_draw_image(struct graphics* graphics, struct image* img, int rel_x, int rel_y)
 {
-    // lets loop through all the pixels and draw them
     struct framebuffer_pixel* pixels = graphics_get_pixel_buffer(graphics);
     if(!pixels)
         return;
-    
-    for(size_t x = 0; x < img->width; x++)
+
+    // Only the part of the image inside the graphics is drawn
+    int start_x = rel_x < 0 ? -rel_x : 0;
+    int start_y = rel_y < 0 ? -rel_y : 0;
+    int end_x = img->width;
+    int end_y = img->height;
+    if (rel_x + end_x > (int)graphics->width)
     {
-        for(size_t y = 0; y < img->height; y++)
-        {
-            size_t ox = rel_x + x;
-            size_t oy = rel_y + y;
-            // Did we overflow any out buffer?
-            if (!graphics_in_bounds(graphics, ox, oy))
-            {
-                continue;
-            }
-            
-            struct framebuffer_pixel* pixel_out = &graphics->pixels[oy * graphics->width +ox];
-            image_pixel_data* pixel_in =  &img->data[y * img->width + x];
-            // copy the pixel over
-            pixel_out->red = pixel_in->R;
-            pixel_out->green = pixel_in->G;
-            pixel_out->blue = pixel_in->B;
-            // Pixel now written to the graphic.
-        }
+        end_x = (int)graphics->width - rel_x;
+    }
+    if (rel_y + end_y > (int)graphics->height)
+    {
+        end_y = (int)graphics->height - rel_y;
+    }
+    if (start_x >= end_x || start_y >= end_y)
+    {
+        return;
+    }
+
+    // Image pixels are already in framebuffer order so each row is one copy
+    for (int y = start_y; y < end_y; y++)
+    {
+        struct framebuffer_pixel* row_out = &pixels[(size_t)(rel_y + y) * graphics->width + (rel_x + start_x)];
+        memcpy(row_out, &img->data[(size_t)y * img->width + start_x], (end_x - start_x) * sizeof(struct framebuffer_pixel));
     }
 }
 
 void graphics_image_free(struct image *image)
 {
+    if (image->flags & IMAGE_FLAG_CACHED)
+    {
+        // Others may have loaded the same image
+        return;
+    }
+
     // Call the image free function incase the format made some private data related to this memory
     // that needs to be freed.
     image->format->image_free_function(image);
@@ -272,6 +332,14 @@ int graphics_image_formats_init()
         res = -ENOMEM;
         goto out;
     }
+
+    image_cache = vector_new(sizeof(struct image_cache_entry), 8, VECTOR_NO_FLAGS);
+    if (!image_cache)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
     res = graphics_image_formats_load();
     if (res < 0)
     {
@@ -285,6 +353,11 @@ out:
         {
             vector_free(image_formats);
         }
+        if (image_cache)
+        {
+            vector_free(image_cache);
+            image_cache = NULL;
+        }
     }
     return res;
 }
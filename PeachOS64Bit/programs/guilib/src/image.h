@@ -46,24 +46,37 @@
 #include <stdbool.h>
 struct image_format;
 struct graphics;
+
+// Stored in the order of struct framebuffer_pixel so rows copy straight to graphics
 typedef union image_pixel_data {
-    uint32_t data;           // Full 32-bit data (e.g., RGBA packed)
+    uint32_t data;           // Full 32-bit data (e.g., BGRA packed)
     struct {
-        uint8_t R;           // Red channel
-        uint8_t G;           // Green channel
         uint8_t B;           // Blue channel
+        uint8_t G;           // Green channel
+        uint8_t R;           // Red channel
         uint8_t A;           // Alpha channel
     };
 } image_pixel_data;
 
+// Longest path an image can be cached under
+#define IMAGE_CACHE_MAX_PATH 108
+
+enum
+{
+    // The image belongs to the image cache and is never freed
+    IMAGE_FLAG_CACHED = 0b00000001
+};
+
 struct image
 {
     uint32_t width;
     uint32_t height;
 
-    // RGB data ( can be casted to a framebuffer_pixel )
+    // Pixel data row by row, top row first ( can be casted to a framebuffer_pixel )
     image_pixel_data* data;
 
+    int flags;
+
 
     // Private data related to the image format
     // known to the handler that loaded the image
@@ -100,6 +113,11 @@ int graphics_image_format_register(struct image_format* format);
 void graphics_image_format_unload(struct image_format* format);
 struct image_format* graphics_image_format_get(const char* mime_type);
 struct image *graphics_image_load_from_memory(void *memory, size_t max);
+
+/**
+ * Loads the image at the path, an image this program loaded before is returned
+ * from the image cache without decoding it again. Do not write to the pixels of loaded images
+ */
 struct image* graphics_image_load(const char* path);
 image_pixel_data graphics_image_get_pixel(struct image *image, int x, int y);
 void graphics_image_free(struct image* image);
@@ -58,6 +58,11 @@ void window_redraw_region(struct window* window, int rect_x, int rect_y, int rec
     peachos_window_redraw_region(rect_x, rect_y, rect_width, rect_height, window);
 }
 
+int window_redraw_regions(struct window* window, struct peachos_window_rect* rects, size_t total_rects)
+{
+    return peachos_window_redraw_regions(rects, total_rects, window);
+}
+
 struct window* window_create(const char* title, int width, int height, int flags, int id)
 {
     // Call assembler function to creaate the window on the kernel.
@@ -41,6 +41,7 @@
 
 #ifndef STDLIB_WINDOW_H
 #define STDLIB_WINDOW_H
+#include <stddef.h>
 
 /**
  * Not strictly part of the C STDLIB
@@ -143,6 +144,12 @@ void window_set_to_receive_stdout(struct window *win);
 void window_redraw(struct window *window);
 void window_redraw_region(struct window *window, int rect_x, int rect_y, int rect_width, int rect_height);
 
+struct peachos_window_rect;
+/**
+ * Redraws many rectangles of the window in one call, rects must be in heap memory
+ */
+int window_redraw_regions(struct window *window, struct peachos_window_rect *rects, size_t total_rects);
+
 void *window_graphics(struct window *window);
 struct window *window_focused();
 
@@ -0,0 +1,173 @@
+/*
+ * PeachOS 64-Bit Kernel Project
+ * Copyright (C) 2026 Daniel McCarthy <daniel@dragonzap.com>
+ *
+ * This file is part of the PeachOS 64-Bit Kernel.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * For full source code, documentation, and structured learning,
+ * see the official kernel development course part one:
+ * https://dragonzap.com/course/developing-a-multithreaded-kernel-from-scratch
+ *
+ * Get part one and part two module one, module two all peachos courses (69 hours of content): https://dragonzap.com/offer/kernel-development-from-scratch-69-hours
+ *
+ * Get the part two course module one and two: https://dragonzap.com/offer/developing-a-multithreaded-kernel-from-scratch-part-two-full-series
+ */
+
+/*
+ * Copyright (C) 2025 Daniel McCarthy <daniel@dragonzap.com>
+ * Part of the PeachOS Part Two Development Series.
+ * https://github.com/nibblebits/PeachOS64BitCourse
+ * https://github.com/nibblebits/PeachOS64BitModuleTwo
+ * Licensed under the GNU General Public License version 2 (GPLv2).
+ *
+ * Community contributors to this source file:
+ * NONE AS OF YET
+ * ----------------
+ * Disclaimer: Contributors are hobbyists that contributed to the public source code, they are not affiliated or endorsed by Daniel McCarthy the author of the PeachOS Kernel      
+ * development video series. Contributors did not contribute to the video content or the teaching and have no intellectual property rights over the video content for the course video * material and did not contribute to the video material in anyway.
+ */
+
+
+#include "peachos.h"
+#include "stdlib.h"
+#include "stdio.h"
+#include "string.h"
+#include "memory.h"
+#include "window.h"
+#include "gui/gui.h"
+#include "gui/element.h"
+#include "gui/event.h"
+#include "gui/plane.h"
+#include <stdbool.h>
+
+// Spans many heap blocks, process memory comes from the kernel heap not the paging
+// heap, whose realloc paths the kernel checks at boot with kheap_paging_realloc_check
+#define SELFTEST_LARGE_ALLOCATION (64 * 1024)
+
+// Element ids used by the gui checks
+enum
+{
+    SELFTEST_ELEMENT_PARENT,
+    SELFTEST_ELEMENT_CHILD,
+    SELFTEST_TOTAL_ELEMENTS
+};
+
+// Total checks that failed, returned as the exit code
+static int selftest_failures = 0;
+
+// Events each of the gui check elements was handed
+static int selftest_element_events[SELFTEST_TOTAL_ELEMENTS] = {0};
+
+static void selftest_check(const char* name, bool passed)
+{
+    printf("%s %s\n", passed ? "PASS" : "FAIL", name);
+    if (!passed)
+    {
+        selftest_failures++;
+    }
+}
+
+/**
+ * realloc to a size of zero frees the allocation and returns NULL,
+ * the memory it held can then be allocated again
+ */
+static void selftest_realloc_zero()
+{
+    char* ptr = malloc(SELFTEST_LARGE_ALLOCATION);
+    selftest_check("realloc(ptr, 0): malloc", ptr != NULL);
+    if (!ptr)
+    {
+        return;
+    }
+
+    memset(ptr, 0xAA, SELFTEST_LARGE_ALLOCATION);
+    selftest_check("realloc(ptr, 0): returns NULL", realloc(ptr, 0) == NULL);
+
+    // The old pointer is no longer ours, freeing it again must be ignored
+    free(ptr);
+
+    char* again = malloc(SELFTEST_LARGE_ALLOCATION);
+    selftest_check("realloc(ptr, 0): memory can be allocated again", again != NULL);
+    if (again)
+    {
+        memset(again, 0x55, SELFTEST_LARGE_ALLOCATION);
+        free(again);
+    }
+
+    char* small = malloc(16);
+    selftest_check("realloc(ptr, 0): small allocation returns NULL", small && realloc(small, 0) == NULL);
+}
+
+static GUI_EVENT_HANDLER_RESPONSE selftest_element_event_handler(struct gui_event* event)
+{
+    if (event->element.id >= 0 && event->element.id < SELFTEST_TOTAL_ELEMENTS)
+    {
+        selftest_element_events[event->element.id]++;
+    }
+
+    return GUI_EVENT_HANDLER_RESPONSE_PROCESSED_CONTINUE_WITH_CHILDREN;
+}
+
+/**
+ * Freeing an element with events queued for it must take it out of the gui,
+ * dispatching afterwards only reaches the elements that are left
+ */
+static void selftest_gui_free_then_dispatch()
+{
+    struct window* win = window_main();
+    struct gui* gui = win ? gui_bind_to_window(win, NULL) : NULL;
+    selftest_check("free then dispatch: gui created", gui != NULL);
+    if (!gui)
+    {
+        return;
+    }
+
+    struct gui_element* parent = gui_element_plane_create(gui, NULL, 0, 0, 40, 40, SELFTEST_ELEMENT_PARENT);
+    struct gui_element* child = parent ? gui_element_plane_create(gui, parent, 10, 10, 10, 10, SELFTEST_ELEMENT_CHILD) : NULL;
+    selftest_check("free then dispatch: elements created", parent && child);
+    if (!parent || !child)
+    {
+        return;
+    }
+
+    gui_element_event_handler_set(parent, selftest_element_event_handler);
+    gui_element_event_handler_set(child, selftest_element_event_handler);
+
+    // Dispatching once builds the event order with the child in it
+    struct gui_event event = {.type = GUI_EVENT_TYPE_KEYSTROKE, .data.keystroke.key = 'a'};
+    gui_element_event_push(parent, &event);
+    gui_element_events_process(gui);
+    selftest_check("free then dispatch: child gets the event before the free", selftest_element_events[SELFTEST_ELEMENT_CHILD] == 1);
+
+    // Queued for the parent, which passes it on, and for the child directly
+    memset(selftest_element_events, 0, sizeof(selftest_element_events));
+    gui_element_event_push(parent, &event);
+    gui_element_event_push(child, &event);
+    gui_focus_on_element(gui, child);
+
+    gui_element_free(child);
+    gui_element_events_process(gui);
+    selftest_check("free then dispatch: freed element gets no events", selftest_element_events[SELFTEST_ELEMENT_CHILD] == 0);
+    selftest_check("free then dispatch: parent still gets its event", selftest_element_events[SELFTEST_ELEMENT_PARENT] == 1);
+    selftest_check("free then dispatch: freed element is not focused", gui_focused_element(gui) == NULL);
+}
+
+int main(int argc, char** argv)
+{
+    selftest_realloc_zero();
+    selftest_gui_free_then_dispatch();
+    printf("selftest: %i failed\n", selftest_failures);
+    return selftest_failures;
+}
@@ -44,6 +44,166 @@
 #include "stdlib.h"
 #include "peachos.h"
 #include "window.h"
+#include "string.h"
+
+#define SHELL_HEAP_TRACE_MAX_ENTRIES 64
+
+static void shell_heapstat_summary()
+{
+    struct peachos_heap_stats* stats = malloc(sizeof(struct peachos_heap_stats));
+    if (!stats)
+    {
+        print("heapstat: out of memory\n");
+        return;
+    }
+
+    if (peachos_heap_stats(stats) < 0)
+    {
+        print("heapstat: failed to read the kernel heap statistics\n");
+        free(stats);
+        return;
+    }
+
+    printf("%i heaps, %i failed allocations\n", (int) stats->total_heaps, (int) stats->failed_allocations);
+    for (uint64_t i = 0; i < stats->total_heaps && i < PEACHOS_HEAP_STATS_MAX_HEAPS; i++)
+    {
+        struct peachos_heap_stats_heap* heap = &stats->heaps[i];
+        printf("%lx%s used %i/%i blocks peak %i, allocs %i frees %i failed %i, largest free %i frag %i%%\n",
+               (unsigned long) heap->start_address,
+               (heap->flags & PEACHOS_HEAP_STATS_HEAP_FLAG_PAGING) ? " paging" : "",
+               (int) heap->used_blocks, (int) heap->total_blocks, (int) heap->peak_used_blocks,
+               (int) heap->allocations, (int) heap->frees, (int) heap->failed_allocations,
+               (int) heap->largest_free_extent, (int) heap->fragmentation_index);
+    }
+
+    for (int i = 0; i < PEACHOS_HEAP_STATS_TOTAL_SIZE_CLASSES; i++)
+    {
+        printf("<= %i blocks: allocs %i frees %i failed %i\n", 1 << i,
+               (int) stats->size_classes[i].allocations, (int) stats->size_classes[i].frees,
+               (int) stats->size_classes[i].failed_allocations);
+    }
+
+    printf("zero pool %i/%i pages, hits %i misses %i\n", (int) stats->zero_pool.depth, (int) stats->zero_pool.capacity,
+           (int) stats->zero_pool.hits, (int) stats->zero_pool.misses);
+
+    free(stats);
+}
+
+static void shell_heapstat_trace(long flags)
+{
+    struct peachos_heap_trace_entry* entries = malloc(sizeof(struct peachos_heap_trace_entry) * SHELL_HEAP_TRACE_MAX_ENTRIES);
+    if (!entries)
+    {
+        print("heapstat: out of memory\n");
+        return;
+    }
+
+    long total = peachos_heap_trace(entries, SHELL_HEAP_TRACE_MAX_ENTRIES, flags);
+    for (long i = 0; i < total; i++)
+    {
+        printf("caller %lx ptr %lx size %i%s\n", (unsigned long) entries[i].caller, (unsigned long) entries[i].ptr, (int) entries[i].size,
+               (entries[i].flags & PEACHOS_HEAP_TRACE_ENTRY_FREED) ? " freed" : "");
+    }
+
+    free(entries);
+}
+
+/**
+ * heapstat - kernel heap counters
+ * heapstat trace on|off - start or stop tracing kernel heap calls
+ * heapstat trace - most recent traced calls
+ * heapstat live - traced allocations that were never freed
+ */
+static void shell_heapstat(const char* command)
+{
+    const char* args = command + strlen("heapstat");
+    while (*args == ' ')
+    {
+        args++;
+    }
+
+    if (strncmp(args, "trace on", 8) == 0)
+    {
+        peachos_heap_trace(NULL, 0, PEACHOS_HEAP_TRACE_ENABLE);
+    }
+    else if (strncmp(args, "trace off", 9) == 0)
+    {
+        peachos_heap_trace(NULL, 0, PEACHOS_HEAP_TRACE_DISABLE);
+    }
+    else if (strncmp(args, "trace", 5) == 0)
+    {
+        shell_heapstat_trace(0);
+    }
+    else if (strncmp(args, "live", 4) == 0)
+    {
+        shell_heapstat_trace(PEACHOS_HEAP_TRACE_LIVE_ONLY);
+    }
+    else
+    {
+        shell_heapstat_summary();
+    }
+}
+
+/**
+ * boottime - how long each phase of the kernel boot took
+ */
+static void shell_boottime()
+{
+    struct peachos_boot_trace_phase* phases = malloc(sizeof(struct peachos_boot_trace_phase) * PEACHOS_BOOT_TRACE_MAX_PHASES);
+    if (!phases)
+    {
+        print("boottime: out of memory\n");
+        return;
+    }
+
+    long total = peachos_boot_trace(phases, PEACHOS_BOOT_TRACE_MAX_PHASES);
+    for (long i = 0; i < total; i++)
+    {
+        if (phases[i].microseconds == 0 && phases[i].cycles != 0)
+        {
+            // TSC frequency unknown
+            printf("%s at %i kcycles took %i kcycles\n", phases[i].name,
+                   (int) (phases[i].start_cycles / 1000), (int) (phases[i].cycles / 1000));
+            continue;
+        }
+
+        printf("%s at %ius took %ius\n", phases[i].name, (int) phases[i].start_microseconds, (int) phases[i].microseconds);
+    }
+
+    free(phases);
+}
+
+// Rows the scrollback command moves the view by for each key
+#define SHELL_SCROLLBACK_STEP 8
+
+/**
+ * scrollback - look back over output that scrolled off the terminal,
+ * u scrolls further back, d scrolls forward and any other key returns
+ */
+static void shell_scrollback()
+{
+    // Nothing is printed while looking back, writing shows the live rows again
+    long rows_back = peachos_terminal_scrollback(SHELL_SCROLLBACK_STEP);
+    while (rows_back > 0)
+    {
+        int key = peachos_getkeyblock();
+        if (key == 'u')
+        {
+            rows_back = peachos_terminal_scrollback(rows_back + SHELL_SCROLLBACK_STEP);
+        }
+        else if (key == 'd')
+        {
+            rows_back = peachos_terminal_scrollback(rows_back > SHELL_SCROLLBACK_STEP ? rows_back - SHELL_SCROLLBACK_STEP : 0);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    peachos_terminal_scrollback(0);
+}
+
 int main(int argc, char** argv)
 {
     // The print causes us to run all the way through memory.
@@ -55,6 +215,24 @@ int main(int argc, char** argv)
         char buf[1024];
         peachos_terminal_readline(buf, sizeof(buf), true);
         print("\n");
+        if (strncmp(buf, "heapstat", 8) == 0)
+        {
+            shell_heapstat(buf);
+            continue;
+        }
+
+        if (strncmp(buf, "boottime", 8) == 0)
+        {
+            shell_boottime();
+            continue;
+        }
+
+        if (strncmp(buf, "scrollback", 10) == 0)
+        {
+            shell_scrollback();
+            continue;
+        }
+
         peachos_system_run(buf);
         
         print("\n");
@@ -41,7 +41,7 @@
 
 section .asm
 
-global print:function
+global peachos_print:function
 global peachos_getkey:function
 global peachos_malloc:function
 global peachos_free:function
@@ -66,9 +66,15 @@ global peachos_graphics_create:function
 global peachos_window_redraw_region:function
 global peachos_window_title_set:function
 global peachos_udelay:function;
-
-; void print(const char* filename)
-print:
+global peachos_write:function
+global peachos_heap_stats:function
+global peachos_heap_trace:function
+global peachos_window_redraw_regions:function
+global peachos_boot_trace:function
+global peachos_terminal_scrollback:function
+
+; void peachos_print(const char* message)
+peachos_print:
     push qword rdi
     mov rax, 1 ; Command print
     int 0x80
@@ -294,3 +300,61 @@ peachos_udelay:
     int 0x80        ; invoke the kernel
     add rsp, 8 ; restore stack
     ret
+
+; long peachos_write(const char* buffer, size_t len);
+peachos_write:
+    mov rax, 26 ; command 26 write
+    push qword rsi ; len
+    push qword rdi ; buffer
+    int 0x80        ; invoke the kernel
+    add rsp, 16 ; restore stack
+    ; RAX = total bytes written or negative on error
+    ret
+
+; long peachos_heap_stats(struct peachos_heap_stats* stats_out);
+peachos_heap_stats:
+    mov rax, 27 ; command 27 heap stats
+    push qword rdi ; stats_out
+    int 0x80        ; invoke the kernel
+    add rsp, 8 ; restore stack
+    ret
+
+; long peachos_heap_trace(struct peachos_heap_trace_entry* entries_out, size_t max_entries, long flags);
+peachos_heap_trace:
+    mov rax, 28 ; command 28 heap trace
+    push qword rdx ; flags
+    push qword rsi ; max_entries
+    push qword rdi ; entries_out
+    int 0x80        ; invoke the kernel
+    add rsp, 24 ; restore stack
+    ; RAX = total entries copied or negative on error
+    ret
+
+; long peachos_window_redraw_regions(struct peachos_window_rect* rects, size_t total_rects, struct window* window);
+peachos_window_redraw_regions:
+    mov rax, 29 ; command 29 redraw many regions of the window
+    push qword rdx ; window
+    push qword rsi ; total_rects
+    push qword rdi ; rects
+    int 0x80        ; invoke the kernel
+    add rsp, 24 ; restore stack
+    ret
+
+; long peachos_boot_trace(struct peachos_boot_trace_phase* phases_out, size_t max_phases);
+peachos_boot_trace:
+    mov rax, 30 ; command 30 boot trace
+    push qword rsi ; max_phases
+    push qword rdi ; phases_out
+    int 0x80        ; invoke the kernel
+    add rsp, 16 ; restore stack
+    ; RAX = total phases copied or negative on error
+    ret
+
+; long peachos_terminal_scrollback(size_t rows_back);
+peachos_terminal_scrollback:
+    mov rax, 31 ; command 31 terminal scrollback
+    push qword rdi ; rows_back
+    int 0x80        ; invoke the kernel
+    add rsp, 8 ; restore stack
+    ; RAX = rows the view is scrolled back by or negative on error
+    ret
@@ -41,6 +41,7 @@
 
 #include "peachos.h"
 #include "string.h"
+#include "stdio.h"
 
 struct command_argument* peachos_parse_command(const char* command, int max)
 {
@@ -87,9 +88,17 @@ struct command_argument* peachos_parse_command(const char* command, int max)
 out:
     return root_command;
 }
+void print(const char* message)
+{
+    fflush();
+    peachos_print(message);
+}
+
 int peachos_getkeyblock()
 {
     int val = 0;
+    // Anything we prompted with should be visible before we block
+    fflush();
     do
     {
         val = peachos_getkey();
@@ -62,7 +62,105 @@ struct process_arguments
 struct window;
 struct window_event;
 
-void print(const char* filename);
+// Must match the kernel heap statistics in kheap.h
+#define PEACHOS_HEAP_STATS_MAX_HEAPS 16
+#define PEACHOS_HEAP_STATS_TOTAL_SIZE_CLASSES 8
+
+enum
+{
+    PEACHOS_HEAP_STATS_HEAP_FLAG_PAGING = 0b00000001
+};
+
+struct peachos_heap_stats_heap
+{
+    uint64_t start_address;
+    uint64_t end_address;
+    uint64_t flags;
+
+    uint64_t total_blocks;
+    uint64_t used_blocks;
+    uint64_t peak_used_blocks;
+
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t failed_allocations;
+    uint64_t bytes_requested;
+
+    uint64_t largest_free_extent;
+    uint64_t total_free_extents;
+    // 0 when the free blocks are contiguous, up to 100
+    uint64_t fragmentation_index;
+};
+
+struct peachos_heap_stats
+{
+    uint64_t block_size;
+    uint64_t total_heaps;
+    uint64_t failed_allocations;
+    struct peachos_heap_stats_heap heaps[PEACHOS_HEAP_STATS_MAX_HEAPS];
+
+    // Size class N holds allocations of up to 2^N blocks
+    struct
+    {
+        uint64_t allocations;
+        uint64_t frees;
+        uint64_t failed_allocations;
+    } size_classes[PEACHOS_HEAP_STATS_TOTAL_SIZE_CLASSES];
+
+    // Pre-zeroed page frames, hits were served from the pool and misses had to be zeroed
+    struct
+    {
+        uint64_t depth;
+        uint64_t capacity;
+        uint64_t hits;
+        uint64_t misses;
+    } zero_pool;
+};
+
+enum
+{
+    PEACHOS_HEAP_TRACE_ENABLE = 0b00000001,
+    PEACHOS_HEAP_TRACE_DISABLE = 0b00000010,
+    PEACHOS_HEAP_TRACE_LIVE_ONLY = 0b00000100
+};
+
+enum
+{
+    PEACHOS_HEAP_TRACE_ENTRY_FREED = 0b00000001
+};
+
+struct peachos_heap_trace_entry
+{
+    // Kernel address that called into the heap
+    uint64_t caller;
+    uint64_t ptr;
+    uint64_t size;
+    uint64_t flags;
+};
+
+// Must match the kernel boot trace in boottrace.h
+#define PEACHOS_BOOT_TRACE_MAX_PHASES 32
+#define PEACHOS_BOOT_TRACE_MAX_NAME 32
+
+struct peachos_boot_trace_phase
+{
+    char name[PEACHOS_BOOT_TRACE_MAX_NAME];
+
+    // Cycles from the first phase to the start of this one and how long it ran
+    uint64_t start_cycles;
+    uint64_t cycles;
+
+    // Zero when the kernel does not know the TSC frequency
+    uint64_t start_microseconds;
+    uint64_t microseconds;
+};
+
+/**
+ * Writes the message straight to the terminal, anything buffered
+ * for stdout is flushed first so the output stays in order
+ */
+void print(const char* message);
+void peachos_print(const char* message);
 int peachos_getkey();
 
 void* peachos_malloc(size_t size);
@@ -88,6 +186,37 @@ void peachos_exit();
 void* peachos_window_create(const char* title, long width, long height, long flags, long id);
 void peachos_window_redraw_region(long rel_x, long rel_y, long rel_width, long rel_height, struct window* window);
 
+// Rectangle relative to the window body, mirrors struct window_rect in the kernel
+struct peachos_window_rect
+{
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+// Most rectangles accepted by one call
+#define PEACHOS_WINDOW_MAX_REDRAW_RECTS 32
+
+/**
+ * Redraws all the rectangles of the window body, they reach the screen together
+ * \return Returns zero on success, negative on error
+ */
+long peachos_window_redraw_regions(struct peachos_window_rect* rects, size_t total_rects, struct window* window);
+
+/**
+ * Copies up to max_phases of the phases the kernel timed while booting, in the
+ * order they ran. phases_out must be heap allocated. Returns the total copied
+ */
+long peachos_boot_trace(struct peachos_boot_trace_phase* phases_out, size_t max_phases);
+
+/**
+ * Shows the stdout terminal rows_back rows back in its scrollback, zero shows the
+ * live rows. Anything written to the terminal also shows the live rows again
+ * \return Returns the rows the view is scrolled back by, negative on error
+ */
+long peachos_terminal_scrollback(size_t rows_back);
+
 void peachos_divert_stdout_to_window(struct window* window);
 
 
@@ -134,6 +263,22 @@ struct window* window_main();
 
 void peachos_udelay(uint64_t microseconds);
 
+/**
+ * Writes len bytes of the buffer to stdout in a single system call
+ */
+long peachos_write(const char* buffer, size_t len);
+
+/**
+ * Copies the kernel heap statistics, stats_out must be heap allocated
+ */
+long peachos_heap_stats(struct peachos_heap_stats* stats_out);
+
+/**
+ * Applies the PEACHOS_HEAP_TRACE flags then copies up to max_entries of the
+ * kernel heap calls traced, newest first. Returns the total copied
+ */
+long peachos_heap_trace(struct peachos_heap_trace_entry* entries_out, size_t max_entries, long flags);
+
 // Updats the title of a window.
 void peachos_window_title_set(struct window* window, const char* title);
 
@@ -77,6 +77,7 @@ void c_start()
 
 
     int res = main(arguments.argc, arguments.argv);
+    fflush();
     if (res == 0)
     {
         
@@ -44,9 +44,94 @@
 #include "stdlib.h"
 #include "string.h"
 #include <stdarg.h>
+#include <stdint.h>
+
+struct stdout_stream
+{
+    // Allocated on first use so the kernel can validate it as process memory
+    char* buffer;
+    size_t total;
+    int mode;
+};
+
+static struct stdout_stream stdout_stream = {NULL, 0, STDIO_BUFFER_MODE_LINE};
+
+int fflush()
+{
+    int res = 0;
+    if (stdout_stream.total > 0)
+    {
+        res = peachos_write(stdout_stream.buffer, stdout_stream.total);
+        stdout_stream.total = 0;
+    }
+    return res < 0 ? res : 0;
+}
+
+int stdout_buffer_mode_set(int mode)
+{
+    if (mode != STDIO_BUFFER_MODE_FULL && mode != STDIO_BUFFER_MODE_LINE && mode != STDIO_BUFFER_MODE_NONE)
+    {
+        return -1;
+    }
+
+    fflush();
+    stdout_stream.mode = mode;
+    return 0;
+}
+
+static void stdout_put(char c)
+{
+    if (stdout_stream.mode == STDIO_BUFFER_MODE_NONE)
+    {
+        peachos_putchar(c);
+        return;
+    }
+
+    if (!stdout_stream.buffer)
+    {
+        stdout_stream.buffer = peachos_malloc(STDIO_STDOUT_BUFFER_SIZE);
+        if (!stdout_stream.buffer)
+        {
+            // No memory for a buffer, write it unbuffered
+            peachos_putchar(c);
+            return;
+        }
+    }
+
+    stdout_stream.buffer[stdout_stream.total++] = c;
+    if (stdout_stream.total == STDIO_STDOUT_BUFFER_SIZE ||
+        (stdout_stream.mode == STDIO_BUFFER_MODE_LINE && c == '\n'))
+    {
+        fflush();
+    }
+}
+
+static void stdout_puts(const char* str)
+{
+    while(*str)
+    {
+        stdout_put(*str);
+        str++;
+    }
+}
+
+static const char* stdio_hex(uint64_t value)
+{
+    static char text[17];
+    int loc = 16;
+    text[16] = 0;
+    do
+    {
+        text[--loc] = "0123456789abcdef"[value & 0x0f];
+        value >>= 4;
+    } while (value);
+
+    return &text[loc];
+}
+
 int putchar(int c)
 {
-    peachos_putchar((char)c);
+    stdout_put((char)c);
     return 0;
 }
 
@@ -70,12 +155,28 @@ int printf(const char *fmt, ...)
         {
         case 'i':
             ival = va_arg(ap, int);
-            print(itoa(ival));
+            stdout_puts(itoa(ival));
             break;
 
         case 's':
             sval = va_arg(ap, char *);
-            print(sval);
+            stdout_puts(sval);
+            break;
+
+        case 'x':
+            ival = va_arg(ap, int);
+            stdout_puts(stdio_hex((unsigned int) ival));
+            break;
+
+        case 'l':
+            // %lx prints all 64 bits of a long in hex
+            if (*(p + 1) == 'x')
+            {
+                p++;
+                stdout_puts(stdio_hex(va_arg(ap, unsigned long)));
+                break;
+            }
+            putchar(*p);
             break;
 
         default:
@@ -42,6 +42,25 @@
 #ifndef PEACHOS_STDIO
 #define PEACHOS_STDIO
 
+#define STDIO_STDOUT_BUFFER_SIZE 1024
+
+enum
+{
+    // Flushed only when the buffer fills or fflush is called
+    STDIO_BUFFER_MODE_FULL,
+    // Flushed on every new line, the default for stdout
+    STDIO_BUFFER_MODE_LINE,
+    // Every character is written straight away
+    STDIO_BUFFER_MODE_NONE
+};
+
+int stdout_buffer_mode_set(int mode);
+
+/**
+ * Writes anything buffered for stdout to the kernel
+ */
+int fflush();
+
 int putchar(int c);
 int printf(const char *fmt, ...);
 int sprintf(char *str, const char *fmt, ...);
@@ -0,0 +1,147 @@
+/*
+ * PeachOS 64-Bit Kernel Project
+ * Copyright (C) 2026 Daniel McCarthy <daniel@dragonzap.com>
+ *
+ * This file is part of the PeachOS 64-Bit Kernel.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * For full source code, documentation, and structured learning,
+ * see the official kernel development course part one:
+ * https://dragonzap.com/course/developing-a-multithreaded-kernel-from-scratch
+ *
+ * Get part one and part two module one, module two all peachos courses (69 hours of content): https://dragonzap.com/offer/kernel-development-from-scratch-69-hours
+ *
+ * Get the part two course module one and two: https://dragonzap.com/offer/developing-a-multithreaded-kernel-from-scratch-part-two-full-series
+ */
+
+
+#include "boottrace.h"
+#include "kernel.h"
+#include "io/tsc.h"
+#include "string/string.h"
+#include "memory/memory.h"
+#include <stdbool.h>
+
+struct boot_trace_entry
+{
+    const char* name;
+    TIME_TSC start;
+    // Zero while the phase is running
+    TIME_TSC end;
+};
+
+// Fixed so phases can be timed before the heap exists
+static struct boot_trace_entry boot_trace_log[PEACHOS_BOOT_TRACE_MAX_PHASES];
+static size_t boot_trace_total = 0;
+
+void boot_trace_end()
+{
+    if (boot_trace_total == 0)
+    {
+        return;
+    }
+
+    struct boot_trace_entry* entry = &boot_trace_log[boot_trace_total - 1];
+    if (entry->end == 0)
+    {
+        entry->end = read_tsc();
+    }
+}
+
+void boot_trace_begin(const char* name)
+{
+    boot_trace_end();
+    if (boot_trace_total >= PEACHOS_BOOT_TRACE_MAX_PHASES)
+    {
+        // Log is full, later phases go untimed
+        return;
+    }
+
+    struct boot_trace_entry* entry = &boot_trace_log[boot_trace_total];
+    entry->name = name;
+    entry->end = 0;
+    entry->start = read_tsc();
+    boot_trace_total++;
+}
+
+static TIME_MICROSECONDS boot_trace_microseconds(TIME_TSC cycles)
+{
+    TIME_TSC frequency = tsc_frequency();
+    if (frequency == 0)
+    {
+        return 0;
+    }
+
+    return (cycles * 1000000) / frequency;
+}
+
+static void boot_trace_phase_get(size_t index, struct boot_trace_phase* phase_out)
+{
+    struct boot_trace_entry* entry = &boot_trace_log[index];
+    TIME_TSC end = entry->end ? entry->end : read_tsc();
+
+    memset(phase_out, 0, sizeof(*phase_out));
+    strncpy(phase_out->name, entry->name, sizeof(phase_out->name) - 1);
+    phase_out->start_cycles = entry->start - boot_trace_log[0].start;
+    phase_out->cycles = end - entry->start;
+    phase_out->start_microseconds = boot_trace_microseconds(phase_out->start_cycles);
+    phase_out->microseconds = boot_trace_microseconds(phase_out->cycles);
+}
+
+size_t boot_trace_copy(struct boot_trace_phase* phases_out, size_t max_phases)
+{
+    size_t copied = 0;
+    for (size_t i = 0; i < boot_trace_total && copied < max_phases; i++)
+    {
+        boot_trace_phase_get(i, &phases_out[copied++]);
+    }
+
+    return copied;
+}
+
+void boot_trace_report()
+{
+    // Insertion sort of the phase indexes, slowest first
+    size_t order[PEACHOS_BOOT_TRACE_MAX_PHASES];
+    for (size_t i = 0; i < boot_trace_total; i++)
+    {
+        size_t j = i;
+        TIME_TSC cycles = (boot_trace_log[i].end ? boot_trace_log[i].end : read_tsc()) - boot_trace_log[i].start;
+        while (j > 0)
+        {
+            struct boot_trace_entry* previous = &boot_trace_log[order[j - 1]];
+            TIME_TSC previous_cycles = (previous->end ? previous->end : read_tsc()) - previous->start;
+            if (previous_cycles >= cycles)
+            {
+                break;
+            }
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    bool has_frequency = tsc_frequency() != 0;
+    print("Boot phases, slowest first");
+    print(has_frequency ? " (microseconds)\n" : " (thousands of cycles, TSC frequency unknown)\n");
+    for (size_t i = 0; i < boot_trace_total; i++)
+    {
+        struct boot_trace_phase phase;
+        boot_trace_phase_get(order[i], &phase);
+        print(itoa((int)(has_frequency ? phase.microseconds : phase.cycles / 1000)));
+        print("  ");
+        print(phase.name);
+        print("\n");
+    }
+}
@@ -0,0 +1,71 @@
+/*
+ * PeachOS 64-Bit Kernel Project
+ * Copyright (C) 2026 Daniel McCarthy <daniel@dragonzap.com>
+ *
+ * This file is part of the PeachOS 64-Bit Kernel.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * For full source code, documentation, and structured learning,
+ * see the official kernel development course part one:
+ * https://dragonzap.com/course/developing-a-multithreaded-kernel-from-scratch
+ *
+ * Get part one and part two module one, module two all peachos courses (69 hours of content): https://dragonzap.com/offer/kernel-development-from-scratch-69-hours
+ *
+ * Get the part two course module one and two: https://dragonzap.com/offer/developing-a-multithreaded-kernel-from-scratch-part-two-full-series
+ */
+
+
+#ifndef KERNEL_BOOTTRACE_H
+#define KERNEL_BOOTTRACE_H
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+// A boot phase as copied to userland
+struct boot_trace_phase
+{
+    char name[PEACHOS_BOOT_TRACE_MAX_NAME];
+
+    // Cycles from the first phase to the start of this one and how long it ran
+    uint64_t start_cycles;
+    uint64_t cycles;
+
+    // The same converted with tsc_frequency, zero when the frequency is unknown
+    uint64_t start_microseconds;
+    uint64_t microseconds;
+};
+
+/**
+ * Ends the phase that is running and starts timing the next,
+ * name must stay valid for the life of the kernel
+ */
+void boot_trace_begin(const char* name);
+
+/**
+ * Ends the phase that is running
+ */
+void boot_trace_end();
+
+/**
+ * Prints the boot phases slowest first
+ */
+void boot_trace_report();
+
+/**
+ * Copies up to max_phases boot phases in the order they ran
+ * \return Returns the total copied
+ */
+size_t boot_trace_copy(struct boot_trace_phase* phases_out, size_t max_phases);
+
+#endif
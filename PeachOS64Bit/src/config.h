@@ -54,6 +54,34 @@
 #define PEACHOS_HEAP_MINIMUM_SIZE_BYTES 104857600
 #define PEACHOS_HEAP_BLOCK_SIZE 4096
 
+// Memory identity mapped by the boot page tables in kernel.asm
+#define PEACHOS_BOOT_IDENTITY_MAP_END 0x40000000
+
+// Physical page frames are handed out in blocks of 2^order pages
+#define PEACHOS_FRAME_MAX_ORDER 18
+#define PEACHOS_FRAME_MAX_ZONES 16
+#define PEACHOS_FRAME_CPU_CACHE_SIZE 64
+#define PEACHOS_FRAME_CPU_CACHE_BATCH 16
+#define PEACHOS_MAX_CPUS 1
+
+// Pages kept zeroed ahead of time, topped up while no task is runnable
+#define PEACHOS_FRAME_ZERO_POOL_SIZE 256
+#define PEACHOS_FRAME_ZERO_POOL_REFILL_BATCH 8
+
+// The kernel heap starts with a 64MB block and grows 4MB at a time
+#define PEACHOS_KHEAP_INITIAL_ORDER 14
+#define PEACHOS_KHEAP_GROW_ORDER 10
+
+// Most recent kernel heap calls remembered while tracing is enabled
+#define PEACHOS_KHEAP_TRACE_ENTRIES 256
+
+// Check the paging heap realloc paths once paging is up, a failure panics
+#define PEACHOS_KHEAP_SELF_CHECK 1
+
+// Boot phases timed by boot_trace_begin, the name is cut to fit
+#define PEACHOS_BOOT_TRACE_MAX_PHASES 32
+#define PEACHOS_BOOT_TRACE_MAX_NAME 32
+
 // The minimal address the heap can point at, ensuring
 // that the kernel does not get overwritten
 #define PEACHOS_MINIMAL_HEAP_ADDRESS 0x01100000
@@ -78,6 +106,10 @@
 #define PEACHOS_PROGRAM_VIRTUAL_STACK_ADDRESS_START 0x3FF000
 #define PEACHOS_PROGRAM_VIRTUAL_STACK_ADDRESS_END PEACHOS_PROGRAM_VIRTUAL_STACK_ADDRESS_START - PEACHOS_USER_PROGRAM_STACK_SIZE
 
+// User address range for mappings that have no fixed address, above any physical memory
+#define PEACHOS_PROCESS_MMAP_START 0x100000000000
+#define PEACHOS_PROCESS_MMAP_END   0x7FFFFFFFF000
+
 #define PEACHOS_MAX_PROGRAM_ALLOCATIONS 1024
 #define PEACHOS_MAX_PROCESSES 12
 
@@ -91,4 +123,17 @@
 #define WINDOW_MAX_TITLE 128
 #define WINDOW_BORDER_PIXEL_SIZE 2
 #define WINDOW_TITLE_BAR_HEIGHT 32
+
+// Most rectangles a process can ask to redraw in one call
+#define WINDOW_MAX_REDRAW_RECTS 32
+
+// Size in pixels of the screen tiles used to find the window under a point
+#define WINDOW_SPATIAL_TILE_SIZE 64
+
+// Composite into a system memory copy of the screen and present the damaged rows
+// to the framebuffer, set to zero to composite straight into the framebuffer
+#define PEACHOS_GRAPHICS_BACK_BUFFER 1
+
+// Total rows a terminal keeps after they scroll off the top
+#define TERMINAL_SCROLLBACK_ROWS 128
 #endif
\ No newline at end of file
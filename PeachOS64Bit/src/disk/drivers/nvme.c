@@ -29,6 +29,7 @@
 #include "status.h"
 #include "memory/heap/kheap.h"
 #include "memory/paging/paging.h"
+#include "memory/frame/frame.h"
 #include "memory/memory.h"
 #include "io/pci.h"
 #include "kernel.h"
@@ -337,8 +338,9 @@ static int nvme_disk_driver_mount_for_device(struct disk_driver* driver, struct
     p->completion_queue.size = (NVME_ADMIN_COMPLETION_QUEUE_TOTAL_ENTRIES <= mqes) ? NVME_ADMIN_COMPLETION_QUEUE_TOTAL_ENTRIES : mqes;
     p->submission_queue.tail = 0;
     p->completion_queue.head = 0;
-    p->submission_queue.ptr = kzalloc(sizeof(*p->submission_queue.ptr) * p->submission_queue.size);
-    p->completion_queue.ptr = kzalloc(sizeof(*p->completion_queue.ptr) * p->completion_queue.size);
+    // Queues are read by the controller, they must be physically contiguous pages
+    p->submission_queue.ptr = frame_zalloc(frame_order_for_size(sizeof(*p->submission_queue.ptr) * p->submission_queue.size));
+    p->completion_queue.ptr = frame_zalloc(frame_order_for_size(sizeof(*p->completion_queue.ptr) * p->completion_queue.size));
     if (!p->submission_queue.ptr || !p->completion_queue.ptr)
     {
         nvme_disk_driver_unmount(disk);
@@ -388,8 +390,8 @@ static int nvme_disk_driver_mount_for_device(struct disk_driver* driver, struct
     p->io_completion_queue.head = 0;
     p->io_completion_queue.phase = 1;
 
-    p->io_submission_queue.ptr = kzalloc(sizeof(struct nvme_submission_queue_entry) * io_entries);
-    p->io_completion_queue.ptr = kzalloc(sizeof(struct nvme_completion_queue_entry) * io_entries);
+    p->io_submission_queue.ptr = frame_zalloc(frame_order_for_size(sizeof(struct nvme_submission_queue_entry) * io_entries));
+    p->io_completion_queue.ptr = frame_zalloc(frame_order_for_size(sizeof(struct nvme_completion_queue_entry) * io_entries));
 
     if (!p->io_submission_queue.ptr || !p->io_completion_queue.ptr)
     {
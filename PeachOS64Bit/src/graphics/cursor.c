@@ -0,0 +1,236 @@
+/*
+ * PeachOS 64-Bit Kernel Project
+ * Copyright (C) 2026 Daniel McCarthy <daniel@dragonzap.com>
+ *
+ * This file is part of the PeachOS 64-Bit Kernel.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * For full source code, documentation, and structured learning,
+ * see the official kernel development course part one:
+ * https://dragonzap.com/course/developing-a-multithreaded-kernel-from-scratch
+ *
+ * Get part one and part two module one, module two all peachos courses (69 hours of content): https://dragonzap.com/offer/kernel-development-from-scratch-69-hours
+ *
+ * Get the part two course module one and two: https://dragonzap.com/offer/developing-a-multithreaded-kernel-from-scratch-part-two-full-series
+ */
+
+
+#include "graphics/cursor.h"
+#include "memory/heap/kheap.h"
+#include "memory/memory.h"
+#include "kernel.h"
+#include "status.h"
+
+static struct cursor_overlay cursor = {0};
+
+static struct framebuffer_pixel* cursor_framebuffer_pixel(struct graphics_info* screen, uint32_t x, uint32_t y)
+{
+    return &screen->framebuffer[y * screen->pixels_per_scanline + x];
+}
+
+/**
+ * Puts back the framebuffer pixels the cursor was covering
+ */
+static void cursor_restore(struct graphics_info* screen)
+{
+    if (!cursor.stamped)
+    {
+        return;
+    }
+
+    for (uint32_t ly = 0; ly < cursor.saved.height; ly++)
+    {
+        for (uint32_t lx = 0; lx < cursor.saved.width; lx++)
+        {
+            *cursor_framebuffer_pixel(screen, cursor.saved.x + lx, cursor.saved.y + ly) = cursor.save_under[ly * cursor.width + lx];
+        }
+    }
+
+    graphics_damage(cursor.saved.x, cursor.saved.y, cursor.saved.width, cursor.saved.height);
+    cursor.stamped = false;
+}
+
+/**
+ * Saves the framebuffer pixels at the cursor position and draws the cursor over them
+ */
+static void cursor_stamp(struct graphics_info* screen)
+{
+    if (!cursor.visible || !cursor.image || cursor.stamped)
+    {
+        return;
+    }
+
+    if (cursor.x < 0 || cursor.y < 0 ||
+        cursor.x >= (int)screen->horizontal_resolution || cursor.y >= (int)screen->vertical_resolution)
+    {
+        return;
+    }
+
+    cursor.saved.x = cursor.x;
+    cursor.saved.y = cursor.y;
+    cursor.saved.width = MIN(cursor.width, screen->horizontal_resolution - cursor.saved.x);
+    cursor.saved.height = MIN(cursor.height, screen->vertical_resolution - cursor.saved.y);
+
+    struct framebuffer_pixel no_transparency_key = {0};
+    bool has_transparency_key = memcmp(&cursor.transparency_key, &no_transparency_key, sizeof(no_transparency_key)) != 0;
+    for (uint32_t ly = 0; ly < cursor.saved.height; ly++)
+    {
+        for (uint32_t lx = 0; lx < cursor.saved.width; lx++)
+        {
+            struct framebuffer_pixel* framebuffer_pixel = cursor_framebuffer_pixel(screen, cursor.saved.x + lx, cursor.saved.y + ly);
+            struct framebuffer_pixel image_pixel = cursor.image[ly * cursor.width + lx];
+            cursor.save_under[ly * cursor.width + lx] = *framebuffer_pixel;
+            if (has_transparency_key && memcmp(&image_pixel, &cursor.transparency_key, sizeof(image_pixel)) == 0)
+            {
+                continue;
+            }
+
+            *framebuffer_pixel = image_pixel;
+        }
+    }
+
+    graphics_damage(cursor.saved.x, cursor.saved.y, cursor.saved.width, cursor.saved.height);
+    cursor.stamped = true;
+}
+
+int cursor_image_set(struct framebuffer_pixel* pixels, size_t width, size_t height, struct framebuffer_pixel transparency_key)
+{
+    int res = 0;
+    struct graphics_info* screen = graphics_screen_info();
+    if (!screen || !pixels || width == 0 || height == 0)
+    {
+        res = -EINVARG;
+        goto out;
+    }
+
+    size_t size = width * height * sizeof(struct framebuffer_pixel);
+    struct framebuffer_pixel* image = kzalloc(size);
+    struct framebuffer_pixel* save_under = kzalloc(size);
+    if (!image || !save_under)
+    {
+        if (image)
+        {
+            kfree(image);
+        }
+        if (save_under)
+        {
+            kfree(save_under);
+        }
+        res = -ENOMEM;
+        goto out;
+    }
+
+    cursor_restore(screen);
+    if (cursor.image)
+    {
+        kfree(cursor.image);
+        kfree(cursor.save_under);
+    }
+
+    memcpy(image, pixels, size);
+    cursor.image = image;
+    cursor.save_under = save_under;
+    cursor.width = width;
+    cursor.height = height;
+    cursor.transparency_key = transparency_key;
+    cursor.visible = true;
+
+    // Stamped again once compositing finishes
+    if (!cursor.compose_depth)
+    {
+        cursor_stamp(screen);
+        graphics_present();
+    }
+
+out:
+    return res;
+}
+
+void cursor_move(int x, int y)
+{
+    struct graphics_info* screen = graphics_screen_info();
+    if (!screen)
+    {
+        return;
+    }
+
+    if (cursor.compose_depth)
+    {
+        // The cursor is lifted, it will be stamped at the new position
+        cursor.x = x;
+        cursor.y = y;
+        return;
+    }
+
+    cursor_restore(screen);
+    cursor.x = x;
+    cursor.y = y;
+    cursor_stamp(screen);
+    graphics_present();
+}
+
+void cursor_visible_set(bool visible)
+{
+    struct graphics_info* screen = graphics_screen_info();
+    cursor.visible = visible;
+    if (!screen || cursor.compose_depth)
+    {
+        return;
+    }
+
+    if (visible)
+    {
+        cursor_stamp(screen);
+    }
+    else
+    {
+        cursor_restore(screen);
+    }
+    graphics_present();
+}
+
+void cursor_compose_begin(uint32_t abs_x, uint32_t abs_y, uint32_t width, uint32_t height)
+{
+    cursor.compose_depth++;
+    if (!cursor.stamped)
+    {
+        return;
+    }
+
+    // Only lift the cursor when the composite will draw over it
+    if (abs_x >= cursor.saved.x + cursor.saved.width || abs_x + width <= cursor.saved.x ||
+        abs_y >= cursor.saved.y + cursor.saved.height || abs_y + height <= cursor.saved.y)
+    {
+        return;
+    }
+
+    cursor_restore(graphics_screen_info());
+    cursor.lifted = true;
+}
+
+void cursor_compose_end()
+{
+    if (cursor.compose_depth == 0)
+    {
+        return;
+    }
+
+    cursor.compose_depth--;
+    if (cursor.compose_depth == 0 && (cursor.lifted || !cursor.stamped))
+    {
+        // The pixels under the cursor may have changed, save them again
+        cursor.lifted = false;
+        cursor_stamp(graphics_screen_info());
+    }
+}
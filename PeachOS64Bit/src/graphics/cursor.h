@@ -0,0 +1,88 @@
+/*
+ * PeachOS 64-Bit Kernel Project
+ * Copyright (C) 2026 Daniel McCarthy <daniel@dragonzap.com>
+ *
+ * This file is part of the PeachOS 64-Bit Kernel.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * For full source code, documentation, and structured learning,
+ * see the official kernel development course part one:
+ * https://dragonzap.com/course/developing-a-multithreaded-kernel-from-scratch
+ *
+ * Get part one and part two module one, module two all peachos courses (69 hours of content): https://dragonzap.com/offer/kernel-development-from-scratch-69-hours
+ *
+ * Get the part two course module one and two: https://dragonzap.com/offer/developing-a-multithreaded-kernel-from-scratch-part-two-full-series
+ */
+
+
+#ifndef KERNEL_GRAPHICS_CURSOR_H
+#define KERNEL_GRAPHICS_CURSOR_H
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "graphics/graphics.h"
+
+/**
+ * The cursor is an overlay stamped straight onto the framebuffer after
+ * compositing, like a hardware cursor plane. The pixels it covers are kept
+ * in a save-under buffer so moving it only restores the old rectangle and
+ * stamps the new one, no graphics are recomposited.
+ */
+struct cursor_overlay
+{
+    // width*height pixels of the cursor image
+    struct framebuffer_pixel* image;
+    size_t width;
+    size_t height;
+
+    // Image pixels of this color are not drawn, black means there is no key
+    struct framebuffer_pixel transparency_key;
+
+    // Absolute screen position of the top left of the cursor
+    int x;
+    int y;
+
+    // Framebuffer pixels underneath the stamped cursor
+    struct framebuffer_pixel* save_under;
+
+    // The clipped screen rectangle held in save_under
+    struct
+    {
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+        uint32_t height;
+    } saved;
+
+    // True while the cursor is drawn on the framebuffer
+    bool stamped;
+    bool visible;
+
+    // Nesting of compositing in progress, the cursor is stamped again once it reaches zero
+    int compose_depth;
+    bool lifted;
+};
+
+int cursor_image_set(struct framebuffer_pixel* pixels, size_t width, size_t height, struct framebuffer_pixel transparency_key);
+void cursor_move(int x, int y);
+void cursor_visible_set(bool visible);
+
+/**
+ * Called around anything that composites to the framebuffer, the cursor is
+ * lifted if the absolute rectangle overlaps it and stamped again at the end
+ */
+void cursor_compose_begin(uint32_t abs_x, uint32_t abs_y, uint32_t width, uint32_t height);
+void cursor_compose_end();
+
+#endif
@@ -162,6 +162,144 @@ struct font* font_load(const char* filename)
 
     return loaded_font;
 }
+static size_t font_bytes_per_character(struct font* font)
+{
+    size_t total_required_bits_per_character = 
+        font->bits_width_per_character *
+        font->bits_height_per_character;
+    
+    size_t total_required_bytes_per_character = total_required_bits_per_character / 8;
+    if ((total_required_bits_per_character % 8) != 0)
+    {
+        total_required_bytes_per_character++;
+    }
+
+    return total_required_bytes_per_character;
+}
+
+static bool font_character_bit(struct font* font, size_t index_character, size_t x, size_t y)
+{
+    size_t char_offset = index_character * font_bytes_per_character(font);
+    size_t bit_index = y * font->bits_width_per_character + x;
+    size_t byte_index = char_offset + (bit_index / 8);
+    return (font->character_data[byte_index] >> (bit_index % 8)) & 0x01;
+}
+
+/**
+ * Walks the glyph rows and records every run of set pixels, when fill_spans is false
+ * the spans are only counted.
+ */
+static size_t font_glyph_spans_walk(struct font* font, bool fill_spans)
+{
+    size_t total_spans = 0;
+    for (size_t index = 0; index < font->character_count; index++)
+    {
+        if (fill_spans)
+        {
+            font->glyphs[index].first_span = total_spans;
+        }
+
+        for (size_t y = 0; y < font->bits_height_per_character; y++)
+        {
+            size_t x = 0;
+            while (x < font->bits_width_per_character)
+            {
+                if (!font_character_bit(font, index, x, y))
+                {
+                    x++;
+                    continue;
+                }
+
+                size_t span_start = x;
+                while (x < font->bits_width_per_character && font_character_bit(font, index, x, y))
+                {
+                    x++;
+                }
+
+                if (fill_spans)
+                {
+                    struct font_glyph_span* span = &font->spans[total_spans];
+                    span->x = span_start;
+                    span->y = y;
+                    span->width = x - span_start;
+                }
+                total_spans++;
+            }
+        }
+
+        if (fill_spans)
+        {
+            font->glyphs[index].total_spans = total_spans - font->glyphs[index].first_span;
+        }
+    }
+
+    return total_spans;
+}
+
+static int font_build_glyph_spans(struct font* font)
+{
+    int res = 0;
+    font->glyphs = kzalloc(sizeof(struct font_glyph) * font->character_count);
+    if (!font->glyphs)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
+    font->total_spans = font_glyph_spans_walk(font, false);
+    if (font->total_spans == 0)
+    {
+        // Empty font, nothing to draw
+        goto out;
+    }
+
+    font->spans = kzalloc(sizeof(struct font_glyph_span) * font->total_spans);
+    if (!font->spans)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
+    font_glyph_spans_walk(font, true);
+out:
+    return res;
+}
+
+/**
+ * Returns a row of pixels filled with the given color that is at least as wide
+ * as a single character. Rows are cached per font so repeated text in the same
+ * color never has to fill the row again.
+ */
+static struct framebuffer_pixel* font_color_row_get(struct font* font, struct framebuffer_pixel font_color)
+{
+    for (size_t i = 0; i < FONT_COLOR_ROW_CACHE_SIZE; i++)
+    {
+        struct font_color_row* row = &font->color_cache.rows[i];
+        if (row->pixels && memcmp(&row->color, &font_color, sizeof(font_color)) == 0)
+        {
+            return row->pixels;
+        }
+    }
+
+    struct font_color_row* row = &font->color_cache.rows[font->color_cache.next];
+    if (!row->pixels)
+    {
+        row->pixels = kzalloc(sizeof(struct framebuffer_pixel) * font->bits_width_per_character);
+        if (!row->pixels)
+        {
+            return NULL;
+        }
+    }
+
+    for (size_t x = 0; x < font->bits_width_per_character; x++)
+    {
+        row->pixels[x] = font_color;
+    }
+    row->color = font_color;
+    font->color_cache.next = (font->color_cache.next + 1) % FONT_COLOR_ROW_CACHE_SIZE;
+    return row->pixels;
+}
+
 struct font* font_create(uint8_t* character_data, size_t character_count, size_t bits_width_per_character, size_t bits_height_per_character, uint8_t subtract_from_ascii_char_index_for_drawing)
 {
     struct font* font = kzalloc(sizeof(struct font));
@@ -175,10 +313,20 @@ struct font* font_create(uint8_t* character_data, size_t character_count, size_t
     font->bits_width_per_character = bits_width_per_character;
     font->bits_height_per_character = bits_height_per_character;
     font->subtract_from_ascii_char_index_for_drawing = subtract_from_ascii_char_index_for_drawing;
+    if (font_build_glyph_spans(font) < 0)
+    {
+        kfree(font->glyphs);
+        kfree(font);
+        return NULL;
+    }
     return font;
 }
 
-int font_draw_from_index(struct graphics_info* graphics_info, struct font* font, int screen_x, int screen_y, int index_character, struct framebuffer_pixel font_color)
+/**
+ * Copies the glyph spans into the graphics pixels without
+ * redrawing anything to the screen.
+ */
+static int font_blit_from_index(struct graphics_info* graphics_info, struct font* font, int screen_x, int screen_y, int index_character, struct framebuffer_pixel font_color)
 {
     int res = 0;
     if (!font)
@@ -187,37 +335,68 @@ int font_draw_from_index(struct graphics_info* graphics_info, struct font* font,
         goto out;
     }
 
-    if (index_character > font->character_count)
+    if (index_character < 0 || index_character >= font->character_count)
     {
         res = 0;
         goto out;
     }
 
-    size_t total_required_bits_per_character = 
-        font->bits_width_per_character *
-        font->bits_height_per_character;
-    
-    size_t total_required_bytes_per_character = total_required_bits_per_character / 8;
-    if ((total_required_bits_per_character % 8) != 0)
+    // Ignore color is the same for every pixel of the glyph so check it once
+    struct framebuffer_pixel black_pixel = {0};
+    if (memcmp(&graphics_info->ignore_color, &black_pixel, sizeof(black_pixel)) != 0 &&
+        memcmp(&graphics_info->ignore_color, &font_color, sizeof(font_color)) == 0)
     {
-        total_required_bytes_per_character++;
+        goto out;
     }
 
-    size_t character_index = index_character * total_required_bytes_per_character;
-    for(size_t x = 0; x < font->bits_width_per_character; x++)
+    struct framebuffer_pixel* color_row = font_color_row_get(font, font_color);
+    if (!color_row)
     {
-        for(size_t y = 0; y < font->bits_height_per_character; y++)
+        res = -ENOMEM;
+        goto out;
+    }
+
+    struct font_glyph* glyph = &font->glyphs[index_character];
+    for (size_t i = 0; i < glyph->total_spans; i++)
+    {
+        struct font_glyph_span* span = &font->spans[glyph->first_span + i];
+        int dst_y = screen_y + span->y;
+        int dst_x = screen_x + span->x;
+        int width = span->width;
+        if (dst_y < 0 || dst_y >= (int) graphics_info->height)
         {
-            size_t char_offset = character_index;
-            size_t bit_index = y * font->bits_width_per_character + x;
-            size_t byte_index = char_offset + (bit_index / 8);
-            if ((font->character_data[byte_index] >> (bit_index % 8)) & 0x01)
-            {
-                size_t abs_x = screen_x + x;
-                size_t abs_y = screen_y + y;
-                graphics_draw_pixel(graphics_info, abs_x, abs_y, font_color);
-            }
+            continue;
+        }
+
+        if (dst_x < 0)
+        {
+            width += dst_x;
+            dst_x = 0;
+        }
+
+        if (dst_x + width > (int) graphics_info->width)
+        {
+            width = (int) graphics_info->width - dst_x;
+        }
+
+        if (width <= 0)
+        {
+            continue;
         }
+
+        memcpy(&graphics_info->pixels[dst_y * graphics_info->width + dst_x], color_row, width * sizeof(struct framebuffer_pixel));
+    }
+
+out:
+    return res;
+}
+
+int font_draw_from_index(struct graphics_info* graphics_info, struct font* font, int screen_x, int screen_y, int index_character, struct framebuffer_pixel font_color)
+{
+    int res = font_blit_from_index(graphics_info, font, screen_x, screen_y, index_character, font_color);
+    if (res < 0)
+    {
+        goto out;
     }
 
     // redraw the region to the screen
@@ -226,6 +405,12 @@ out:
     return res;
 }
 
+int font_blit(struct graphics_info* graphics_info, struct font* font, int screen_x, int screen_y, int character, struct framebuffer_pixel font_color)
+{
+    character -= (int) font->subtract_from_ascii_char_index_for_drawing;
+    return font_blit_from_index(graphics_info, font, screen_x, screen_y, character, font_color);
+}
+
 int font_draw(struct graphics_info* graphics_info, struct font* font, int screen_x, int screen_y, int character, struct framebuffer_pixel font_color)
 {
     character -= (int) font->subtract_from_ascii_char_index_for_drawing;
@@ -243,7 +428,7 @@ int font_draw_text(struct graphics_info* graphics_info, struct font* font, int s
     }
     while(*str != 0)
     {
-        res = font_draw(graphics_info, font, x, y, *str, font_color);
+        res = font_blit(graphics_info, font, x, y, *str, font_color);
         if (res < 0)
         {
             break;
@@ -252,6 +437,12 @@ int font_draw_text(struct graphics_info* graphics_info, struct font* font, int s
         x += font->bits_width_per_character;
         str++;
     }
+
+    // The whole run is redrawn to the screen at once
+    if (x > screen_x)
+    {
+        graphics_redraw_graphics_to_screen(graphics_info, screen_x, screen_y, x - screen_x, font->bits_height_per_character);
+    }
     return res;
 }
 int font_system_init()
@@ -38,6 +38,37 @@
 #define FONT_IMAGE_CHRACTER_HEIGHT_PIXEL_SIZE 16
 #define FONT_IMAGE_CHARACTER_Y_OFFSET 4
 
+// Total (font, color) pixel rows kept around for blitting glyph spans
+#define FONT_COLOR_ROW_CACHE_SIZE 8
+
+/**
+ * A horizontal run of set pixels in a single glyph row
+ */
+struct font_glyph_span
+{
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+};
+
+/**
+ * Index into the fonts span table for a single character
+ */
+struct font_glyph
+{
+    uint32_t first_span;
+    uint32_t total_spans;
+};
+
+/**
+ * A row of pixels pre-filled with a font color, spans are
+ * copied straight out of this row into the graphics pixels.
+ */
+struct font_color_row
+{
+    struct framebuffer_pixel color;
+    struct framebuffer_pixel* pixels;
+};
 
 struct font
 {
@@ -53,12 +84,25 @@ struct font
 
     uint8_t subtract_from_ascii_char_index_for_drawing;
 
+    // Glyphs pre-expanded into row spans, built once when the font is created
+    struct font_glyph* glyphs;
+    struct font_glyph_span* spans;
+    size_t total_spans;
+
+    struct
+    {
+        struct font_color_row rows[FONT_COLOR_ROW_CACHE_SIZE];
+        // Next cache slot to replace when a new color is drawn
+        size_t next;
+    } color_cache;
+
     char filename[PEACHOS_MAX_PATH];
 };
 
 int font_system_init();
 int font_draw_text(struct graphics_info* graphics_info, struct font* font, int screen_x, int screen_y, const char* str, struct framebuffer_pixel font_color);
 int font_draw(struct graphics_info* graphics_info, struct font* font, int screen_x, int screen_y, int character, struct framebuffer_pixel font_color);
+int font_blit(struct graphics_info* graphics_info, struct font* font, int screen_x, int screen_y, int character, struct framebuffer_pixel font_color);
 struct font* font_create(uint8_t* character_data, size_t character_count, size_t bits_width_per_character, size_t bits_height_per_character, uint8_t subtract_from_ascii_char_index_for_drawing);
 struct font* font_load(const char* filename);
 struct font* font_get_loaded_font(const char* filename);
@@ -32,6 +32,7 @@
 #include "memory/memory.h"
 #include "lib/vector/vector.h"
 #include "graphics/window.h"
+#include "graphics/cursor.h"
 #include "status.h"
 
 struct graphics_info *loaded_graphics_info = NULL;
@@ -46,7 +47,25 @@ size_t real_framebuffer_width = 0;
 size_t real_framebuffer_height = 0;
 size_t real_framebuffer_pixels_per_scanline = 0;
 
-void graphics_redraw_children(struct graphics_info *g);
+// The mapped framebuffer of the display when compositing into a back buffer
+// the back buffer is then screen->framebuffer, see graphics_present
+struct framebuffer_pixel *graphics_front_buffer = NULL;
+
+// The damaged columns of each back buffer row, a row with left >= right is clean
+uint32_t *graphics_damage_left = NULL;
+uint32_t *graphics_damage_right = NULL;
+
+// The rows that may have damage
+uint32_t graphics_damage_top = 0;
+uint32_t graphics_damage_bottom = 0;
+
+// Nesting of graphics_batch_begin, presenting waits until it is zero
+int graphics_batch_depth = 0;
+
+// Changes whenever a graphics moves, absolute positions computed
+// in an older generation are recomputed when next used
+uint32_t graphics_position_generation = 1;
+
 void graphics_info_children_free(struct graphics_info *graphics_info);
 
 bool graphics_bounds_check(struct graphics_info *graphics_info, int x, int y)
@@ -75,7 +94,7 @@ void graphics_mouse_click(struct graphics_info *graphics, size_t rel_x_clicked,
 
 void graphics_mouse_click_handler(struct mouse *mouse, int clicked_x, int clicked_y, MOUSE_CLICK_TYPE type)
 {
-    struct graphics_info *graphics = graphics_get_at_screen_position(clicked_x, clicked_y, mouse->graphic.window->root_graphics, true);
+    struct graphics_info *graphics = graphics_get_at_screen_position(clicked_x, clicked_y, NULL, true);
     if (graphics)
     {
         if (clicked_x < (int)graphics->starting_x || clicked_y < (int)graphics->starting_y)
@@ -106,7 +125,7 @@ void graphics_mouse_move(struct graphics_info* graphics, size_t moved_rel_x, siz
 }
 void graphics_mouse_move_handler(struct mouse* mouse, int moved_x, int moved_y)
 {
-    struct graphics_info* graphics = graphics_get_at_screen_position(moved_x, moved_y, mouse->graphic.window->root_graphics, true);
+    struct graphics_info* graphics = graphics_get_at_screen_position(moved_x, moved_y, NULL, true);
     if (graphics)
     {
         size_t rel_x = moved_x - graphics->starting_x;
@@ -173,6 +192,8 @@ void graphics_paste_pixels_to_framebuffer(
     if (clipped_w == 0 || clipped_h == 0)
         return;
 
+    graphics_damage(dst_abs_x, dst_abs_y, clipped_w, clipped_h);
+
     // Copy line by line
     for (uint32_t ly = 0; ly < clipped_h; ly++)
     {
@@ -234,127 +255,305 @@ void graphics_draw_image(struct graphics_info *graphics_info, struct image *imag
         graphics_info = loaded_graphics_info;
     }
 
-    // Loop through each image pixel
-    for (size_t lx = 0; lx < (size_t)image->width; lx++)
+    // Only the part of the image inside the graphics is drawn
+    int start_x = x < 0 ? -x : 0;
+    int start_y = y < 0 ? -y : 0;
+    int end_x = image->width;
+    int end_y = image->height;
+    if (x + end_x > (int)graphics_info->width)
     {
-        for (size_t ly = 0; ly < (size_t)image->height; ly++)
-        {
-            size_t sx = x + lx;
-            size_t sy = y + ly;
+        end_x = (int)graphics_info->width - x;
+    }
+    if (y + end_y > (int)graphics_info->height)
+    {
+        end_y = (int)graphics_info->height - y;
+    }
+    if (start_x >= end_x || start_y >= end_y)
+    {
+        return;
+    }
 
-            image_pixel_data *pixel_data =
-                &((image_pixel_data *)image->data)[(ly * image->width) + lx];
+    struct framebuffer_pixel black_pixel = {0};
+    bool has_ignore_color = memcmp(&graphics_info->ignore_color, &black_pixel, sizeof(black_pixel)) != 0;
+    for (int ly = start_y; ly < end_y; ly++)
+    {
+        // Image pixels are already in framebuffer order
+        image_pixel_data *row_in = &image->data[(size_t)ly * image->width];
+        if (!has_ignore_color)
+        {
+            struct framebuffer_pixel *row_out = &graphics_info->pixels[(size_t)(y + ly) * graphics_info->width + (x + start_x)];
+            memcpy(row_out, &row_in[start_x], (end_x - start_x) * sizeof(struct framebuffer_pixel));
+            continue;
+        }
 
+        for (int lx = start_x; lx < end_x; lx++)
+        {
             struct framebuffer_pixel fb_pixel = {0};
-            fb_pixel.red = pixel_data->R;
-            fb_pixel.green = pixel_data->G;
-            fb_pixel.blue = pixel_data->B;
-
-            // Draw the pixel
-            graphics_draw_pixel(graphics_info, sx, sy, fb_pixel);
+            memcpy(&fb_pixel, &row_in[lx], sizeof(fb_pixel));
+            graphics_draw_pixel(graphics_info, x + lx, y + ly, fb_pixel);
         }
     }
 }
-void graphics_redraw_only(struct graphics_info *g)
+bool graphics_is_opaque(struct graphics_info *g)
 {
-    if (!g)
+    // Graphics with a transparency key show what is behind them
+    struct framebuffer_pixel no_transparency_key = {0};
+    return memcmp(&g->transparency_key, &no_transparency_key, sizeof(no_transparency_key)) == 0;
+}
+
+static struct graphics_rect graphics_abs_rect(struct graphics_info *g)
+{
+    graphics_position_refresh(g);
+    struct graphics_rect rect = {g->starting_x, g->starting_y, g->width, g->height};
+    return rect;
+}
+
+bool graphics_rect_intersect(struct graphics_rect *a, struct graphics_rect *b, struct graphics_rect *rect_out)
+{
+    uint32_t left = MAX(a->x, b->x);
+    uint32_t top = MAX(a->y, b->y);
+    uint32_t right = MIN(a->x + a->width, b->x + b->width);
+    uint32_t bottom = MIN(a->y + a->height, b->y + b->height);
+    if (right <= left || bottom <= top)
+    {
+        return false;
+    }
+
+    rect_out->x = left;
+    rect_out->y = top;
+    rect_out->width = right - left;
+    rect_out->height = bottom - top;
+    return true;
+}
+
+static void graphics_occluders_push(struct graphics_occluders *occluders, struct graphics_info *g)
+{
+    if (!graphics_is_opaque(g))
+    {
+        return;
+    }
+
+    if (occluders->total == GRAPHICS_MAX_OCCLUDERS)
     {
+        // What it covers may now be drawn over, see graphics_redraw_clipped
+        occluders->overflow = true;
         return;
     }
 
-    // Copy from the local buffer to the absolute screen framebuffer
-    graphics_paste_pixels_to_framebuffer(
-        g,
-        0, 0,
-        g->width, g->height,
-        g->starting_x,
-        g->starting_y);
+    occluders->rects[occluders->total++] = graphics_abs_rect(g);
 }
 
-void graphics_redraw_children(struct graphics_info *g)
+/**
+ * Removes the rectangle from the region, a rectangle that is cut is replaced
+ * by up to four pieces around the cut. When the region has no room for the
+ * pieces the rectangle is kept whole and the region is marked as overflowed.
+ */
+static void graphics_region_subtract(struct graphics_region *region, struct graphics_rect *cut)
 {
-    size_t total_children = vector_count(g->children);
-    for (size_t i = 0; i < total_children; i++)
+    struct graphics_region result = {0};
+    result.overflow = region->overflow;
+    for (size_t i = 0; i < region->total; i++)
     {
-        struct graphics_info *child = NULL;
-        vector_at(g->children, i, &child, sizeof(child));
-        if (child)
+        struct graphics_rect rect = region->rects[i];
+        struct graphics_rect overlap;
+        if (!graphics_rect_intersect(&rect, cut, &overlap))
+        {
+            result.rects[result.total++] = rect;
+            continue;
+        }
+
+        struct graphics_rect pieces[4];
+        size_t total_pieces = 0;
+        if (overlap.y > rect.y)
+        {
+            // Above the cut
+            pieces[total_pieces++] = (struct graphics_rect){rect.x, rect.y, rect.width, overlap.y - rect.y};
+        }
+        if (overlap.y + overlap.height < rect.y + rect.height)
         {
-            graphics_redraw(child);
+            // Below the cut
+            pieces[total_pieces++] = (struct graphics_rect){rect.x, overlap.y + overlap.height, rect.width, rect.y + rect.height - (overlap.y + overlap.height)};
+        }
+        if (overlap.x > rect.x)
+        {
+            // Left of the cut
+            pieces[total_pieces++] = (struct graphics_rect){rect.x, overlap.y, overlap.x - rect.x, overlap.height};
+        }
+        if (overlap.x + overlap.width < rect.x + rect.width)
+        {
+            // Right of the cut
+            pieces[total_pieces++] = (struct graphics_rect){overlap.x + overlap.width, overlap.y, rect.x + rect.width - (overlap.x + overlap.width), overlap.height};
+        }
+
+        // Leave room for the rectangles still to be looked at
+        size_t remaining = region->total - i - 1;
+        if (result.total + total_pieces + remaining > GRAPHICS_MAX_REGION_RECTS)
+        {
+            result.rects[result.total++] = rect;
+            result.overflow = true;
+            continue;
+        }
+
+        for (size_t piece = 0; piece < total_pieces; piece++)
+        {
+            result.rects[result.total++] = pieces[piece];
         }
     }
+
+    *region = result;
 }
 
-void graphics_redraw_region(struct graphics_info *g, uint32_t local_x, uint32_t local_y, uint32_t width, uint32_t height)
+/**
+ * Draws the part of the graphics inside the absolute clip rectangle and its children
+ * with it, pixels covered by an opaque occluder or an opaque child are skipped
+ * as they would be overwritten straight away.
+ */
+static void graphics_composite(struct graphics_info *g, struct graphics_rect *clip, struct graphics_occluders *occluders)
 {
-    if (!g)
+    struct graphics_region region = {0};
+    struct graphics_rect g_rect = graphics_abs_rect(g);
+    if (graphics_rect_intersect(&g_rect, clip, &region.rects[0]))
     {
-        return;
+        region.total = 1;
     }
 
-    if (local_x >= g->width || local_y >= g->height)
+    for (size_t i = 0; i < occluders->total && region.total; i++)
     {
-        return;
+        graphics_region_subtract(&region, &occluders->rects[i]);
     }
 
-    if (local_x + width > g->width)
+    size_t child_count = vector_count(g->children);
+    for (size_t i = 0; i < child_count && region.total; i++)
     {
-        width = g->width - local_x;
+        struct graphics_info *child = vector_at_as(g->children, i, struct graphics_info *);
+        if (child && graphics_is_opaque(child))
+        {
+            struct graphics_rect child_rect = graphics_abs_rect(child);
+            graphics_region_subtract(&region, &child_rect);
+        }
     }
-    if (local_y + height > g->height)
+
+    if (region.overflow)
     {
-        height = g->height - local_y;
+        occluders->overflow = true;
     }
 
-    uint32_t dst_abs_x = g->starting_x + local_x;
-    uint32_t dst_abs_y = g->starting_y + local_y;
-
-    graphics_paste_pixels_to_framebuffer(
-        g,
-        local_x, local_y,
-        width, height,
-        dst_abs_x, dst_abs_y);
-
-    uint32_t region_abs_left = dst_abs_x;
-    uint32_t region_abs_top = dst_abs_y;
-    uint32_t region_abs_right = dst_abs_x + width;
-    uint32_t region_abs_bottom = dst_abs_y + height;
+    for (size_t i = 0; i < region.total; i++)
+    {
+        struct graphics_rect *rect = &region.rects[i];
+        graphics_paste_pixels_to_framebuffer(
+            g,
+            rect->x - g->starting_x, rect->y - g->starting_y,
+            rect->width, rect->height,
+            rect->x, rect->y);
+    }
 
-    // Now check each child, and if a child overlaps this redraw region
-    // then calculate the intersection and redraw that region
-    size_t child_count = vector_count(g->children);
+    // Children are drawn in z order, each one is occluded by the opaque children drawn after it
+    size_t total_occluders = occluders->total;
     for (size_t i = 0; i < child_count; i++)
     {
-        struct graphics_info *child = NULL;
-        vector_at(g->children, i, &child, sizeof(child));
+        struct graphics_info *child = vector_at_as(g->children, i, struct graphics_info *);
         if (!child)
         {
             continue;
         }
 
-        // Childs absolute rectangle
-        uint32_t child_abs_left = child->starting_x;
-        uint32_t child_abs_top = child->starting_y;
-        uint32_t child_abs_right = child->starting_x + child->width;
-        uint32_t child_abs_bottom = child->starting_y + child->height;
+        struct graphics_rect child_rect = graphics_abs_rect(child);
+        struct graphics_rect child_clip;
+        if (!graphics_rect_intersect(&child_rect, clip, &child_clip))
+        {
+            continue;
+        }
 
-        // Compute the intersection between the childs rectangle and the draw region
-        uint32_t intersect_left = MAX(child_abs_left, region_abs_left);
-        uint32_t intersect_top = MAX(child_abs_top, region_abs_top);
-        uint32_t intersect_right = MIN(child_abs_right, region_abs_right);
-        uint32_t intersect_bottom = MIN(child_abs_bottom, region_abs_bottom);
+        for (size_t above = i + 1; above < child_count; above++)
+        {
+            struct graphics_info *above_child = vector_at_as(g->children, above, struct graphics_info *);
+            if (above_child)
+            {
+                graphics_occluders_push(occluders, above_child);
+            }
+        }
+
+        graphics_composite(child, &child_clip, occluders);
+        occluders->total = total_occluders;
+    }
+}
 
-        if (intersect_right > intersect_left && intersect_bottom > intersect_top)
+/**
+ * Collects the opaque graphics drawn above the given graphics that are not part of it,
+ * these are the siblings with a higher z index of it and of each of its ancestors
+ */
+static void graphics_occluders_above(struct graphics_info *g, struct graphics_occluders *occluders)
+{
+    for (struct graphics_info *current = g; current->parent; current = current->parent)
+    {
+        size_t index = 0;
+        if (vector_has(current->parent->children, &current, sizeof(current), &index) < 0)
         {
-            uint32_t child_local_x = intersect_left - child_abs_left;
-            uint32_t child_local_y = intersect_top - child_abs_top;
-            uint32_t intersect_width = intersect_right - intersect_left;
-            uint32_t intersect_height = intersect_bottom - intersect_top;
+            continue;
+        }
+
+        size_t sibling_count = vector_count(current->parent->children);
+        for (size_t i = index + 1; i < sibling_count; i++)
+        {
+            struct graphics_info *sibling = vector_at_as(current->parent->children, i, struct graphics_info *);
+            if (sibling)
+            {
+                graphics_occluders_push(occluders, sibling);
+            }
+        }
+    }
+}
+
+static void graphics_redraw_clipped(struct graphics_info *g, struct graphics_rect *clip)
+{
+    struct graphics_occluders occluders = {0};
+    graphics_occluders_above(g, &occluders);
 
-            // Redraw the region
-            graphics_redraw_region(child, child_local_x, child_local_y, intersect_width, intersect_height);
+    cursor_compose_begin(clip->x, clip->y, clip->width, clip->height);
+    graphics_composite(g, clip, &occluders);
+    if (occluders.overflow && g->parent)
+    {
+        // Graphics above this one may have been drawn over and are not part of it,
+        // composite everything under the clip back to front so they are drawn again.
+        // From the root every occluder is also drawn later, so overflowing there is harmless
+        struct graphics_info *root = g;
+        while (root->parent)
+        {
+            root = root->parent;
         }
+
+        struct graphics_occluders root_occluders = {0};
+        graphics_composite(root, clip, &root_occluders);
+    }
+    cursor_compose_end();
+    graphics_present();
+}
+
+void graphics_redraw_region(struct graphics_info *g, uint32_t local_x, uint32_t local_y, uint32_t width, uint32_t height)
+{
+    if (!g)
+    {
+        return;
+    }
+
+    if (local_x >= g->width || local_y >= g->height)
+    {
+        return;
     }
+
+    if (local_x + width > g->width)
+    {
+        width = g->width - local_x;
+    }
+    if (local_y + height > g->height)
+    {
+        height = g->height - local_y;
+    }
+
+    graphics_position_refresh(g);
+    struct graphics_rect clip = {g->starting_x + local_x, g->starting_y + local_y, width, height};
+    graphics_redraw_clipped(g, &clip);
 }
 
 void graphics_ignore_color(struct graphics_info *graphics_info, struct framebuffer_pixel pixel_color)
@@ -400,32 +599,39 @@ void graphics_draw_rect(
     }
 }
 
-void graphics_info_recalculate(struct graphics_info *graphics_info)
+void graphics_position_refresh(struct graphics_info *graphics_info)
 {
+    if (graphics_info->position_generation == graphics_position_generation)
+    {
+        return;
+    }
+
     if (graphics_info->parent)
     {
+        graphics_position_refresh(graphics_info->parent);
         graphics_info->starting_x = graphics_info->relative_x + graphics_info->parent->starting_x;
         graphics_info->starting_y = graphics_info->relative_y + graphics_info->parent->starting_y;
     }
 
-    if (graphics_info->children)
-    {
-        size_t total_children = vector_count(graphics_info->children);
-        for (size_t i = 0; i < total_children; i++)
-        {
-            struct graphics_info *child_graphics_info = NULL;
-            int res = vector_at(graphics_info->children, i, &child_graphics_info, sizeof(struct graphics_info *));
-            if (res < 0)
-            {
-                break;
-            }
+    graphics_info->position_generation = graphics_position_generation;
+}
 
-            graphics_info_recalculate(child_graphics_info);
-        }
-    }
+void graphics_position_set(struct graphics_info *graphics_info, uint32_t relative_x, uint32_t relative_y)
+{
+    graphics_info->relative_x = relative_x;
+    graphics_info->relative_y = relative_y;
+    graphics_info_recalculate(graphics_info);
+}
+
+void graphics_info_recalculate(struct graphics_info *graphics_info)
+{
+    // Every descendant is now out of date, they are recomputed when next used
+    graphics_position_generation++;
+    graphics_position_refresh(graphics_info);
 }
 void graphics_redraw_graphics_to_screen(struct graphics_info *relative_graphics, uint32_t rel_x, uint32_t rel_y, uint32_t width, uint32_t height)
 {
+    graphics_position_refresh(relative_graphics);
     uint32_t abs_screen_x = relative_graphics->starting_x + rel_x;
     uint32_t abs_screen_y = relative_graphics->starting_y + rel_y;
     graphics_redraw_region(graphics_screen_info(), abs_screen_x, abs_screen_y, width, height);
@@ -486,6 +692,7 @@ struct graphics_info *graphics_get_child_at_position(struct graphics_info *graph
             }
 
             // check if the point x, y is within childs bound
+            graphics_position_refresh(child);
             if (x >= child->starting_x && x < child->starting_x + child->width &&
                 y >= child->starting_y && y < child->starting_y + child->height)
             {
@@ -509,6 +716,7 @@ struct graphics_info *graphics_get_child_at_position(struct graphics_info *graph
             if (graphics_is_in_ignored_branch(child, ignored))
                 continue;
 
+            graphics_position_refresh(child);
             if (x >= child->starting_x && x < child->starting_x + child->width &&
                 y >= child->starting_y && y < child->starting_y + child->height)
             {
@@ -523,6 +731,7 @@ struct graphics_info *graphics_get_child_at_position(struct graphics_info *graph
 
     // If no child qualifies then if the current element contains the point
     // return it.
+    graphics_position_refresh(graphics);
     if (x >= graphics->starting_x && x < graphics->starting_x + graphics->width &&
         y >= graphics->starting_y && y < graphics->starting_y + graphics->height)
     {
@@ -534,7 +743,26 @@ struct graphics_info *graphics_get_child_at_position(struct graphics_info *graph
 
 struct graphics_info *graphics_get_at_screen_position(size_t x, size_t y, struct graphics_info *ignored, bool top_first)
 {
-    return graphics_get_child_at_position(graphics_screen_info(), x, y, ignored, top_first);
+    struct graphics_info *screen = graphics_screen_info();
+    if (!top_first || ignored)
+    {
+        return graphics_get_child_at_position(screen, x, y, ignored, top_first);
+    }
+
+    // The children of the screen are windows, the spatial index finds the top most one
+    // so only the graphics of that window are searched
+    struct window *window = window_get_at_position(x, y, NULL);
+    if (window)
+    {
+        return graphics_get_child_at_position(window->root_graphics, x, y, NULL, true);
+    }
+
+    if (x < screen->width && y < screen->height)
+    {
+        return screen;
+    }
+
+    return NULL;
 }
 
 
@@ -543,10 +771,10 @@ void graphics_redraw(struct graphics_info *g)
     if (!g)
         return;
 
-    graphics_redraw_only(g);
-
-    // Redraw the children
-    graphics_redraw_children(g);
+    // Children are not clipped to their parent, the clip is the whole screen
+    struct graphics_info *screen = graphics_screen_info();
+    struct graphics_rect clip = {0, 0, screen->horizontal_resolution, screen->vertical_resolution};
+    graphics_redraw_clipped(g, &clip);
 }
 
 void graphics_redraw_all()
@@ -720,6 +948,7 @@ struct graphics_info *graphics_info_create_relative(struct graphics_info *source
         goto out;
     }
 
+    graphics_position_refresh(source_graphics);
     size_t parent_x = source_graphics->starting_x;
     size_t parent_y = source_graphics->starting_y;
     size_t parent_width = source_graphics->horizontal_resolution;
@@ -751,6 +980,7 @@ struct graphics_info *graphics_info_create_relative(struct graphics_info *source
     new_graphics->height = height;
     new_graphics->starting_x = starting_x;
     new_graphics->starting_y = starting_y;
+    new_graphics->position_generation = graphics_position_generation;
     new_graphics->relative_x = x;
     new_graphics->relative_y = y;
     new_graphics->framebuffer = source_graphics->framebuffer;
@@ -793,6 +1023,271 @@ out:
     }
     return new_graphics;
 }
+void graphics_damage(uint32_t abs_x, uint32_t abs_y, uint32_t width, uint32_t height)
+{
+    struct graphics_info *screen = graphics_screen_info();
+    if (!graphics_front_buffer || abs_x >= screen->horizontal_resolution || abs_y >= screen->vertical_resolution)
+    {
+        return;
+    }
+
+    uint32_t right = MIN(abs_x + width, screen->horizontal_resolution);
+    uint32_t bottom = MIN(abs_y + height, screen->vertical_resolution);
+    if (right <= abs_x || bottom <= abs_y)
+    {
+        return;
+    }
+
+    for (uint32_t y = abs_y; y < bottom; y++)
+    {
+        if (graphics_damage_left[y] >= graphics_damage_right[y])
+        {
+            graphics_damage_left[y] = abs_x;
+            graphics_damage_right[y] = right;
+            continue;
+        }
+
+        graphics_damage_left[y] = MIN(graphics_damage_left[y], abs_x);
+        graphics_damage_right[y] = MAX(graphics_damage_right[y], right);
+    }
+
+    if (graphics_damage_top >= graphics_damage_bottom)
+    {
+        graphics_damage_top = abs_y;
+        graphics_damage_bottom = bottom;
+        return;
+    }
+
+    graphics_damage_top = MIN(graphics_damage_top, abs_y);
+    graphics_damage_bottom = MAX(graphics_damage_bottom, bottom);
+}
+
+/**
+ * Copies pixels to the framebuffer with non temporal stores, they go straight
+ * to the write combining buffers without reading the framebuffer into the cache
+ */
+static void graphics_stream_pixels(struct framebuffer_pixel *dst, struct framebuffer_pixel *src, size_t total_pixels)
+{
+    uint32_t *dst32 = (uint32_t *)dst;
+    uint32_t *src32 = (uint32_t *)src;
+    if (total_pixels && ((uintptr_t)dst32 & 0x07))
+    {
+        __asm__ __volatile__("movnti %1, %0" : "=m"(*dst32) : "r"(*src32));
+        dst32++;
+        src32++;
+        total_pixels--;
+    }
+
+    uint64_t *dst64 = (uint64_t *)dst32;
+    uint64_t *src64 = (uint64_t *)src32;
+    for (size_t i = 0; i < total_pixels / 2; i++)
+    {
+        __asm__ __volatile__("movnti %1, %0" : "=m"(dst64[i]) : "r"(src64[i]));
+    }
+
+    if (total_pixels & 1)
+    {
+        dst32 = (uint32_t *)(dst64 + total_pixels / 2);
+        src32 = (uint32_t *)(src64 + total_pixels / 2);
+        __asm__ __volatile__("movnti %1, %0" : "=m"(*dst32) : "r"(*src32));
+    }
+}
+
+void graphics_present()
+{
+    if (!graphics_front_buffer || graphics_batch_depth > 0)
+    {
+        return;
+    }
+
+    struct graphics_info *screen = graphics_screen_info();
+    for (uint32_t y = graphics_damage_top; y < graphics_damage_bottom; y++)
+    {
+        uint32_t left = graphics_damage_left[y];
+        uint32_t right = graphics_damage_right[y];
+        if (left >= right)
+        {
+            continue;
+        }
+
+        size_t offset = y * screen->pixels_per_scanline + left;
+        graphics_stream_pixels(&graphics_front_buffer[offset], &screen->framebuffer[offset], right - left);
+        graphics_damage_left[y] = 0;
+        graphics_damage_right[y] = 0;
+    }
+
+    // Non temporal stores are weakly ordered, finish them before returning
+    __asm__ __volatile__("sfence" ::: "memory");
+    graphics_damage_top = 0;
+    graphics_damage_bottom = 0;
+}
+
+int graphics_screen_move_pixels(uint32_t src_x, uint32_t src_y, uint32_t width, uint32_t height, uint32_t dst_x, uint32_t dst_y)
+{
+    int res = 0;
+    struct graphics_info *screen = graphics_screen_info();
+
+    // Reading the framebuffer itself is too slow, without a back buffer the caller should recomposite
+    if (!graphics_front_buffer)
+    {
+        res = -EUNIMP;
+        goto out;
+    }
+
+    if (src_x + width > screen->horizontal_resolution || src_y + height > screen->vertical_resolution ||
+        dst_x + width > screen->horizontal_resolution || dst_y + height > screen->vertical_resolution)
+    {
+        res = -EOUTOFRANGE;
+        goto out;
+    }
+
+    size_t row_size = width * sizeof(struct framebuffer_pixel);
+    for (uint32_t i = 0; i < height; i++)
+    {
+        // Rows are copied away from the direction of the move so overlapping rows are read before they are written
+        uint32_t row = dst_y > src_y ? height - 1 - i : i;
+        memmove(&screen->framebuffer[(dst_y + row) * screen->pixels_per_scanline + dst_x],
+                &screen->framebuffer[(src_y + row) * screen->pixels_per_scanline + src_x],
+                row_size);
+    }
+
+    graphics_damage(dst_x, dst_y, width, height);
+out:
+    return res;
+}
+
+/**
+ * True when the screen shows the pixels of the graphics everywhere inside the absolute
+ * rectangle, nothing above it or below it shows through and no child is drawn over it
+ */
+static bool graphics_rect_uncovered(struct graphics_info *g, struct graphics_rect *rect)
+{
+    struct graphics_rect overlap;
+    size_t child_count = vector_count(g->children);
+    for (size_t i = 0; i < child_count; i++)
+    {
+        struct graphics_info *child = vector_at_as(g->children, i, struct graphics_info *);
+        struct graphics_rect child_rect;
+        if (child)
+        {
+            child_rect = graphics_abs_rect(child);
+            if (graphics_rect_intersect(&child_rect, rect, &overlap))
+            {
+                return false;
+            }
+        }
+    }
+
+    for (struct graphics_info *current = g; current->parent; current = current->parent)
+    {
+        // Ancestors clip what is drawn of their children
+        struct graphics_rect current_rect = graphics_abs_rect(current);
+        if (!graphics_rect_intersect(&current_rect, rect, &overlap) ||
+            overlap.width != rect->width || overlap.height != rect->height)
+        {
+            return false;
+        }
+
+        size_t index = 0;
+        if (vector_has(current->parent->children, &current, sizeof(current), &index) < 0)
+        {
+            return false;
+        }
+
+        size_t sibling_count = vector_count(current->parent->children);
+        for (size_t i = index + 1; i < sibling_count; i++)
+        {
+            struct graphics_info *sibling = vector_at_as(current->parent->children, i, struct graphics_info *);
+            struct graphics_rect sibling_rect;
+            if (sibling)
+            {
+                sibling_rect = graphics_abs_rect(sibling);
+                if (graphics_rect_intersect(&sibling_rect, rect, &overlap))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+int graphics_screen_scroll_up(struct graphics_info *g, uint32_t rel_x, uint32_t rel_y, uint32_t width, uint32_t height, uint32_t lines)
+{
+    int res = 0;
+    if (lines == 0 || lines >= height || rel_x + width > g->width || rel_y + height > g->height)
+    {
+        res = -EINVARG;
+        goto out;
+    }
+
+    graphics_position_refresh(g);
+    struct graphics_rect rect = {g->starting_x + rel_x, g->starting_y + rel_y, width, height};
+    if (!graphics_is_opaque(g) || !graphics_rect_uncovered(g, &rect))
+    {
+        res = -EUNIMP;
+        goto out;
+    }
+
+    // Lift the cursor so it is not copied along with the rows
+    cursor_compose_begin(rect.x, rect.y, rect.width, rect.height);
+    res = graphics_screen_move_pixels(rect.x, rect.y + lines, rect.width, rect.height - lines, rect.x, rect.y);
+    cursor_compose_end();
+out:
+    return res;
+}
+
+void graphics_batch_begin()
+{
+    graphics_batch_depth++;
+}
+
+void graphics_batch_end()
+{
+    if (graphics_batch_depth == 0)
+    {
+        return;
+    }
+
+    graphics_batch_depth--;
+    graphics_present();
+}
+
+/**
+ * Allocates the back buffer the screen is composited into, when there is
+ * not enough memory the screen is composited straight into the framebuffer
+ */
+static void graphics_back_buffer_setup(struct graphics_info *main_graphics_info, size_t framebuffer_size)
+{
+#if PEACHOS_GRAPHICS_BACK_BUFFER
+    struct framebuffer_pixel *back_buffer = kzalloc(framebuffer_size);
+    graphics_damage_left = kzalloc(main_graphics_info->vertical_resolution * sizeof(uint32_t));
+    graphics_damage_right = kzalloc(main_graphics_info->vertical_resolution * sizeof(uint32_t));
+    if (!back_buffer || !graphics_damage_left || !graphics_damage_right)
+    {
+        if (back_buffer)
+        {
+            kfree(back_buffer);
+        }
+        if (graphics_damage_left)
+        {
+            kfree(graphics_damage_left);
+            graphics_damage_left = NULL;
+        }
+        if (graphics_damage_right)
+        {
+            kfree(graphics_damage_right);
+            graphics_damage_right = NULL;
+        }
+        return;
+    }
+
+    graphics_front_buffer = main_graphics_info->framebuffer;
+    main_graphics_info->framebuffer = back_buffer;
+#endif
+}
+
 void graphics_setup(struct graphics_info *main_graphics_info)
 {
     if (loaded_graphics_info)
@@ -817,9 +1312,12 @@ void graphics_setup(struct graphics_info *main_graphics_info)
     main_graphics_info->relative_y = 0;
     main_graphics_info->starting_x = 0;
     main_graphics_info->starting_y = 0;
+    main_graphics_info->position_generation = graphics_position_generation;
 
     // Map the memory we allocated to point to the frame buffer point
-    paging_map_to(kernel_desc(), new_framebuffer_memory, real_framebuffer, real_framebuffer_end, PAGING_IS_WRITEABLE | PAGING_IS_PRESENT);
+    // Write combining, the framebuffer is only ever written in long runs
+    paging_map_to(kernel_desc(), new_framebuffer_memory, real_framebuffer, real_framebuffer_end, PAGING_IS_WRITEABLE | PAGING_IS_PRESENT | PAGING_CACHE_WRITE_COMBINING);
+    graphics_back_buffer_setup(main_graphics_info, framebuffer_size);
 
     loaded_graphics_info = main_graphics_info;
     for (uint32_t y = 0; y < main_graphics_info->vertical_resolution; y++)
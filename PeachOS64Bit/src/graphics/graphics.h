@@ -59,6 +59,38 @@ struct framebuffer_pixel
     uint8_t reserved;
 };
 
+// Absolute screen rectangle
+struct graphics_rect
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+};
+
+// Most rectangles the visible part of a graphics is split into while compositing
+#define GRAPHICS_MAX_REGION_RECTS 32
+struct graphics_region
+{
+    struct graphics_rect rects[GRAPHICS_MAX_REGION_RECTS];
+    size_t total;
+
+    // Set when a rectangle could not be cut, the region covers more than it should
+    bool overflow;
+};
+
+// Most opaque rectangles above a graphics considered while compositing
+#define GRAPHICS_MAX_OCCLUDERS 32
+struct graphics_occluders
+{
+    struct graphics_rect rects[GRAPHICS_MAX_OCCLUDERS];
+    size_t total;
+
+    // Set when an occluder was left out or a region could not be cut by one,
+    // pixels may have been drawn over graphics that are above them
+    bool overflow;
+};
+
 struct graphics_info
 {
     struct framebuffer_pixel* framebuffer;
@@ -75,6 +107,7 @@ struct graphics_info
     uint32_t height;
 
     // The absolute x and y coordinates where the graphic begins
+    // only current after graphics_position_refresh when an ancestor has moved
     uint32_t starting_x;
     uint32_t starting_y;
 
@@ -82,6 +115,9 @@ struct graphics_info
     uint32_t relative_x;
     uint32_t relative_y;
 
+    // The graphics_position_generation starting_x and starting_y were computed in
+    uint32_t position_generation;
+
     struct graphics_info* parent;
     // Vector of struct graphics_info*
     struct vector* children;
@@ -136,8 +172,22 @@ void graphics_paste_pixels_to_pixels(
     int flags
 );
 
+/**
+ * Recomputes the absolute position of the graphics after its relative position changed,
+ * its children are brought up to date lazily by graphics_position_refresh
+ */
 void graphics_info_recalculate(struct graphics_info* graphics_info);
 
+/**
+ * Brings starting_x and starting_y of the graphics up to date with its ancestors
+ */
+void graphics_position_refresh(struct graphics_info* graphics_info);
+
+/**
+ * Moves the graphics relative to its parent
+ */
+void graphics_position_set(struct graphics_info* graphics_info, uint32_t relative_x, uint32_t relative_y);
+
 int graphics_pixel_get(struct graphics_info* graphics_info, uint32_t x, uint32_t y, struct framebuffer_pixel* pixel_out);
 
 void graphics_info_free(struct graphics_info* graphics_in);
@@ -148,6 +198,13 @@ void graphics_transparency_key_remove(struct graphics_info* graphics_info);
 void graphics_ignore_color_finish(struct graphics_info* graphics_info);
 void graphics_redraw_region(struct graphics_info* g, uint32_t local_x , uint32_t local_y, uint32_t width, uint32_t height);
 void graphics_redraw(struct graphics_info* g);
+bool graphics_is_opaque(struct graphics_info* g);
+
+/**
+ * Writes the overlap of the two rectangles to rect_out
+ * \return Returns false when they do not overlap
+ */
+bool graphics_rect_intersect(struct graphics_rect* a, struct graphics_rect* b, struct graphics_rect* rect_out);
 void graphics_draw_pixel(struct graphics_info* graphics_info, uint32_t x, uint32_t y, struct framebuffer_pixel pixel);
 void graphics_draw_image(struct graphics_info* graphics_info, struct image* image, int x, int y);
 void graphics_redraw_graphics_to_screen(struct graphics_info* relative_graphics, uint32_t rel_x, uint32_t rel_y, uint32_t width, uint32_t height);
@@ -155,6 +212,38 @@ struct graphics_info* graphics_screen_info();
 void graphics_setup(struct graphics_info* main_graphics_info);
 void graphics_redraw_all();
 
+/**
+ * Marks the absolute screen rectangle as changed in the back buffer, it is
+ * copied to the framebuffer by the next graphics_present
+ */
+void graphics_damage(uint32_t abs_x, uint32_t abs_y, uint32_t width, uint32_t height);
+
+/**
+ * Copies the damaged rows of the back buffer to the framebuffer.
+ * Does nothing without a back buffer or while a batch is open
+ */
+void graphics_present();
+
+/**
+ * Moves a rectangle of the composited screen to another position in one block copy
+ * \return Returns zero on success, negative when the pixels must be recomposited instead
+ */
+int graphics_screen_move_pixels(uint32_t src_x, uint32_t src_y, uint32_t width, uint32_t height, uint32_t dst_x, uint32_t dst_y);
+
+/**
+ * Scrolls a rectangle of the graphics up on the screen with one block copy, the
+ * bottom lines it exposes still have to be redrawn by the caller
+ * \return Returns zero on success, negative when the rectangle is covered and must be redrawn instead
+ */
+int graphics_screen_scroll_up(struct graphics_info* g, uint32_t rel_x, uint32_t rel_y, uint32_t width, uint32_t height, uint32_t lines);
+
+/**
+ * Composites between begin and end are presented together once the
+ * outermost batch ends, so the screen never shows them half done
+ */
+void graphics_batch_begin();
+void graphics_batch_end();
+
 struct graphics_info* graphics_get_at_screen_position(size_t x, size_t y, struct graphics_info* ignored, bool top_first);
 struct graphics_info* graphics_get_child_at_position(struct graphics_info* graphics,
                                                     size_t x, size_t y,
@@ -137,26 +137,19 @@ struct image* bmp_img_load(void* memory, size_t size)
 
         // destination row
         int dest_row = bottom_up ? (height-1 -row) : row; // flip if its bottom-up
+        image_pixel_data* out_row = &img->data[dest_row * (size_t) width];
         for(int col = 0; col < width; col++)
         {
-            // each pixel is 3 bytes
+            // each pixel is 3 bytes stored B, G, R the same order as our pixels
             uint8_t* bmp_pixel = row_ptr + (col * 3);
-            uint8_t B = bmp_pixel[0];
-            uint8_t G = bmp_pixel[1];
-            uint8_t R = bmp_pixel[2]; 
-
-             // write our image buffer
-            size_t pixel_index = (dest_row * (size_t) width) + (size_t) col;
-            image_pixel_data* out_pix = &((image_pixel_data*)img->data)[pixel_index];
-            out_pix->R = R;
-            out_pix->G = G;
-            out_pix->B = B;
+            out_row[col].B = bmp_pixel[0];
+            out_row[col].G = bmp_pixel[1];
+            out_row[col].R = bmp_pixel[2];
             // zero alpha.
-            out_pix->A = 0;
+            out_row[col].A = 0;
         }
     }
 
-
 out:
     if (res < 0)
     {
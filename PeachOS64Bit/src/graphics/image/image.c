@@ -35,8 +35,18 @@
 #include "status.h"
 #include "string/string.h"
 #include "memory/heap/kheap.h"
+#include "config.h"
+
+struct image_cache_entry
+{
+    char path[PEACHOS_MAX_PATH];
+    struct image* image;
+};
 
 struct vector* image_formats;
+
+// Images decoded this boot, vector of struct image_cache_entry
+struct vector* image_cache;
 int graphics_image_formats_load();
 
 struct image_format* graphics_image_format_get(const char* mime_type)
@@ -92,6 +102,40 @@ image_pixel_data graphics_image_get_pixel(struct image* image, int x, int y)
     return pixel_data;
 }
 
+static struct image* graphics_image_cache_get(const char* path)
+{
+    size_t total_entries = vector_count(image_cache);
+    for (size_t i = 0; i < total_entries; i++)
+    {
+        struct image_cache_entry* entry = vector_at_ptr(image_cache, i);
+        if (entry && strncmp(entry->path, path, sizeof(entry->path)) == 0)
+        {
+            return entry->image;
+        }
+    }
+
+    return NULL;
+}
+
+static void graphics_image_cache_add(const char* path, struct image* image)
+{
+    struct image_cache_entry entry = {0};
+    if (strnlen(path, sizeof(entry.path)) >= sizeof(entry.path))
+    {
+        // Too long to key on, the caller keeps ownership
+        return;
+    }
+
+    strncpy(entry.path, path, sizeof(entry.path));
+    entry.image = image;
+    if (vector_push(image_cache, &entry) < 0)
+    {
+        return;
+    }
+
+    image->flags |= IMAGE_FLAG_CACHED;
+}
+
 struct image* graphics_image_load(const char* path)
 {
     struct image* img = NULL;
@@ -99,6 +143,12 @@ struct image* graphics_image_load(const char* path)
     int fd = 0;
     int res = 0;
 
+    img = graphics_image_cache_get(path);
+    if (img)
+    {
+        return img;
+    }
+
     fd = fopen(path, "r");
     if (fd < 0)
     {
@@ -133,6 +183,8 @@ struct image* graphics_image_load(const char* path)
         goto out;
     }
 
+    graphics_image_cache_add(path, img);
+
 out:
     // Close the file
     fclose(fd);
@@ -156,6 +208,12 @@ out:
 
 void graphics_image_free(struct image* image)
 {
+    if (image->flags & IMAGE_FLAG_CACHED)
+    {
+        // Others may have loaded the same image
+        return;
+    }
+
     image->format->image_free_function(image);
 }
 
@@ -202,6 +260,13 @@ int graphics_image_formats_init()
         goto out;
     }
 
+    image_cache = vector_new(sizeof(struct image_cache_entry), 8, VECTOR_NO_FLAGS);
+    if (!image_cache)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
     res = graphics_image_formats_load();
     if (res < 0)
     {
@@ -215,6 +280,11 @@ out:
         {
             vector_free(image_formats);
         }
+        if (image_cache)
+        {
+            vector_free(image_cache);
+            image_cache = NULL;
+        }
     }
     return res;
 }
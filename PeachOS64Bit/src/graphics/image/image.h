@@ -32,24 +32,34 @@
 #include <stddef.h>
 
 struct image_format;
+
+// Stored in the order of struct framebuffer_pixel so rows copy straight to graphics
 typedef union image_pixel_data {
-    uint32_t data;      // Full 32-bit data RGBA
+    uint32_t data;      // Full 32-bit data BGRA
     struct {
-        uint8_t R;
-        uint8_t G;
         uint8_t B;
+        uint8_t G;
+        uint8_t R;
         uint8_t A;
     };
 } image_pixel_data;
 
+enum
+{
+    // The image belongs to the image cache and is never freed
+    IMAGE_FLAG_CACHED = 0b00000001
+};
+
 struct image
 {
     uint32_t width;
     uint32_t height;
 
-    // Pixel data RGB
+    // Pixel data row by row, top row first
     image_pixel_data* data;
 
+    int flags;
+
     // Private data of the image
     void* private;
 
@@ -80,6 +90,11 @@ int graphics_image_formats_init();
 void graphics_image_format_unload(struct image_format* format);
 void graphics_image_formats_unload();
 void graphics_image_free(struct image* image);
+
+/**
+ * Loads the image at the path, an image loaded before is returned from the
+ * image cache without decoding it again. Do not write to the pixels of loaded images
+ */
 struct image* graphics_image_load(const char* path);
 image_pixel_data graphics_image_get_pixel(struct image* image, int x, int y);
 struct image* graphics_image_load_from_memory(void* memory, size_t max);
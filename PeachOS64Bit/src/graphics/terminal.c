@@ -30,14 +30,20 @@
 #include "graphics/font.h"
 #include "graphics/graphics.h"
 #include "graphics/image/image.h"
-#include "lib/vector/vector.h"
+#include "lib/list/list.h"
 #include "memory/memory.h"
+#include "config.h"
+#include "kernel.h"
 #include "status.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
-struct vector* terminal_vector = NULL;
+// Every terminal that has been created
+struct list terminal_list;
+
+static void terminal_scroll(struct terminal* terminal);
+
 inline static size_t terminal_abs_x_for_next_character(struct terminal* terminal)
 {
     return terminal->bounds.abs_x + (terminal->text.col * terminal->font->bits_width_per_character);
@@ -48,9 +54,59 @@ inline static size_t terminal_abs_y_for_next_character(struct terminal* terminal
     return terminal->bounds.abs_y + (terminal->text.row * terminal->font->bits_height_per_character);
 }
 
+inline static struct terminal_cell* terminal_cell(struct terminal* terminal, size_t row, size_t col)
+{
+    return &terminal->grid.cells[row * terminal->grid.cols + col];
+}
+
+/**
+ * Returns the cell shown at the row and column, the live cell unless
+ * the view is scrolled back into the scrollback
+ */
+static struct terminal_cell* terminal_view_cell(struct terminal* terminal, size_t row, size_t col)
+{
+    size_t view = terminal->scrollback.view;
+    if (row >= view)
+    {
+        return terminal_cell(terminal, row - view, col);
+    }
+
+    return &terminal_scrollback_row(terminal, view - 1 - row)[col];
+}
+
 void terminal_system_setup()
 {
-    terminal_vector = vector_new(sizeof(struct terminal*), 4, 0);
+    list_init(&terminal_list);
+}
+
+static int terminal_grid_create(struct terminal* terminal)
+{
+    int res = 0;
+    terminal->grid.rows = terminal_total_rows(terminal);
+    terminal->grid.cols = terminal_total_cols(terminal);
+    terminal->grid.scrolled_rows = 0;
+    if (terminal->grid.rows == 0 || terminal->grid.cols == 0)
+    {
+        // Smaller than a single character, nothing can be written
+        goto out;
+    }
+
+    terminal->grid.cells = kzalloc(sizeof(struct terminal_cell) * terminal->grid.rows * terminal->grid.cols);
+    if (!terminal->grid.cells)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
+    terminal->grid.dirty = kzalloc(sizeof(struct terminal_dirty_span) * terminal->grid.rows);
+    if (!terminal->grid.dirty)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
+out:
+    return res;
 }
 
 struct terminal* terminal_create(struct graphics_info* graphics_info, int starting_x, int starting_y, size_t width, size_t height, struct font* font, struct framebuffer_pixel font_color, int flags)
@@ -92,16 +148,25 @@ struct terminal* terminal_create(struct graphics_info* graphics_info, int starti
     terminal->font_color = font_color;
     terminal->flags = flags;
 
+    res = terminal_grid_create(terminal);
+    if (res < 0)
+    {
+        goto out;
+    }
+
     // Save the background of the screen, whats behind it
     // where our terminal coords are 
     terminal_background_save(terminal);
 
-    vector_push(terminal_vector, &terminal);
+    list_push_back(&terminal_list, &terminal->list_node);
 
 out:
     if (res < 0)
     {
-        terminal_free(terminal);
+        if (terminal)
+        {
+            terminal_free(terminal);
+        }
         terminal = NULL;
     }
 
@@ -116,24 +181,35 @@ void terminal_free(struct terminal* terminal)
         terminal->terminal_background = NULL;
     }
 
-    vector_pop_element(terminal_vector, &terminal, sizeof(terminal));
+    if (terminal->grid.cells)
+    {
+        kfree(terminal->grid.cells);
+        terminal->grid.cells = NULL;
+    }
+
+    if (terminal->grid.dirty)
+    {
+        kfree(terminal->grid.dirty);
+        terminal->grid.dirty = NULL;
+    }
+
+    if (terminal->scrollback.rows)
+    {
+        kfree(terminal->scrollback.rows);
+        terminal->scrollback.rows = NULL;
+    }
+
+    list_remove(&terminal_list, &terminal->list_node);
     kfree(terminal);
 }
 
 struct terminal* terminal_get_at_screen_position(size_t x, size_t y, struct terminal* ignore_terminal)
 {
-    int res = 0;
     struct terminal* found_terminal = NULL;
-    size_t total_children = vector_count(terminal_vector);
-    for(size_t i = 0; i < total_children; i++)
+    struct list_node* node = NULL;
+    list_for_each(&terminal_list, node)
     {
-        struct terminal* terminal = NULL;
-        res = vector_at(terminal_vector, i, &terminal, sizeof(terminal));
-        if (res < 0)
-        {
-            goto out;
-        }
-
+        struct terminal* terminal = list_entry(node, struct terminal, list_node);
         if (terminal == ignore_terminal)
         {
             continue;
@@ -149,12 +225,54 @@ struct terminal* terminal_get_at_screen_position(size_t x, size_t y, struct term
         }
     }
 
-out:
-    if (res < 0)
+    return found_terminal;
+}
+
+static void terminal_mark_dirty(struct terminal* terminal, size_t row, size_t col_start, size_t col_end)
+{
+    struct terminal_dirty_span* span = &terminal->grid.dirty[row];
+    if (span->end == 0)
     {
-        found_terminal = NULL;
+        span->start = col_start;
+        span->end = col_end;
+        return;
+    }
+
+    if (col_start < span->start)
+    {
+        span->start = col_start;
+    }
+
+    if (col_end > span->end)
+    {
+        span->end = col_end;
+    }
+}
+
+/**
+ * Marks the cells covered by the terminal relative rectangle as unknown
+ * as something other than the terminal has drawn over them
+ */
+static void terminal_cells_invalidate(struct terminal* terminal, size_t x, size_t y, size_t width, size_t height)
+{
+    if (!terminal->grid.cells)
+    {
+        return;
+    }
+
+    size_t col_start = x / terminal->font->bits_width_per_character;
+    size_t row_start = y / terminal->font->bits_height_per_character;
+    size_t col_end = (x + width + terminal->font->bits_width_per_character - 1) / terminal->font->bits_width_per_character;
+    size_t row_end = (y + height + terminal->font->bits_height_per_character - 1) / terminal->font->bits_height_per_character;
+    col_end = MIN(col_end, terminal->grid.cols);
+    row_end = MIN(row_end, terminal->grid.rows);
+    for (size_t row = row_start; row < row_end; row++)
+    {
+        for (size_t col = col_start; col < col_end; col++)
+        {
+            terminal_cell(terminal, row, col)->c = TERMINAL_CELL_CHARACTER_UNKNOWN;
+        }
     }
-    return found_terminal;
 }
 
 void terminal_background_save(struct terminal* terminal)
@@ -180,16 +298,22 @@ void terminal_background_save(struct terminal* terminal)
 
     // We now have an exact copy of the graphics info pixels of the terminal
     // at the point the background save function was called.
+    // every cell now shows just the background
+    if (terminal->grid.cells)
+    {
+        memset(terminal->grid.cells, 0, sizeof(struct terminal_cell) * terminal->grid.rows * terminal->grid.cols);
+    }
 }
 
 static void terminal_handle_newline(struct terminal* terminal)
 {
     terminal->text.row++;
     size_t total_rows_per_term = terminal_total_rows(terminal);
-    // wrap vertically if we hit the bottom 
+    // scroll if we hit the bottom 
     if (terminal->text.row >= total_rows_per_term)
     {
-        terminal->text.row = 0;
+        terminal_scroll(terminal);
+        terminal->text.row = total_rows_per_term - 1;
     }
 
     // Reset the column 
@@ -209,8 +333,9 @@ static void terminal_update_position_after_draw(struct terminal* terminal)
 
     if (terminal->text.row >= total_rows_per_term)
     {
+        terminal_scroll(terminal);
         terminal->text.col = 0;
-        terminal->text.row = 0;
+        terminal->text.row = total_rows_per_term - 1;
     }
 }
 
@@ -268,34 +393,277 @@ static bool terminal_bounds_check(struct terminal* terminal, size_t abs_x, size_
     return (abs_x >= starting_x && abs_x <= ending_x && abs_y >= starting_y && abs_y <= ending_y);
 }
 
+/**
+ * Copies the saved background back into the graphics pixels a row at a time,
+ * sx and sy are relative to the terminal. Nothing is redrawn to the screen.
+ */
+static void terminal_background_copy(struct terminal* terminal, int sx, int sy, int width, int height)
+{
+    struct graphics_info* graphics_info = terminal->graphics_info;
+    if (!terminal->terminal_background || sx < 0 || sy < 0)
+    {
+        return;
+    }
+
+    if (sx + width > (int) terminal->bounds.width)
+    {
+        width = (int) terminal->bounds.width - sx;
+    }
+
+    if (sy + height > (int) terminal->bounds.height)
+    {
+        height = (int) terminal->bounds.height - sy;
+    }
+
+    size_t abs_x = terminal->bounds.abs_x + sx;
+    if (abs_x + width > graphics_info->width)
+    {
+        width = (int) graphics_info->width - (int) abs_x;
+    }
+
+    if (width <= 0)
+    {
+        return;
+    }
+
+    for(int y = 0; y < height; y++)
+    {
+        size_t abs_y = terminal->bounds.abs_y + sy + y;
+        if (abs_y >= graphics_info->height)
+        {
+            break;
+        }
+
+        struct framebuffer_pixel* src = &terminal->terminal_background[(sy + y) * terminal->bounds.width + sx];
+        struct framebuffer_pixel* dst = &graphics_info->pixels[abs_y * graphics_info->width + abs_x];
+        memcpy(dst, src, width * sizeof(struct framebuffer_pixel));
+    }
+}
+
 void terminal_restore_background(struct terminal* terminal, int sx, int sy, int width, int height)
 {
-    for(int x = 0; x < width; x++)
+    terminal_background_copy(terminal, sx, sy, width, height);
+    terminal_cells_invalidate(terminal, sx, sy, width, height);
+
+    size_t abs_x = terminal->bounds.abs_x + sx;
+    size_t abs_y = terminal->bounds.abs_y + sy;
+    graphics_redraw_graphics_to_screen(terminal->graphics_info, abs_x, abs_y, width,height);
+}
+
+/**
+ * Draws the cell into the graphics pixels, its background is restored first
+ * so whatever was drawn there before is replaced.
+ */
+static void terminal_cell_draw(struct terminal* terminal, size_t row, size_t col)
+{
+    struct terminal_cell* cell = terminal_view_cell(terminal, row, col);
+    size_t rel_x = col * terminal->font->bits_width_per_character;
+    size_t rel_y = row * terminal->font->bits_height_per_character;
+    terminal_background_copy(terminal, rel_x, rel_y, terminal->font->bits_width_per_character, terminal->font->bits_height_per_character);
+    if (cell->c > 0)
     {
-        for(int y = 0; y < height; y++)
+        font_blit(terminal->graphics_info, terminal->font, terminal->bounds.abs_x + rel_x, terminal->bounds.abs_y + rel_y, cell->c, cell->color);
+    }
+}
+
+static void terminal_cell_set(struct terminal* terminal, size_t row, size_t col, int c, struct framebuffer_pixel color)
+{
+    struct terminal_cell* cell = terminal_cell(terminal, row, col);
+    if (cell->c == c && memcmp(&cell->color, &color, sizeof(color)) == 0)
+    {
+        // Already drawn, nothing changed
+        return;
+    }
+
+    cell->c = c;
+    cell->color = color;
+    terminal_cell_draw(terminal, row, col);
+    terminal_mark_dirty(terminal, row, col, col + 1);
+}
+
+static void terminal_scrollback_push(struct terminal* terminal, struct terminal_cell* row_cells)
+{
+    if (!terminal->scrollback.rows)
+    {
+        // Only terminals that actually scroll pay for a scrollback
+        terminal->scrollback.rows = kzalloc(sizeof(struct terminal_cell) * TERMINAL_SCROLLBACK_ROWS * terminal->grid.cols);
+        if (!terminal->scrollback.rows)
         {
-            size_t abs_x = terminal->bounds.abs_x + sx + x;
-            size_t abs_y = terminal->bounds.abs_y + sy + y;
-            // did we overflow
-            if (abs_x > terminal->bounds.width || abs_y > terminal->bounds.height)
+            return;
+        }
+    }
+
+    struct terminal_cell* slot = &terminal->scrollback.rows[terminal->scrollback.next * terminal->grid.cols];
+    memcpy(slot, row_cells, sizeof(struct terminal_cell) * terminal->grid.cols);
+    terminal->scrollback.next = (terminal->scrollback.next + 1) % TERMINAL_SCROLLBACK_ROWS;
+    if (terminal->scrollback.total < TERMINAL_SCROLLBACK_ROWS)
+    {
+        terminal->scrollback.total++;
+    }
+}
+
+size_t terminal_scrollback_total_rows(struct terminal* terminal)
+{
+    return terminal->scrollback.total;
+}
+
+/**
+ * Returns grid.cols cells for the scrollback row, index zero
+ * is the row that most recently scrolled off the top
+ */
+struct terminal_cell* terminal_scrollback_row(struct terminal* terminal, size_t index)
+{
+    if (index >= terminal->scrollback.total)
+    {
+        return NULL;
+    }
+
+    size_t slot = (terminal->scrollback.next + TERMINAL_SCROLLBACK_ROWS - 1 - index) % TERMINAL_SCROLLBACK_ROWS;
+    return &terminal->scrollback.rows[slot * terminal->grid.cols];
+}
+
+int terminal_scrollback_view(struct terminal* terminal, size_t rows_back)
+{
+    if (!terminal->grid.cells)
+    {
+        return 0;
+    }
+
+    rows_back = MIN(rows_back, terminal->scrollback.total);
+    if (rows_back == terminal->scrollback.view)
+    {
+        return (int) rows_back;
+    }
+
+    // Every row shows something else now, it is all drawn again
+    terminal->scrollback.view = rows_back;
+    for (size_t row = 0; row < terminal->grid.rows; row++)
+    {
+        for (size_t col = 0; col < terminal->grid.cols; col++)
+        {
+            terminal_cell_draw(terminal, row, col);
+        }
+    }
+
+    terminal->grid.scrolled_rows = terminal->grid.rows;
+    terminal_flush(terminal);
+    return (int) rows_back;
+}
+
+/**
+ * Scrolls the terminal up a single row, the pixels of the remaining rows are moved
+ * rather than drawn again and only the new bottom row is painted. The rows still
+ * waiting to be flushed move up with their pixels.
+ */
+static void terminal_scroll(struct terminal* terminal)
+{
+    struct graphics_info* graphics_info = terminal->graphics_info;
+    size_t rows = terminal->grid.rows;
+    size_t cols = terminal->grid.cols;
+    if (!terminal->grid.cells || rows == 0)
+    {
+        return;
+    }
+
+    terminal_scrollback_push(terminal, terminal_cell(terminal, 0, 0));
+    memmove(terminal_cell(terminal, 0, 0), terminal_cell(terminal, 1, 0), sizeof(struct terminal_cell) * (rows - 1) * cols);
+    memset(terminal_cell(terminal, rows - 1, 0), 0, sizeof(struct terminal_cell) * cols);
+    memmove(&terminal->grid.dirty[0], &terminal->grid.dirty[1], sizeof(struct terminal_dirty_span) * (rows - 1));
+    terminal->grid.dirty[rows - 1].start = 0;
+    terminal->grid.dirty[rows - 1].end = cols;
+
+    size_t row_height = terminal->font->bits_height_per_character;
+    size_t abs_x = terminal->bounds.abs_x;
+    size_t width = MIN(terminal->bounds.width, graphics_info->width - abs_x);
+    size_t total_lines = (rows - 1) * row_height;
+    if (terminal->bounds.abs_y + rows * row_height > graphics_info->height)
+    {
+        // Rows that are not visible, just repaint them all
+        total_lines = 0;
+    }
+
+    if (abs_x == 0 && width == graphics_info->width)
+    {
+        // The terminal covers whole graphics rows so it is one contiguous move
+        struct framebuffer_pixel* dst = &graphics_info->pixels[terminal->bounds.abs_y * graphics_info->width];
+        memmove(dst, dst + row_height * graphics_info->width, total_lines * graphics_info->width * sizeof(struct framebuffer_pixel));
+    }
+    else
+    {
+        for (size_t y = 0; y < total_lines; y++)
+        {
+            struct framebuffer_pixel* dst = &graphics_info->pixels[(terminal->bounds.abs_y + y) * graphics_info->width + abs_x];
+            memmove(dst, dst + row_height * graphics_info->width, width * sizeof(struct framebuffer_pixel));
+        }
+    }
+
+    // The new line is empty, show the background
+    terminal_background_copy(terminal, 0, (rows - 1) * row_height, cols * terminal->font->bits_width_per_character, row_height);
+    if (total_lines == 0)
+    {
+        for (size_t row = 0; row < rows - 1; row++)
+        {
+            for (size_t col = 0; col < cols; col++)
             {
-                // We cant draw that just continue
-                continue;
+                terminal_cell_draw(terminal, row, col);
             }
+        }
+
+        terminal->grid.scrolled_rows = rows;
+        return;
+    }
 
-            struct framebuffer_pixel background_pixel = {0};
-            background_pixel = terminal->terminal_background[y * terminal->bounds.width + x];
-            graphics_draw_pixel(terminal->graphics_info, abs_x, abs_y, background_pixel);
+    terminal->grid.scrolled_rows++;
+}
+
+void terminal_flush(struct terminal* terminal)
+{
+    size_t cell_width = terminal->font->bits_width_per_character;
+    size_t cell_height = terminal->font->bits_height_per_character;
+    if (!terminal->grid.dirty)
+    {
+        return;
+    }
 
+    // The scroll and the rows it exposes are presented together
+    graphics_batch_begin();
+    size_t scrolled_rows = terminal->grid.scrolled_rows;
+    terminal->grid.scrolled_rows = 0;
+    if (scrolled_rows > 0)
+    {
+        size_t width = terminal->grid.cols * cell_width;
+        size_t height = terminal->grid.rows * cell_height;
+        if (scrolled_rows >= terminal->grid.rows ||
+            graphics_screen_scroll_up(terminal->graphics_info, terminal->bounds.abs_x, terminal->bounds.abs_y, width, height, scrolled_rows * cell_height) < 0)
+        {
+            // The screen pixels cannot be moved, the whole terminal is one damaged region
+            graphics_redraw_graphics_to_screen(terminal->graphics_info, terminal->bounds.abs_x, terminal->bounds.abs_y, width, height);
+            memset(terminal->grid.dirty, 0, sizeof(struct terminal_dirty_span) * terminal->grid.rows);
+            graphics_batch_end();
+            return;
         }
     }
 
-    size_t abs_x = terminal->bounds.abs_x + sx;
-    size_t abs_y = terminal->bounds.abs_y + sy;
-    graphics_redraw_graphics_to_screen(terminal->graphics_info, abs_x, abs_y, width,height);
+    // Scrolling marked the rows it exposed dirty, they are drawn with the changed cells
+    for (size_t row = 0; row < terminal->grid.rows; row++)
+    {
+        struct terminal_dirty_span* span = &terminal->grid.dirty[row];
+        if (span->end == 0)
+        {
+            continue;
+        }
+
+        size_t abs_x = terminal->bounds.abs_x + span->start * cell_width;
+        size_t abs_y = terminal->bounds.abs_y + row * cell_height;
+        graphics_redraw_graphics_to_screen(terminal->graphics_info, abs_x, abs_y, (span->end - span->start) * cell_width, cell_height);
+        span->start = 0;
+        span->end = 0;
+    }
+
+    graphics_batch_end();
 }
 
-int terminal_backspace(struct terminal* terminal)
+static int terminal_backspace_no_flush(struct terminal* terminal)
 {
     int res = 0; 
     if (!(terminal->flags & TERMINAL_FLAG_BACKSPACE_ALLOWED))
@@ -303,6 +671,9 @@ int terminal_backspace(struct terminal* terminal)
         return 0;
     }
 
+    // Edits are made to the live rows so they are shown again
+    terminal_scrollback_view(terminal, 0);
+
     int total_rows = terminal_total_rows(terminal);
     int total_cols = terminal_total_cols(terminal);
     int current_col = terminal_cursor_col(terminal);
@@ -335,15 +706,34 @@ int terminal_backspace(struct terminal* terminal)
 
     // Update the cursor
     terminal_cursor_set(terminal, current_row, current_col);
+    if (terminal->grid.cells)
+    {
+        terminal_cell_set(terminal, terminal->text.row, terminal->text.col, 0, terminal->font_color);
+    }
+    return res;
+}
 
-    size_t rel_x = terminal->text.col * terminal->font->bits_width_per_character;
-    size_t rel_y = terminal->text.row * terminal->font->bits_height_per_character;
-    terminal_restore_background(terminal, rel_x, rel_y, terminal->font->bits_width_per_character, terminal->font->bits_height_per_character);
+int terminal_backspace(struct terminal* terminal)
+{
+    int res = terminal_backspace_no_flush(terminal);
+    terminal_flush(terminal);
     return res;
 }
 
-int terminal_write(struct terminal* terminal, int c)
+/**
+ * Writes the character to the cell grid, the screen is only
+ * updated once terminal_flush is called
+ */
+static int terminal_write_no_flush(struct terminal* terminal, int c)
 {
+    if (!terminal->grid.cells)
+    {
+        return 0;
+    }
+
+    // Writing shows the live rows again
+    terminal_scrollback_view(terminal, 0);
+
     if (c == '\n')
     {
         terminal_handle_newline(terminal);
@@ -353,22 +743,25 @@ int terminal_write(struct terminal* terminal, int c)
     if (c == 0x08 && terminal->flags & TERMINAL_FLAG_BACKSPACE_ALLOWED)
     {
         // we can do a backspace lets do it
-        terminal_backspace(terminal);
+        terminal_backspace_no_flush(terminal);
         return 0;
     }
 
     // We have a normal character
-
-    // Calcualte the absolute positions for drawing
-    size_t abs_x = terminal_abs_x_for_next_character(terminal);
-    size_t abs_y = terminal_abs_y_for_next_character(terminal);
-    font_draw(terminal->graphics_info, terminal->font, abs_x, abs_y, c, terminal->font_color);
+    terminal_cell_set(terminal, terminal->text.row, terminal->text.col, c, terminal->font_color);
     // Update the terminal cursor position
     terminal_update_position_after_draw(terminal);
 
     return 0;
 }
 
+int terminal_write(struct terminal* terminal, int c)
+{
+    int res = terminal_write_no_flush(terminal, c);
+    terminal_flush(terminal);
+    return res;
+}
+
 int terminal_pixel_set(struct terminal* terminal, size_t x, size_t y, struct framebuffer_pixel pixel_color)
 {
     int res =0;
@@ -382,6 +775,7 @@ int terminal_pixel_set(struct terminal* terminal, size_t x, size_t y, struct fra
     }
 
     graphics_draw_pixel(terminal->graphics_info, abs_x, abs_y, pixel_color);
+    terminal_cells_invalidate(terminal, x, y, 1, 1);
 out:
     return res;
 }
@@ -418,6 +812,10 @@ int terminal_draw_image(struct terminal* terminal, uint32_t x, uint32_t y, struc
     }
 
     graphics_draw_image(terminal->graphics_info, img, abs_x, abs_y);
+    if (img)
+    {
+        terminal_cells_invalidate(terminal, x, y, img->width, img->height);
+    }
 out:
     return res;
 }
@@ -434,16 +832,41 @@ int terminal_draw_rect(struct terminal* terminal, uint32_t x, uint32_t y , size_
     }
 
     graphics_draw_rect(terminal->graphics_info, abs_x, abs_y, width, height, pixel_color);
+    terminal_cells_invalidate(terminal, x, y, width, height);
 out:
     return res;
 }
 
+int terminal_write_buffer_no_flush(struct terminal* terminal, const char* buffer, size_t len)
+{
+    int res = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        res = terminal_write_no_flush(terminal, buffer[i]);
+        if (res < 0)
+        {
+            break;
+        }
+    }
+
+    return res;
+}
+
+int terminal_write_buffer(struct terminal* terminal, const char* buffer, size_t len)
+{
+    int res = terminal_write_buffer_no_flush(terminal, buffer, len);
+
+    // The whole span is a single damage update
+    terminal_flush(terminal);
+    return res;
+}
+
 int terminal_print(struct terminal* terminal, const char* message)
 {
     int res = 0;
     while(*message != 0)
     {
-        res = terminal_write(terminal, *message);
+        res = terminal_write_no_flush(terminal, *message);
         if (res < 0)
         {
             break;
@@ -451,5 +874,7 @@ int terminal_print(struct terminal* terminal, const char* message)
         message++;
     }
 
+    // One redraw for everything the message changed
+    terminal_flush(terminal);
     return res;
-}
\ No newline at end of file
+}
@@ -30,14 +30,33 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 #include "graphics/font.h"
 #include "graphics/graphics.h"
+#include "lib/list/list.h"
 
 enum
 {
     TERMINAL_FLAG_BACKSPACE_ALLOWED = 0b00000001
 };
 
+// Cell contents are unknown because something else drew over it
+#define TERMINAL_CELL_CHARACTER_UNKNOWN -1
+
+struct terminal_cell
+{
+    // Zero when the cell only shows the background
+    int c;
+    struct framebuffer_pixel color;
+};
+
+struct terminal_dirty_span
+{
+    // Columns start to end (exclusive) changed since the last flush
+    size_t start;
+    size_t end;
+};
+
 struct terminal
 {
     // Graphics info that the terminal is binded to
@@ -63,9 +82,38 @@ struct terminal
         size_t height;
     } bounds;
 
+    struct
+    {
+        // rows*cols of the cells currently drawn to the graphics
+        struct terminal_cell* cells;
+        size_t rows;
+        size_t cols;
+
+        // One span per row, only these cells are redrawn on flush
+        struct terminal_dirty_span* dirty;
+
+        // Rows the pixels were scrolled up by since the last flush,
+        // rows or more means the whole terminal must be redrawn
+        size_t scrolled_rows;
+    } grid;
+
+    struct
+    {
+        // Ring of TERMINAL_SCROLLBACK_ROWS rows that scrolled off the top
+        struct terminal_cell* rows;
+        size_t total;
+        size_t next;
+
+        // Rows the view is scrolled back by, zero shows the live rows
+        size_t view;
+    } scrollback;
+
     struct font* font;
     struct framebuffer_pixel font_color;
     int flags;
+
+    // Node in the list of all terminals
+    struct list_node list_node;
 };
 
 void terminal_system_setup();
@@ -82,6 +130,12 @@ void terminal_transparency_key_remove(struct terminal* terminal);
 void terminal_transparency_key_set(struct terminal* terminal, struct framebuffer_pixel pixel_color);
 int terminal_pixel_set(struct terminal* terminal, size_t x, size_t y, struct framebuffer_pixel pixel_color);
 int terminal_write(struct terminal* terminal, int c);
+int terminal_write_buffer(struct terminal* terminal, const char* buffer, size_t len);
+
+/**
+ * Writes the buffer to the cell grid, nothing is shown until terminal_flush
+ */
+int terminal_write_buffer_no_flush(struct terminal* terminal, const char* buffer, size_t len);
 int terminal_backspace(struct terminal* terminal);
 void terminal_restore_background(struct terminal* terminal, int sx, int sy, int width, int height);
 int terminal_total_rows(struct terminal* terminal);
@@ -89,5 +143,15 @@ int terminal_total_cols(struct terminal* terminal);
 int terminal_cursor_col(struct terminal* terminal);
 int terminal_cursor_row(struct terminal* terminal);
 int terminal_cursor_set(struct terminal* terminal, int row, int col);
+void terminal_flush(struct terminal* terminal);
+size_t terminal_scrollback_total_rows(struct terminal* terminal);
+struct terminal_cell* terminal_scrollback_row(struct terminal* terminal, size_t index);
+
+/**
+ * Shows the terminal rows_back rows further back in its scrollback, zero shows
+ * the live rows again. Writing to the terminal also returns to the live rows
+ * \return Returns the rows the view was scrolled back by
+ */
+int terminal_scrollback_view(struct terminal* terminal, size_t rows_back);
 
 #endif
\ No newline at end of file
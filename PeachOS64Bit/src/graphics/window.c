@@ -28,10 +28,14 @@
 #include "graphics/window.h"
 #include "graphics/graphics.h"
 #include "lib/vector/vector.h"
+#include "lib/list/list.h"
+#include "lib/hashmap/hashmap.h"
 #include "memory/heap/kheap.h"
 #include "keyboard/keyboard.h"
 // include the mouse mouse.h
 #include "memory/memory.h"
+#include "lib/tilegrid/tilegrid.h"
+#include "graphics/cursor.h"
 #include "string/string.h"
 #include "graphics/font.h"
 #include "task/process.h"
@@ -39,8 +43,17 @@
 #include "status.h"
 #include "kernel.h"
 
-// vector of struct window*
-struct vector *windows_vector;
+// Every window, ordered from the top most window down
+struct list windows_list;
+
+// Maps the root graphics of a window to the window
+struct hashmap *windows_by_root_graphics = NULL;
+
+// Screen tiles holding the windows over them, used for hit testing
+struct tilegrid *windows_spatial_index = NULL;
+
+// Increments every time a window changes z index, newer windows are on top of equal z indexes
+uint32_t window_z_sequence = 0;
 
 // close icon image
 struct image *close_icon = NULL;
@@ -52,8 +65,6 @@ struct window *window_moving = NULL;
 struct window *focused_window = NULL;
 
 int window_autoincrement_id_current = 100000;
-size_t window_get_largest_zindex();
-int window_recalculate_zindexes();
 
 void window_keyboard_event_listener_on_event(struct keyboard* keyboard, struct keyboard_event* event);
 struct keyboard_listener window_keyboard_listener = {
@@ -63,8 +74,17 @@ int window_system_initialize()
 {
     int res = 0;
 
-    windows_vector = vector_new(sizeof(struct window *), 10, 0);
-    if (!windows_vector)
+    list_init(&windows_list);
+    windows_by_root_graphics = hashmap_new(16);
+    if (!windows_by_root_graphics)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
+    struct graphics_info *screen = graphics_screen_info();
+    windows_spatial_index = tilegrid_new(screen->width, screen->height, WINDOW_SPATIAL_TILE_SIZE);
+    if (!windows_spatial_index)
     {
         res = -ENOMEM;
         goto out;
@@ -108,49 +128,27 @@ void window_screen_mouse_move_handler(struct mouse *mouse, int moved_to_x, int m
 
 struct window *window_get_from_graphics(struct graphics_info *graphics)
 {
-    struct window *window = NULL;
-    size_t total_windows = vector_count(windows_vector);
-    for (size_t i = 0; i < total_windows; i++)
+    // The window is found at the root of the graphics or one of its ancestors
+    for (struct graphics_info *current = graphics; current; current = current->parent)
     {
-        struct window *win = NULL;
-        vector_at(windows_vector, i, &win, sizeof(win));
-        if (win && window_owns_graphics(win, graphics))
+        struct window *window = hashmap_get(windows_by_root_graphics, (uint64_t)current);
+        if (window)
         {
-            window = win;
-            break;
+            return window;
         }
     }
 
-    return window;
+    return NULL;
 }
 
 struct window *window_get_at_position(size_t abs_x, size_t abs_y, struct window *ignore_window)
 {
-    size_t total_windows = vector_count(windows_vector);
-    for (size_t i = 0; i < total_windows; i++)
-    {
-        struct window *win = NULL;
-        vector_at(windows_vector, i, &win, sizeof(win));
-
-        if (win && win != ignore_window)
-        {
-            size_t whole_win_width = win->root_graphics->width;
-            size_t whole_win_height = win->root_graphics->height;
-            size_t end_abs_x = win->root_graphics->starting_x + whole_win_width;
-            size_t end_abs_y = win->root_graphics->starting_y + whole_win_height;
-            if (abs_x >= win->x && abs_x < end_abs_x && abs_y >= win->y && abs_y < end_abs_y)
-            {
-                // This was the window that was clicked
-                return win;
-            }
-        }
-    }
-
-    return NULL;
+    return tilegrid_get_at(windows_spatial_index, abs_x, abs_y, ignore_window);
 }
+
 void window_click_handler(struct mouse *mouse, int abs_x, int abs_y, MOUSE_CLICK_TYPE type)
 {
-    struct window *win = window_get_at_position(abs_x, abs_y, mouse->graphic.window);
+    struct window *win = window_get_at_position(abs_x, abs_y, NULL);
     if (win)
     {
         int rel_x = abs_x - win->root_graphics->starting_x;
@@ -187,6 +185,9 @@ void window_draw_title_bar(struct window *window, struct framebuffer_pixel title
     // draww the background of the title bar
     terminal_draw_rect(window->title_bar_terminal, 0, 0, total_window_width_bounds, WINDOW_TITLE_BAR_HEIGHT, title_bar_bg_color);
 
+    // Title characters are drawn over the background we just drew
+    terminal_background_save(window->title_bar_terminal);
+
     // Draw the title text
     terminal_cursor_set(window->title_bar_terminal, 0, 0);
     terminal_print(window->title_bar_terminal, title);
@@ -201,20 +202,40 @@ void window_draw_title_bar(struct window *window, struct framebuffer_pixel title
     terminal_ignore_color_finish(window->title_bar_terminal);
 }
 
-int window_reorder(void *first_elem, void *second_elem)
+/**
+ * Updates the windows rectangle and z order in the spatial index, called
+ * whenever the window moves or changes z index
+ */
+static void window_spatial_index_update(struct window *window)
 {
-    struct window *win1 = *(struct window **)(first_elem);
-    struct window *win2 = *(struct window **)(second_elem);
-
-    return (win1->zindex < win2->zindex);
+    uint64_t order = ((uint64_t)window->zindex << 32) | window->z_sequence;
+    tilegrid_set(windows_spatial_index, window,
+                 window->root_graphics->starting_x, window->root_graphics->starting_y,
+                 window->root_graphics->width, window->root_graphics->height,
+                 order);
 }
 
 void window_set_z_index(struct window *window, int zindex)
 {
     graphics_set_z_index(window->root_graphics, zindex);
+    window->zindex = zindex;
+    window->z_sequence = ++window_z_sequence;
+    window_spatial_index_update(window);
+
+    // Move the window to its place in the list now that zindex changed
+    list_remove(&windows_list, &window->list_node);
+    struct list_node *node = NULL;
+    list_for_each(&windows_list, node)
+    {
+        struct window *win = list_entry(node, struct window, list_node);
+        if (win->zindex <= window->zindex)
+        {
+            list_insert_before(&windows_list, node, &window->list_node);
+            return;
+        }
+    }
 
-    // We need to reorder the windows vector now that zindex changed
-    vector_reorder(windows_vector, window_reorder);
+    list_push_back(&windows_list, &window->list_node);
 }
 
 void window_unfocus(struct window *old_focused_window)
@@ -264,6 +285,7 @@ void window_focus(struct window *window)
 
     struct window *old_focused_window = focused_window;
     focused_window = window;
+    graphics_batch_begin();
     struct framebuffer_pixel red = {0};
     red.red = 0xff;
     red.green = 0x00;
@@ -285,6 +307,7 @@ void window_focus(struct window *window)
 
     // Force a full redraw of the window
     graphics_redraw_graphics_to_screen(window->root_graphics, 0, 0, window->root_graphics->width, window->root_graphics->height);
+    graphics_batch_end();
 
     struct window_event event = {0};
     event.type = WINDOW_EVENT_TYPE_FOCUS;
@@ -320,8 +343,10 @@ void window_free(struct window *window)
     // free the event handlers vector
     vector_free(window->event_handlers.handlers);
 
-    // Pop the window pointer from the vector
-    vector_pop_element(windows_vector, &window, sizeof(window));
+    // Unregister the window
+    list_remove(&windows_list, &window->list_node);
+    hashmap_remove(windows_by_root_graphics, (uint64_t)window->root_graphics);
+    tilegrid_remove(windows_spatial_index, window);
     terminal_free(window->terminal);
 
     // free the title terminal
@@ -375,6 +400,39 @@ int window_event_handler(struct window *window, struct window_event *win_event)
     return 0;
 }
 
+/**
+ * A window can be moved by copying its pixels on the screen when no other window
+ * overlaps it at the old or new position, the screen at the old position then
+ * only holds pixels of the window
+ */
+static bool window_can_block_move(struct window *window, struct graphics_rect *old_rect, struct graphics_rect *new_rect)
+{
+    if ((window->flags & WINDOW_FLAG_BACKGROUND_TRANSPARENT) || !graphics_is_opaque(window->root_graphics))
+    {
+        return false;
+    }
+
+    struct list_node *node = NULL;
+    list_for_each(&windows_list, node)
+    {
+        struct window *other = list_entry(node, struct window, list_node);
+        if (other == window)
+        {
+            continue;
+        }
+
+        struct graphics_rect other_rect = {other->root_graphics->starting_x, other->root_graphics->starting_y, other->root_graphics->width, other->root_graphics->height};
+        struct graphics_rect overlap;
+        if (graphics_rect_intersect(&other_rect, old_rect, &overlap) ||
+            graphics_rect_intersect(&other_rect, new_rect, &overlap))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 int window_position_set(struct window *window, size_t new_x, size_t new_y)
 {
     int res = 0;
@@ -402,20 +460,35 @@ int window_position_set(struct window *window, size_t new_x, size_t new_y)
         new_y = screen->height - window->height - 1;
     }
 
+    // The exposed areas and the window at its new position are presented together
+    graphics_batch_begin();
+
     int old_screen_x = window->root_graphics->starting_x;
     int old_screen_y = window->root_graphics->starting_y;
+    struct graphics_rect old_rect = {old_screen_x, old_screen_y, window->root_graphics->width, window->root_graphics->height};
+    struct graphics_rect new_rect = {new_x, new_y, window->root_graphics->width, window->root_graphics->height};
+    bool block_move = window_can_block_move(window, &old_rect, &new_rect);
 
-    window->root_graphics->relative_x = new_x;
-    window->root_graphics->relative_y = new_y;
-    window->root_graphics->starting_x = new_x;
-    window->root_graphics->starting_y = new_y;
+    // The positions of the children are brought up to date when they are next used
+    graphics_position_set(window->root_graphics, new_x, new_y);
 
     window->x = new_x;
     window->y = new_y;
 
+    // Also moves the window in the spatial index
     window_bring_to_top(window);
 
-    graphics_info_recalculate(window->root_graphics);
+    if (block_move)
+    {
+        // Lift the cursor so it is not copied along with the window
+        uint32_t left = MIN(old_rect.x, new_rect.x);
+        uint32_t top = MIN(old_rect.y, new_rect.y);
+        uint32_t right = MAX(old_rect.x, new_rect.x) + old_rect.width;
+        uint32_t bottom = MAX(old_rect.y, new_rect.y) + old_rect.height;
+        cursor_compose_begin(left, top, right - left, bottom - top);
+        block_move = graphics_screen_move_pixels(old_rect.x, old_rect.y, old_rect.width, old_rect.height, new_rect.x, new_rect.y) >= 0;
+        cursor_compose_end();
+    }
 
     int x_gap = old_screen_x - (int)window->root_graphics->starting_x;
     int y_gap = old_screen_y - (int)window->root_graphics->starting_y;
@@ -457,7 +530,12 @@ int window_position_set(struct window *window, size_t new_x, size_t new_y)
         graphics_redraw_region(graphics_screen_info(), y_redraw_x, y_redraw_y, y_redraw_width, y_redraw_height);
     }
 
-    window_redraw(window);
+    // The window pixels are already in place after a block move
+    if (!block_move)
+    {
+        window_redraw(window);
+    }
+    graphics_batch_end();
 out:
     return res;
 }
@@ -472,6 +550,21 @@ void window_redraw_body_region(struct window *window, int x, int y, int width, i
     graphics_redraw_region(window->graphics, x, y, width, height);
 }
 
+void window_redraw_body_regions(struct window *window, struct window_rect *rects, size_t total)
+{
+    graphics_batch_begin();
+    for (size_t i = 0; i < total; i++)
+    {
+        if (rects[i].x < 0 || rects[i].y < 0 || rects[i].width <= 0 || rects[i].height <= 0)
+        {
+            continue;
+        }
+
+        graphics_redraw_region(window->graphics, rects[i].x, rects[i].y, rects[i].width, rects[i].height);
+    }
+    graphics_batch_end();
+}
+
 void window_redraw_region(struct window *window, int x, int y, int width, int height)
 {
     graphics_redraw_region(window->root_graphics, x, y, width, height);
@@ -487,42 +580,6 @@ void window_title_set(struct window *window, const char *title)
     window_redraw(window);
 }
 
-size_t window_get_largest_zindex()
-{
-    size_t z_index = 0;
-    size_t total_windows = vector_count(windows_vector);
-    if (total_windows > 0)
-    {
-        struct window *win = NULL;
-        vector_at(windows_vector, 0, &win, sizeof(win));
-        if (win)
-        {
-            z_index = win->zindex;
-        }
-    }
-
-    return z_index;
-}
-
-int window_recalculate_zindexes()
-{
-    size_t total_windows = vector_count(windows_vector);
-    size_t last_zindex = 0;
-    for (size_t i = 0; i < total_windows; i++)
-    {
-        struct window *child_window = NULL;
-        vector_at(windows_vector, i, &child_window, sizeof(child_window));
-        if (child_window)
-        {
-            size_t z_index = vector_count(child_window->root_graphics->children) + i + 1;
-            graphics_set_z_index(child_window->root_graphics, z_index);
-            last_zindex = z_index;
-        }
-    }
-
-    return last_zindex;
-}
-
 struct window *window_focused()
 {
     return focused_window;
@@ -580,7 +637,7 @@ void window_title_bar_clicked(struct graphics_info *title_graphics, size_t rel_x
 struct window *window_create(struct graphics_info *graphics_info, struct font *font, const char *title, size_t x, size_t y, size_t width, size_t height, int flags, int id)
 {
     int res = 0;
-    if (!windows_vector)
+    if (!windows_by_root_graphics)
     {
         panic("Window system was not initialized\n");
     }
@@ -768,8 +825,13 @@ struct window *window_create(struct graphics_info *graphics_info, struct font *f
         graphics_draw_rect(border_bottom_graphics_info, 0, 0, border_bottom_graphics_info->width, border_bottom_graphics_info->height, border_color);
     }
 
-    // Push to the windows vector
-    vector_push(windows_vector, &window);
+    // Register the window
+    res = hashmap_set(windows_by_root_graphics, (uint64_t)window->root_graphics, window);
+    if (res < 0)
+    {
+        goto out;
+    }
+    list_push_front(&windows_list, &window->list_node);
 
     size_t child_count = vector_count(window->root_graphics->children);
     window_set_z_index(window, child_count + 1);
@@ -798,7 +860,9 @@ out:
                 window->title_bar_terminal = NULL;
             }
 
-            vector_pop_element(windows_vector, &window, sizeof(struct window *));
+            list_remove(&windows_list, &window->list_node);
+            hashmap_remove(windows_by_root_graphics, (uint64_t)window->root_graphics);
+            tilegrid_remove(windows_spatial_index, window);
             kfree(window);
             window = NULL;
         }
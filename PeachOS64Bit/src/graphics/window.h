@@ -30,6 +30,7 @@
 #include "graphics/terminal.h"
 #include "graphics/graphics.h"
 #include "config.h"
+#include "lib/list/list.h"
 #include <stddef.h>
 #include <stdint.h>
 
@@ -106,6 +107,15 @@ struct window_event_userland
     
 };
 
+// Rectangle relative to the window body, shared with userland
+struct window_rect
+{
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
 typedef int (*WINDOW_EVENT_HANDLER)(struct window* window, struct window_event* event);
 
 enum
@@ -154,10 +164,16 @@ struct window
     // Determines which window is drawn first 
     size_t zindex;
 
+    // Orders windows of equal zindex, the latest to change z index is on top
+    uint32_t z_sequence;
+
     // Window title
     char title[WINDOW_MAX_TITLE];
     int flags;
-    
+
+    // Node in the list of all windows, ordered from the top most window down
+    struct list_node list_node;
+
 };
 
 int window_system_initialize();
@@ -175,8 +191,19 @@ void window_click(struct window* window, int rel_x, int rel_y, MOUSE_CLICK_TYPE
 bool window_owns_graphics(struct window* win, struct graphics_info* graphics);
 struct window* window_focused();
 struct window* window_get_from_graphics(struct graphics_info* graphics);
+
+/**
+ * Returns the top most window holding the absolute screen position or NULL
+ * \param ignore_window Window that is skipped, can be NULL
+ */
+struct window* window_get_at_position(size_t abs_x, size_t abs_y, struct window* ignore_window);
 void window_redraw_region(struct window* window, int x, int y, int width, int height);
 void window_redraw_body_region(struct window* window, int x, int y, int width, int height);
+
+/**
+ * Redraws every rectangle of the window body and presents them to the screen together
+ */
+void window_redraw_body_regions(struct window* window, struct window_rect* rects, size_t total);
 void window_title_set(struct window* window, const char* title);
 void window_event_push(struct window *window, struct window_event *event);
 void window_close(struct window *window);
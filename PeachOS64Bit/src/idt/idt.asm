@@ -30,6 +30,7 @@ extern int21h_handler
 extern no_interrupt_handler
 extern isr80h_handler
 extern interrupt_handler
+extern idt_page_fault_handler
 
 global idt_load
 global no_interrupt
@@ -37,6 +38,7 @@ global enable_interrupts
 global disable_interrupts
 global isr80h_wrapper
 global interrupt_pointer_table
+global idt_page_fault_wrapper
 
 temp_rsp_storage: dq 0x00
 %macro pushad_macro 0
@@ -135,9 +137,26 @@ isr80h_wrapper:
     mov rax, [tmp_res]
     iretq
 
+; The page fault exception pushes an error code, the generic
+; interrupt stubs cannot be used as the frame would be off by one.
+idt_page_fault_wrapper:
+    ; Take the error code off so the stack matches struct interrupt_frame
+    pop qword [page_fault_error_code]
+    pushad_macro
+
+    ; Second argument is the interrupt frame
+    mov rsi, rsp
+    ; First argument is the error code
+    mov rdi, [page_fault_error_code]
+    call idt_page_fault_handler
+    popad_macro
+    iretq
+
 section .data
 ; Inside here is stored the return result from isr80h_handler
 tmp_res: dq 0
+; Error code pushed by the processor for the last page fault
+page_fault_error_code: dq 0
 
 
 %macro interrupt_array_entry 1
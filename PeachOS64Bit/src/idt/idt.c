@@ -33,7 +33,9 @@
 #include "task/process.h"
 #include "memory/heap/kheap.h"
 #include "io/io.h"
+#include "memory/paging/paging.h"
 #include "status.h"
+#include <stdbool.h>
 struct idt_desc idt_descriptors[PEACHOS_TOTAL_INTERRUPTS];
 struct idtr_desc idtr_descriptor;
 
@@ -47,6 +49,7 @@ extern void idt_load(struct idtr_desc* ptr);
 extern void int21h();
 extern void no_interrupt();
 extern void isr80h_wrapper();
+extern void idt_page_fault_wrapper();
 
 void no_interrupt_handler()
 {
@@ -107,6 +110,56 @@ void idt_handle_exception()
     // task_next();
 }
 
+void idt_page_fault_handler(uint64_t error_code, struct interrupt_frame* frame)
+{
+    void* fault_address = paging_fault_address();
+    // The kernel may fault on user pages while it is on the task page tables
+    struct paging_desc* faulting_desc = paging_current_descriptor();
+    bool from_user = (frame->cs & 0x03) == 0x03;
+    kernel_page();
+
+    struct task* task = task_current();
+    if (!task)
+    {
+        panic("Page fault with no current task\n");
+    }
+
+    if (from_user)
+    {
+        task_current_save_state(frame);
+    }
+
+    int res = -EINVARG;
+    bool on_task_pages = from_user || faulting_desc == task->process->paging_desc;
+    if (on_task_pages)
+    {
+        // May be an elf page that was never loaded or a write to a shared page
+        res = process_page_in(task->process, fault_address, error_code & IDT_PAGE_FAULT_ERROR_WRITE);
+    }
+
+    if (res < 0)
+    {
+        if (!from_user)
+        {
+            panic("Kernel page fault\n");
+        }
+
+        // Invalid access, the process is terminated
+        process_terminate(task->process);
+        task_next();
+        return;
+    }
+
+    if (from_user)
+    {
+        task_page();
+    }
+    else
+    {
+        paging_switch(faulting_desc);
+    }
+}
+
 void idt_clock()
 {
     outb(0x20, 0x20);
@@ -133,6 +186,7 @@ void idt_init()
 
     idt_set(0, idt_zero);
     idt_set(0x80, isr80h_wrapper);
+    idt_set(IDT_PAGE_FAULT_INTERRUPT, idt_page_fault_wrapper);
 
 
     for (int i = 0; i < 0x20; i++)
@@ -30,6 +30,16 @@
 
 #include <stdint.h>
 
+#define IDT_PAGE_FAULT_INTERRUPT 0x0E
+
+enum
+{
+    // Set when the fault was a protection violation on a present page
+    IDT_PAGE_FAULT_ERROR_PRESENT = 0b00000001,
+    IDT_PAGE_FAULT_ERROR_WRITE = 0b00000010,
+    IDT_PAGE_FAULT_ERROR_USER = 0b00000100
+};
+
 struct interrupt_frame;
 typedef void*(*ISR80H_COMMAND)(struct interrupt_frame* frame);
 typedef void(*INTERRUPT_CALLBACK_FUNCTION)(struct interrupt_frame* frame);
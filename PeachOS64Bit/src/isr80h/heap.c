@@ -51,4 +51,18 @@ void* isr80h_command5_free(struct interrupt_frame* frame)
     void* ptr_to_free = task_get_stack_item(task_current(), 0);
     process_free(task_current()->process, ptr_to_free);
     return 0;
-}
\ No newline at end of file
+}
+
+void* isr80h_command27_heap_stats(struct interrupt_frame* frame)
+{
+    struct kheap_stats* virt_stats_addr = task_get_stack_item(task_current(), 0);
+    return (void*)(int64_t) process_kheap_stats(task_current()->process, virt_stats_addr);
+}
+
+void* isr80h_command28_heap_trace(struct interrupt_frame* frame)
+{
+    struct kheap_trace_entry* virt_entries_addr = task_get_stack_item(task_current(), 0);
+    size_t max_entries = (size_t) task_get_stack_item(task_current(), 1);
+    long flags = (long) task_get_stack_item(task_current(), 2);
+    return (void*)(int64_t) process_kheap_trace(task_current()->process, virt_entries_addr, max_entries, flags);
+}
@@ -33,5 +33,7 @@ struct interrupt_frame;
 void* isr80h_command15_realloc(struct interrupt_frame* frame);
 void* isr80h_command4_malloc(struct interrupt_frame* frame);
 void* isr80h_command5_free(struct interrupt_frame* frame);
+void* isr80h_command27_heap_stats(struct interrupt_frame* frame);
+void* isr80h_command28_heap_trace(struct interrupt_frame* frame);
 
 #endif
\ No newline at end of file
@@ -47,6 +47,19 @@ void* isr80h_command2_getkey(struct interrupt_frame* frame)
     return (void*)((uintptr_t)c);
 }
 
+void* isr80h_command26_write(struct interrupt_frame* frame)
+{
+    void* user_space_buffer = task_get_stack_item(task_current(), 0);
+    size_t len = (size_t) task_get_stack_item(task_current(), 1);
+    return (void*)(int64_t) process_write(task_current()->process, user_space_buffer, len);
+}
+
+void* isr80h_command31_terminal_scrollback(struct interrupt_frame* frame)
+{
+    size_t rows_back = (size_t) task_get_stack_item(task_current(), 0);
+    return (void*)(int64_t) process_terminal_scrollback(task_current()->process, rows_back);
+}
+
 void* isr80h_command3_putchar(struct interrupt_frame* frame)
 {
     char c = (char)(uintptr_t) task_get_stack_item(task_current(), 0);
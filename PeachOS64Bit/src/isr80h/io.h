@@ -32,4 +32,6 @@ struct interrupt_frame;
 void* isr80h_command1_print(struct interrupt_frame* frame);
 void* isr80h_command2_getkey(struct interrupt_frame* frame);
 void* isr80h_command3_putchar(struct interrupt_frame* frame);
+void* isr80h_command26_write(struct interrupt_frame* frame);
+void* isr80h_command31_terminal_scrollback(struct interrupt_frame* frame);
 #endif
\ No newline at end of file
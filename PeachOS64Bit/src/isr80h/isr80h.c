@@ -63,4 +63,10 @@ void isr80h_register_commands()
     isr80h_register_command(SYSTEM_COMMAND23_WINDOW_REDRAW_REGION, isr80h_command23_window_redraw_region);
     isr80h_register_command(SYSTEM_COMMAND24_UPDATE_WINDOW, isr80h_command24_update_window);
     isr80h_register_command(SYSTEM_COMMAND25_UDELAY, isr80h_command25_udelay);
+    isr80h_register_command(SYSTEM_COMMAND26_WRITE, isr80h_command26_write);
+    isr80h_register_command(SYSTEM_COMMAND27_HEAP_STATS, isr80h_command27_heap_stats);
+    isr80h_register_command(SYSTEM_COMMAND28_HEAP_TRACE, isr80h_command28_heap_trace);
+    isr80h_register_command(SYSTEM_COMMAND29_WINDOW_REDRAW_REGIONS, isr80h_command29_window_redraw_regions);
+    isr80h_register_command(SYSTEM_COMMAND30_BOOT_TRACE, isr80h_command30_boot_trace);
+    isr80h_register_command(SYSTEM_COMMAND31_TERMINAL_SCROLLBACK, isr80h_command31_terminal_scrollback);
 }
\ No newline at end of file
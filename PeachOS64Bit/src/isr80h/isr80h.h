@@ -55,7 +55,13 @@ enum SystemCommands
     SYSTEM_COMMAND22_GRAPHICS_CREATE,
     SYSTEM_COMMAND23_WINDOW_REDRAW_REGION,
     SYSTEM_COMMAND24_UPDATE_WINDOW,
-    SYSTEM_COMMAND25_UDELAY
+    SYSTEM_COMMAND25_UDELAY,
+    SYSTEM_COMMAND26_WRITE,
+    SYSTEM_COMMAND27_HEAP_STATS,
+    SYSTEM_COMMAND28_HEAP_TRACE,
+    SYSTEM_COMMAND29_WINDOW_REDRAW_REGIONS,
+    SYSTEM_COMMAND30_BOOT_TRACE,
+    SYSTEM_COMMAND31_TERMINAL_SCROLLBACK
 };
 
 void isr80h_register_commands();
@@ -99,7 +99,7 @@ void* isr80h_command7_invoke_system_command(struct interrupt_frame* frame)
 void* isr80h_command8_get_program_arguments(struct interrupt_frame* frame)
 {
     struct process* process = task_current()->process;
-    struct process_arguments* arguments = task_virtual_address_to_physical(task_current(), task_get_stack_item(task_current(), 0));
+    struct process_arguments* arguments = task_virtual_address_to_physical_for_write(task_current(), task_get_stack_item(task_current(), 0));
 
     process_get_arguments(process, &arguments->argc, &arguments->argv);
     return 0;
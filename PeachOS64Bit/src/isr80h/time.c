@@ -29,6 +29,7 @@
 #include "task/task.h"
 #include "task/process.h"
 #include "io/tsc.h"
+#include "boot/boottrace.h"
 
 void* isr80h_command25_udelay(struct interrupt_frame* frame)
 {
@@ -39,4 +40,11 @@ void* isr80h_command25_udelay(struct interrupt_frame* frame)
 
     // this line will never run.
     return NULL;
+}
+
+void* isr80h_command30_boot_trace(struct interrupt_frame* frame)
+{
+    struct boot_trace_phase* virt_phases_addr = task_get_stack_item(task_current(), 0);
+    size_t max_phases = (size_t) task_get_stack_item(task_current(), 1);
+    return (void*)(int64_t) process_boot_trace(task_current()->process, virt_phases_addr, max_phases);
 }
\ No newline at end of file
@@ -30,4 +30,5 @@
 
 struct interrupt_frame;
 void* isr80h_command25_udelay(struct interrupt_frame* frame);
+void* isr80h_command30_boot_trace(struct interrupt_frame* frame);
 #endif
\ No newline at end of file
@@ -120,7 +120,7 @@ void* isr80h_command18_get_window_event(struct interrupt_frame* frame)
         goto out;
     }
 
-    win_event_out = task_virtual_address_to_physical(task_current(), win_event_out_virtual_address);
+    win_event_out = task_virtual_address_to_physical_for_write(task_current(), win_event_out_virtual_address);
     if (!win_event_out)
     {
         res = -EINVARG;
@@ -205,6 +205,25 @@ void* isr80h_command23_window_redraw_region(struct interrupt_frame* frame)
     return NULL;
 }
 
+void* isr80h_command29_window_redraw_regions(struct interrupt_frame* frame)
+{
+    struct window_rect* virt_rects = task_get_stack_item(task_current(), 0);
+    size_t total_rects = (size_t) task_get_stack_item(task_current(), 1);
+    void* user_window_ptr = task_get_stack_item(task_current(), 2);
+    if (!user_window_ptr)
+    {
+        return ERROR(-EINVARG);
+    }
+
+    struct window* kern_window = isr80h_window_from_process_window_virt(user_window_ptr);
+    if (!kern_window)
+    {
+        return ERROR(-EINVARG);
+    }
+
+    return (void*)(int64_t) process_window_redraw_regions(task_current()->process, kern_window, virt_rects, total_rects);
+}
+
 void* isr80h_command24_update_window_title(struct window* window, struct interrupt_frame* frame)
 {
     int res = 0;
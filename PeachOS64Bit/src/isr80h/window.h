@@ -40,4 +40,5 @@ void* isr80h_command19_window_graphics_get(struct interrupt_frame* frame);
 void* isr80h_command21_window_redraw(struct interrupt_frame* frame);
 void* isr80h_command23_window_redraw_region(struct interrupt_frame* frame);
 void* isr80h_command24_update_window(struct interrupt_frame* frame);
+void* isr80h_command29_window_redraw_regions(struct interrupt_frame* frame);
 #endif
\ No newline at end of file
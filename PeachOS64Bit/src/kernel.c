@@ -38,6 +38,7 @@
 #include "string/string.h"
 #include "isr80h/isr80h.h"
 #include "io/tsc.h"
+#include "boot/boottrace.h"
 #include "io/pci.h"
 #include "task/task.h"
 #include "task/process.h"
@@ -133,6 +134,7 @@ void kernel_main()
     print(itoa(e820_total_accessible_memory()));
     print("\n");
 
+    boot_trace_begin("kheap_init");
     kheap_init();
 
     char *data = kmalloc(50);
@@ -141,6 +143,7 @@ void kernel_main()
     data[2] = 'C';
     data[3] = 0x00;
     print(data);
+    boot_trace_begin("paging");
     kernel_paging_desc = paging_desc_new(PAGING_MAP_LEVEL_4);
     if (!kernel_paging_desc)
     {
@@ -150,48 +153,76 @@ void kernel_main()
 
     paging_switch(kernel_paging_desc);
 
+    // Program the memory types so the framebuffer can be write combined
+    paging_pat_init();
+
+    // Global kernel pages and per address space TLB tags
+    paging_tlb_init();
+
+    // Copy on write pages are read only, the kernel must not write through them either
+    paging_write_protect_init();
+
     // The multi-heap is ready
     kheap_post_paging();
 
+#if PEACHOS_KHEAP_SELF_CHECK
+    if (kheap_paging_realloc_check() < 0)
+    {
+        panic("The paging heap failed its realloc check\n");
+    }
+#endif
+
     // Setup the graphics
+    boot_trace_begin("graphics_setup");
     graphics_setup(&default_graphics_info);
 
     screen_info = graphics_screen_info();
 
     // Enable interrupt descriptor table
+    boot_trace_begin("idt_init");
     idt_init();
 
     // Enable PCI and scan for devices
+    boot_trace_begin("pci_init");
     pci_init();
 
     // Enable fs functionality
+    boot_trace_begin("fs_init");
     fs_init();
 
     // Enable the disks
+    boot_trace_begin("disk_search_and_init");
     disk_search_and_init();
 
     // Initialize GPT(gloabl partition table) drives
+    boot_trace_begin("gpt_init");
     gpt_init();
 
     // Initialize the font system
+    boot_trace_begin("font_system_init");
     font_system_init();
 
     // Setup the terminal system
+    boot_trace_begin("terminal_system_setup");
     terminal_system_setup();
 
     // Initialize mouse system
+    boot_trace_begin("mouse_and_keyboard");
     mouse_system_init();
 
     // Initialize the keyboard
     keyboard_init();
 
     // Initialize window system
+    boot_trace_begin("window_system_initialize");
     window_system_initialize();
 
     // Load the static mouse drivers.
+    boot_trace_begin("mouse_drivers");
     mouse_system_load_static_drivers();
 
     // initialize stage two graphics setup
+    boot_trace_begin("graphics_stage_two");
     graphics_setup_stage_two(&default_graphics_info);
 
     // in no particular order.
@@ -200,6 +231,7 @@ void kernel_main()
     // initialize keyboard system
 
     // Initialize window system stage two
+    boot_trace_begin("window_system_stage2");
     window_system_initialize_stage2();
 
     struct font* font = font_get_system_font();
@@ -211,6 +243,7 @@ void kernel_main()
     struct framebuffer_pixel font_color = {0};
     font_color.red = 0xff;
 
+    boot_trace_begin("system_terminal_and_tss");
     system_terminal = terminal_create(screen_info, 0, 0, screen_info->width, screen_info->height, font, font_color, TERMINAL_FLAG_BACKSPACE_ALLOWED);
     if (!system_terminal)
     {
@@ -236,7 +269,11 @@ void kernel_main()
     tss_load(KERNEL_LONG_MODE_TSS_SELECTOR);
 
     // Initialize the process system
-    process_system_init();
+    boot_trace_begin("process_system_init");
+    if (process_system_init() < 0)
+    {
+        panic("Failed to initialize the process system\n");
+    }
 
     print("tss load was fine\n");
     // Register isr80h commands
@@ -259,11 +296,16 @@ void kernel_main()
    
     print("Loading program...\n");
     struct process* process = 0;
+    boot_trace_begin("process_load_switch");
     int res = process_load_switch("@:/shell.elf", &process);
     if (res != PEACHOS_ALL_OK)
     {
         panic("Failed to load user program\n");
     }
+    boot_trace_end();
+
+    // Userland can read the same table with peachos_boot_trace
+    boot_trace_report();
 
     // Drop to user land
     task_run_first_ever_task();
@@ -0,0 +1,235 @@
+/*
+ * PeachOS 64-Bit Kernel Project
+ * Copyright (C) 2026 Daniel McCarthy <daniel@dragonzap.com>
+ *
+ * This file is part of the PeachOS 64-Bit Kernel.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * For full source code, documentation, and structured learning,
+ * see the official kernel development course part one:
+ * https://dragonzap.com/course/developing-a-multithreaded-kernel-from-scratch
+ *
+ * Get part one and part two module one, module two all peachos courses (69 hours of content): https://dragonzap.com/offer/kernel-development-from-scratch-69-hours
+ *
+ * Get the part two course module one and two: https://dragonzap.com/offer/developing-a-multithreaded-kernel-from-scratch-part-two-full-series
+ */
+
+
+#include "lib/hashmap/hashmap.h"
+#include "memory/heap/kheap.h"
+#include "status.h"
+
+#define HASHMAP_MINIMUM_CAPACITY 8
+
+static uint64_t hashmap_hash(uint64_t key)
+{
+    // Mixes every bit of the key, pointers have their low bits clear
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+static size_t hashmap_round_capacity(size_t capacity)
+{
+    size_t rounded = HASHMAP_MINIMUM_CAPACITY;
+    while (rounded < capacity)
+    {
+        rounded <<= 1;
+    }
+
+    return rounded;
+}
+
+/**
+ * Returns the entry holding the key, or the entry the key should be placed in
+ * when it is not in the map
+ */
+static struct hashmap_entry* hashmap_find_entry(struct hashmap_entry* entries, size_t capacity, uint64_t key)
+{
+    struct hashmap_entry* first_deleted = NULL;
+    size_t mask = capacity - 1;
+    size_t index = hashmap_hash(key) & mask;
+    for (size_t i = 0; i < capacity; i++)
+    {
+        struct hashmap_entry* entry = &entries[index];
+        if (entry->state == HASHMAP_ENTRY_EMPTY)
+        {
+            return first_deleted ? first_deleted : entry;
+        }
+
+        if (entry->state == HASHMAP_ENTRY_DELETED)
+        {
+            if (!first_deleted)
+            {
+                first_deleted = entry;
+            }
+        }
+        else if (entry->key == key)
+        {
+            return entry;
+        }
+
+        index = (index + 1) & mask;
+    }
+
+    return first_deleted;
+}
+
+static int hashmap_resize(struct hashmap* map, size_t new_capacity)
+{
+    struct hashmap_entry* new_entries = kzalloc(sizeof(struct hashmap_entry) * new_capacity);
+    if (!new_entries)
+    {
+        return -ENOMEM;
+    }
+
+    for (size_t i = 0; i < map->capacity; i++)
+    {
+        struct hashmap_entry* entry = &map->entries[i];
+        if (entry->state != HASHMAP_ENTRY_USED)
+        {
+            continue;
+        }
+
+        *hashmap_find_entry(new_entries, new_capacity, entry->key) = *entry;
+    }
+
+    if (map->entries)
+    {
+        kfree(map->entries);
+    }
+
+    map->entries = new_entries;
+    map->capacity = new_capacity;
+    map->deleted = 0;
+    return 0;
+}
+
+struct hashmap* hashmap_new(size_t initial_capacity)
+{
+    struct hashmap* map = kzalloc(sizeof(struct hashmap));
+    if (!map)
+    {
+        return NULL;
+    }
+
+    if (hashmap_resize(map, hashmap_round_capacity(initial_capacity)) < 0)
+    {
+        kfree(map);
+        return NULL;
+    }
+
+    return map;
+}
+
+void hashmap_free(struct hashmap* map)
+{
+    kfree(map->entries);
+    kfree(map);
+}
+
+int hashmap_set(struct hashmap* map, uint64_t key, void* value)
+{
+    int res = 0;
+
+    // Keep the load including deleted entries under three quarters
+    if ((map->count + map->deleted + 1) * 4 > map->capacity * 3)
+    {
+        size_t new_capacity = map->capacity;
+        if ((map->count + 1) * 2 > map->capacity)
+        {
+            new_capacity *= 2;
+        }
+
+        res = hashmap_resize(map, new_capacity);
+        if (res < 0)
+        {
+            goto out;
+        }
+    }
+
+    struct hashmap_entry* entry = hashmap_find_entry(map->entries, map->capacity, key);
+    if (entry->state != HASHMAP_ENTRY_USED)
+    {
+        if (entry->state == HASHMAP_ENTRY_DELETED)
+        {
+            map->deleted--;
+        }
+
+        entry->key = key;
+        entry->state = HASHMAP_ENTRY_USED;
+        map->count++;
+    }
+    entry->value = value;
+
+out:
+    return res;
+}
+
+void* hashmap_get(struct hashmap* map, uint64_t key)
+{
+    struct hashmap_entry* entry = hashmap_find_entry(map->entries, map->capacity, key);
+    if (!entry || entry->state != HASHMAP_ENTRY_USED)
+    {
+        return NULL;
+    }
+
+    return entry->value;
+}
+
+bool hashmap_has(struct hashmap* map, uint64_t key)
+{
+    struct hashmap_entry* entry = hashmap_find_entry(map->entries, map->capacity, key);
+    return entry && entry->state == HASHMAP_ENTRY_USED;
+}
+
+int hashmap_remove(struct hashmap* map, uint64_t key)
+{
+    struct hashmap_entry* entry = hashmap_find_entry(map->entries, map->capacity, key);
+    if (!entry || entry->state != HASHMAP_ENTRY_USED)
+    {
+        return -ENOTFOUND;
+    }
+
+    entry->state = HASHMAP_ENTRY_DELETED;
+    entry->value = NULL;
+    map->count--;
+    map->deleted++;
+    return 0;
+}
+
+size_t hashmap_count(struct hashmap* map)
+{
+    return map->count;
+}
+
+bool hashmap_next(struct hashmap* map, size_t* iterator, uint64_t* key_out, void** value_out)
+{
+    while (*iterator < map->capacity)
+    {
+        struct hashmap_entry* entry = &map->entries[*iterator];
+        (*iterator)++;
+        if (entry->state == HASHMAP_ENTRY_USED)
+        {
+            *key_out = entry->key;
+            *value_out = entry->value;
+            return true;
+        }
+    }
+
+    return false;
+}
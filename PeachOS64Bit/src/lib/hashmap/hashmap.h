@@ -0,0 +1,100 @@
+/*
+ * PeachOS 64-Bit Kernel Project
+ * Copyright (C) 2026 Daniel McCarthy <daniel@dragonzap.com>
+ *
+ * This file is part of the PeachOS 64-Bit Kernel.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * For full source code, documentation, and structured learning,
+ * see the official kernel development course part one:
+ * https://dragonzap.com/course/developing-a-multithreaded-kernel-from-scratch
+ *
+ * Get part one and part two module one, module two all peachos courses (69 hours of content): https://dragonzap.com/offer/kernel-development-from-scratch-69-hours
+ *
+ * Get the part two course module one and two: https://dragonzap.com/offer/developing-a-multithreaded-kernel-from-scratch-part-two-full-series
+ */
+
+
+#ifndef KERNEL_HASHMAP_H
+#define KERNEL_HASHMAP_H
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Open addressing hash map from a 64 bit key to a pointer, keys are
+ * usually object pointers or ids. Lookup, insert and removal are O(1) on average.
+ */
+
+enum
+{
+    HASHMAP_ENTRY_EMPTY,
+    HASHMAP_ENTRY_USED,
+    // Removed, but lookups must probe past it
+    HASHMAP_ENTRY_DELETED
+};
+
+struct hashmap_entry
+{
+    uint64_t key;
+    void* value;
+    int state;
+};
+
+struct hashmap
+{
+    // Always a power of two
+    struct hashmap_entry* entries;
+    size_t capacity;
+
+    // Entries that are used
+    size_t count;
+    // Entries that are deleted, they still count towards the load
+    size_t deleted;
+};
+
+/**
+ * Creates a new hash map
+ * \param initial_capacity How many entries to make room for, rounded up to a power of two
+ */
+struct hashmap* hashmap_new(size_t initial_capacity);
+void hashmap_free(struct hashmap* map);
+
+/**
+ * Sets the value for the key replacing any existing value, the map grows as needed
+ * \return Returns zero on success, negative on error
+ */
+int hashmap_set(struct hashmap* map, uint64_t key, void* value);
+
+/**
+ * Returns the value for the key or NULL if it is not in the map
+ */
+void* hashmap_get(struct hashmap* map, uint64_t key);
+bool hashmap_has(struct hashmap* map, uint64_t key);
+
+/**
+ * Removes the key from the map
+ * \return Returns zero on success or -ENOTFOUND if the key is not in the map
+ */
+int hashmap_remove(struct hashmap* map, uint64_t key);
+size_t hashmap_count(struct hashmap* map);
+
+/**
+ * Iterates the map in no particular order, start with *iterator set to zero.
+ * The map must not be changed while iterating.
+ * \return Returns true while an entry was written to key_out and value_out
+ */
+bool hashmap_next(struct hashmap* map, size_t* iterator, uint64_t* key_out, void** value_out);
+
+#endif
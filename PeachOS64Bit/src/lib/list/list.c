@@ -0,0 +1,114 @@
+/*
+ * PeachOS 64-Bit Kernel Project
+ * Copyright (C) 2026 Daniel McCarthy <daniel@dragonzap.com>
+ *
+ * This file is part of the PeachOS 64-Bit Kernel.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * For full source code, documentation, and structured learning,
+ * see the official kernel development course part one:
+ * https://dragonzap.com/course/developing-a-multithreaded-kernel-from-scratch
+ *
+ * Get part one and part two module one, module two all peachos courses (69 hours of content): https://dragonzap.com/offer/kernel-development-from-scratch-69-hours
+ *
+ * Get the part two course module one and two: https://dragonzap.com/offer/developing-a-multithreaded-kernel-from-scratch-part-two-full-series
+ */
+
+
+#include "lib/list/list.h"
+
+void list_init(struct list* list)
+{
+    list->head.next = &list->head;
+    list->head.prev = &list->head;
+    list->count = 0;
+}
+
+void list_node_init(struct list_node* node)
+{
+    node->next = NULL;
+    node->prev = NULL;
+}
+
+bool list_node_linked(struct list_node* node)
+{
+    return node->next != NULL;
+}
+
+static void list_link(struct list* list, struct list_node* prev, struct list_node* next, struct list_node* node)
+{
+    node->prev = prev;
+    node->next = next;
+    prev->next = node;
+    next->prev = node;
+    list->count++;
+}
+
+void list_push_front(struct list* list, struct list_node* node)
+{
+    list_link(list, &list->head, list->head.next, node);
+}
+
+void list_push_back(struct list* list, struct list_node* node)
+{
+    list_link(list, list->head.prev, &list->head, node);
+}
+
+void list_insert_before(struct list* list, struct list_node* position, struct list_node* node)
+{
+    list_link(list, position->prev, position, node);
+}
+
+void list_remove(struct list* list, struct list_node* node)
+{
+    if (!list_node_linked(node))
+    {
+        return;
+    }
+
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    list_node_init(node);
+    list->count--;
+}
+
+struct list_node* list_first(struct list* list)
+{
+    return list_empty(list) ? NULL : list->head.next;
+}
+
+struct list_node* list_last(struct list* list)
+{
+    return list_empty(list) ? NULL : list->head.prev;
+}
+
+struct list_node* list_next(struct list* list, struct list_node* node)
+{
+    return node->next == &list->head ? NULL : node->next;
+}
+
+struct list_node* list_prev(struct list* list, struct list_node* node)
+{
+    return node->prev == &list->head ? NULL : node->prev;
+}
+
+bool list_empty(struct list* list)
+{
+    return list->head.next == &list->head;
+}
+
+size_t list_count(struct list* list)
+{
+    return list->count;
+}
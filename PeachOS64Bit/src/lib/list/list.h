@@ -0,0 +1,109 @@
+/*
+ * PeachOS 64-Bit Kernel Project
+ * Copyright (C) 2026 Daniel McCarthy <daniel@dragonzap.com>
+ *
+ * This file is part of the PeachOS 64-Bit Kernel.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * For full source code, documentation, and structured learning,
+ * see the official kernel development course part one:
+ * https://dragonzap.com/course/developing-a-multithreaded-kernel-from-scratch
+ *
+ * Get part one and part two module one, module two all peachos courses (69 hours of content): https://dragonzap.com/offer/kernel-development-from-scratch-69-hours
+ *
+ * Get the part two course module one and two: https://dragonzap.com/offer/developing-a-multithreaded-kernel-from-scratch-part-two-full-series
+ */
+
+
+#ifndef KERNEL_LIST_H
+#define KERNEL_LIST_H
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * Intrusive doubly linked list, embed a struct list_node in the object
+ * and use list_entry to get back to the object from its node.
+ *
+ * Linking and unlinking never allocates.
+ */
+struct list_node
+{
+    struct list_node* next;
+    struct list_node* prev;
+};
+
+struct list
+{
+    // The head is a sentinel, an empty list points it at itself
+    struct list_node head;
+    size_t count;
+};
+
+/**
+ * Returns the object that the node is embedded in
+ * \param node The list node
+ * \param type The type of the object i.e struct window
+ * \param member The name of the list_node member within the type
+ */
+#define list_entry(node, type, member) ((type*)((char*)(node) - offsetof(type, member)))
+
+/**
+ * Iterates the list from first to last, the current node must not be removed
+ */
+#define list_for_each(list, node) \
+    for ((node) = (list)->head.next; (node) != &(list)->head; (node) = (node)->next)
+
+/**
+ * Iterates the list from first to last, the current node may be removed
+ */
+#define list_for_each_safe(list, node, tmp) \
+    for ((node) = (list)->head.next, (tmp) = (node)->next; (node) != &(list)->head; (node) = (tmp), (tmp) = (node)->next)
+
+void list_init(struct list* list);
+void list_node_init(struct list_node* node);
+
+/**
+ * Returns true if the node is currently in a list
+ */
+bool list_node_linked(struct list_node* node);
+
+void list_push_front(struct list* list, struct list_node* node);
+void list_push_back(struct list* list, struct list_node* node);
+
+/**
+ * Inserts the node before position, position must be in the list
+ */
+void list_insert_before(struct list* list, struct list_node* position, struct list_node* node);
+
+/**
+ * Unlinks the node from the list, does nothing if the node is not linked
+ */
+void list_remove(struct list* list, struct list_node* node);
+
+/**
+ * Returns the first or last node or NULL if the list is empty
+ */
+struct list_node* list_first(struct list* list);
+struct list_node* list_last(struct list* list);
+
+/**
+ * Returns the node after or before the given node or NULL at the end of the list
+ */
+struct list_node* list_next(struct list* list, struct list_node* node);
+struct list_node* list_prev(struct list* list, struct list_node* node);
+
+bool list_empty(struct list* list);
+size_t list_count(struct list* list);
+
+#endif
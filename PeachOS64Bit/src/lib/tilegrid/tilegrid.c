@@ -0,0 +1,266 @@
+/*
+ * PeachOS 64-Bit Kernel Project
+ * Copyright (C) 2026 Daniel McCarthy <daniel@dragonzap.com>
+ *
+ * This file is part of the PeachOS 64-Bit Kernel.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * For full source code, documentation, and structured learning,
+ * see the official kernel development course part one:
+ * https://dragonzap.com/course/developing-a-multithreaded-kernel-from-scratch
+ *
+ * Get part one and part two module one, module two all peachos courses (69 hours of content): https://dragonzap.com/offer/kernel-development-from-scratch-69-hours
+ *
+ * Get the part two course module one and two: https://dragonzap.com/offer/developing-a-multithreaded-kernel-from-scratch-part-two-full-series
+ */
+
+
+#include "lib/tilegrid/tilegrid.h"
+#include "lib/hashmap/hashmap.h"
+#include "lib/vector/vector.h"
+#include "memory/heap/kheap.h"
+#include "kernel.h"
+#include "status.h"
+
+struct tilegrid* tilegrid_new(size_t width, size_t height, size_t tile_size)
+{
+    struct tilegrid* grid = NULL;
+    if (width == 0 || height == 0 || tile_size == 0)
+    {
+        goto out;
+    }
+
+    grid = kzalloc(sizeof(struct tilegrid));
+    if (!grid)
+    {
+        goto out;
+    }
+
+    grid->tile_size = tile_size;
+    grid->columns = (width + tile_size - 1) / tile_size;
+    grid->rows = (height + tile_size - 1) / tile_size;
+    grid->tiles = kzalloc(grid->columns * grid->rows * sizeof(struct vector*));
+    grid->entries = hashmap_new(16);
+    if (!grid->tiles || !grid->entries)
+    {
+        tilegrid_free(grid);
+        grid = NULL;
+        goto out;
+    }
+
+out:
+    return grid;
+}
+
+void tilegrid_free(struct tilegrid* grid)
+{
+    if (!grid)
+    {
+        return;
+    }
+
+    if (grid->tiles)
+    {
+        for (size_t i = 0; i < grid->columns * grid->rows; i++)
+        {
+            if (grid->tiles[i])
+            {
+                vector_free(grid->tiles[i]);
+            }
+        }
+        kfree(grid->tiles);
+    }
+
+    if (grid->entries)
+    {
+        size_t iterator = 0;
+        uint64_t key = 0;
+        void* entry = NULL;
+        while (hashmap_next(grid->entries, &iterator, &key, &entry))
+        {
+            kfree(entry);
+        }
+        hashmap_free(grid->entries);
+    }
+
+    kfree(grid);
+}
+
+static struct vector** tilegrid_tile(struct tilegrid* grid, size_t column, size_t row)
+{
+    return &grid->tiles[row * grid->columns + column];
+}
+
+static void tilegrid_unlink(struct tilegrid* grid, struct tilegrid_entry* entry)
+{
+    for (size_t row = entry->first_row; row <= entry->last_row; row++)
+    {
+        for (size_t column = entry->first_column; column <= entry->last_column; column++)
+        {
+            struct vector* tile = *tilegrid_tile(grid, column, row);
+            if (tile)
+            {
+                vector_pop_element(tile, &entry, sizeof(entry));
+            }
+        }
+    }
+}
+
+static int tilegrid_link(struct tilegrid* grid, struct tilegrid_entry* entry)
+{
+    int res = 0;
+    for (size_t row = entry->first_row; row <= entry->last_row; row++)
+    {
+        for (size_t column = entry->first_column; column <= entry->last_column; column++)
+        {
+            struct vector** tile = tilegrid_tile(grid, column, row);
+            if (!*tile)
+            {
+                *tile = vector_new(sizeof(struct tilegrid_entry*), 4, 0);
+                if (!*tile)
+                {
+                    res = -ENOMEM;
+                    goto out;
+                }
+            }
+
+            res = vector_push(*tile, &entry);
+            if (res < 0)
+            {
+                goto out;
+            }
+
+            // Sink the entry below every entry with a higher or equal order
+            size_t index = res;
+            while (index > 0 && vector_at_as(*tile, index - 1, struct tilegrid_entry*)->order < entry->order)
+            {
+                vector_swap(*tile, index - 1, index);
+                index--;
+            }
+            res = 0;
+        }
+    }
+
+out:
+    return res;
+}
+
+int tilegrid_set(struct tilegrid* grid, void* item, size_t x, size_t y, size_t width, size_t height, uint64_t order)
+{
+    int res = 0;
+    struct tilegrid_entry* entry = hashmap_get(grid->entries, (uint64_t)item);
+    if (entry)
+    {
+        tilegrid_unlink(grid, entry);
+    }
+    else
+    {
+        entry = kzalloc(sizeof(struct tilegrid_entry));
+        if (!entry)
+        {
+            res = -ENOMEM;
+            goto out;
+        }
+
+        entry->item = item;
+        res = hashmap_set(grid->entries, (uint64_t)item, entry);
+        if (res < 0)
+        {
+            kfree(entry);
+            goto out;
+        }
+    }
+
+    entry->order = order;
+    entry->x = x;
+    entry->y = y;
+    entry->width = width;
+    entry->height = height;
+
+    // Items that are empty or off the grid stay registered without any tiles
+    size_t grid_width = grid->columns * grid->tile_size;
+    size_t grid_height = grid->rows * grid->tile_size;
+    if (width == 0 || height == 0 || x >= grid_width || y >= grid_height)
+    {
+        entry->first_column = 1;
+        entry->last_column = 0;
+        entry->first_row = 1;
+        entry->last_row = 0;
+        goto out;
+    }
+
+    entry->first_column = x / grid->tile_size;
+    entry->first_row = y / grid->tile_size;
+    entry->last_column = MIN(x + width - 1, grid_width - 1) / grid->tile_size;
+    entry->last_row = MIN(y + height - 1, grid_height - 1) / grid->tile_size;
+    res = tilegrid_link(grid, entry);
+    if (res < 0)
+    {
+        // Do not leave the item half linked
+        tilegrid_unlink(grid, entry);
+        hashmap_remove(grid->entries, (uint64_t)item);
+        kfree(entry);
+        goto out;
+    }
+
+out:
+    return res;
+}
+
+void tilegrid_remove(struct tilegrid* grid, void* item)
+{
+    struct tilegrid_entry* entry = hashmap_get(grid->entries, (uint64_t)item);
+    if (!entry)
+    {
+        return;
+    }
+
+    tilegrid_unlink(grid, entry);
+    hashmap_remove(grid->entries, (uint64_t)item);
+    kfree(entry);
+}
+
+void* tilegrid_get_at(struct tilegrid* grid, size_t x, size_t y, void* ignored)
+{
+    size_t column = x / grid->tile_size;
+    size_t row = y / grid->tile_size;
+    if (column >= grid->columns || row >= grid->rows)
+    {
+        return NULL;
+    }
+
+    struct vector* tile = *tilegrid_tile(grid, column, row);
+    if (!tile)
+    {
+        return NULL;
+    }
+
+    size_t total = vector_count(tile);
+    for (size_t i = 0; i < total; i++)
+    {
+        struct tilegrid_entry* entry = vector_at_as(tile, i, struct tilegrid_entry*);
+        if (entry->item == ignored)
+        {
+            continue;
+        }
+
+        if (x >= entry->x && x < entry->x + entry->width &&
+            y >= entry->y && y < entry->y + entry->height)
+        {
+            return entry->item;
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,99 @@
+/*
+ * PeachOS 64-Bit Kernel Project
+ * Copyright (C) 2026 Daniel McCarthy <daniel@dragonzap.com>
+ *
+ * This file is part of the PeachOS 64-Bit Kernel.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * For full source code, documentation, and structured learning,
+ * see the official kernel development course part one:
+ * https://dragonzap.com/course/developing-a-multithreaded-kernel-from-scratch
+ *
+ * Get part one and part two module one, module two all peachos courses (69 hours of content): https://dragonzap.com/offer/kernel-development-from-scratch-69-hours
+ *
+ * Get the part two course module one and two: https://dragonzap.com/offer/developing-a-multithreaded-kernel-from-scratch-part-two-full-series
+ */
+
+
+#ifndef KERNEL_TILEGRID_H
+#define KERNEL_TILEGRID_H
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Spatial index of rectangles over a grid of square tiles. Each tile keeps the
+ * items overlapping it ordered from the highest order down, so finding the top
+ * most item at a point only looks at the few items in one tile.
+ */
+
+struct hashmap;
+struct vector;
+
+struct tilegrid_entry
+{
+    void* item;
+    // Higher orders are on top
+    uint64_t order;
+
+    // Tile range the item is stored in, inclusive
+    size_t first_column;
+    size_t first_row;
+    size_t last_column;
+    size_t last_row;
+
+    // The rectangle of the item
+    size_t x;
+    size_t y;
+    size_t width;
+    size_t height;
+};
+
+struct tilegrid
+{
+    size_t tile_size;
+    size_t columns;
+    size_t rows;
+
+    // columns*rows vectors of struct tilegrid_entry*, created when first used
+    struct vector** tiles;
+
+    // Maps the item to its struct tilegrid_entry*
+    struct hashmap* entries;
+};
+
+/**
+ * Creates a grid covering width*height pixels
+ */
+struct tilegrid* tilegrid_new(size_t width, size_t height, size_t tile_size);
+void tilegrid_free(struct tilegrid* grid);
+
+/**
+ * Inserts the item or moves it when it is already in the grid
+ * \return Returns zero on success, negative on error
+ */
+int tilegrid_set(struct tilegrid* grid, void* item, size_t x, size_t y, size_t width, size_t height, uint64_t order);
+
+/**
+ * Removes the item, does nothing if it is not in the grid
+ */
+void tilegrid_remove(struct tilegrid* grid, void* item);
+
+/**
+ * Returns the item with the highest order whose rectangle holds the point or NULL
+ * \param ignored Item that is skipped, can be NULL
+ */
+void* tilegrid_get_at(struct tilegrid* grid, size_t x, size_t y, void* ignored);
+
+#endif
@@ -29,9 +29,14 @@
 #include "status.h"
 #include "memory/heap/kheap.h"
 #include "memory/memory.h"
+#include "kernel.h"
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdbool.h>
+
+// Runs this short are insertion sorted before they are merged
+#define VECTOR_SORT_RUN_SIZE 16
 
 int vector_resize(struct vector *vec, size_t total_needed_elements);
 
@@ -52,6 +57,37 @@ static void *vector_memory_at_index(struct vector *vec, size_t index)
     return (void *)((uintptr_t)vec->memory + offset);
 }
 
+/**
+ * Compares the element at index against the value at mem_val without copying it out,
+ * pointer sized elements are compared as one word
+ */
+static bool vector_element_equals(struct vector *vec, size_t index, void *mem_val)
+{
+    void *element = vector_memory_at_index(vec, index);
+    if (vec->e_size == sizeof(uintptr_t))
+    {
+        return *(uintptr_t *)element == *(uintptr_t *)mem_val;
+    }
+
+    return memcmp(element, mem_val, vec->e_size) == 0;
+}
+
+/**
+ * Returns the index of the first element equal to mem_val, or negative if there is none
+ */
+static long vector_find(struct vector *vec, void *mem_val)
+{
+    for (size_t i = 0; i < vec->t_elems; i++)
+    {
+        if (vector_element_equals(vec, i, mem_val))
+        {
+            return i;
+        }
+    }
+
+    return -EOUTOFRANGE;
+}
+
 /**
  * Creates a new vector that can hold "element_size" per element of data
  * \param element_size The size of each element to be stored in the vector
@@ -89,6 +125,7 @@ int vector_grow(struct vector* vec, size_t total_elements)
         goto out;
     }
 
+    memset(vector_memory_at_index(vec, vec->t_elems), 0, total_elements * vec->e_size);
     vec->t_elems += total_elements;
 out:    
     return res;
@@ -104,21 +141,28 @@ int vector_resize(struct vector *vec, size_t total_needed_elements)
     int res = 0;
     size_t total_elements_required = vec->t_elems + total_needed_elements;
     // Have we already got the memory allocated for the needed elementes
-    if (vec->tm_elems > total_elements_required)
+    if (vec->tm_elems >= total_elements_required)
     {
         // We have enough room already, no resize needed
         return 0;
     }
 
-    // We need to allocate
+    // We need to allocate, at least doubling so pushes stay cheap as the vector grows
     size_t final_total_elements_required = vec->t_reserved_elements + total_elements_required;
+    if (final_total_elements_required < vec->tm_elems * 2)
+    {
+        final_total_elements_required = vec->tm_elems * 2;
+    }
+
     size_t total_bytes_required = final_total_elements_required * vec->e_size;
-    vec->memory = krealloc(vec->memory, total_bytes_required);
-    if (!vec->memory)
+    void *new_memory = krealloc(vec->memory, total_bytes_required);
+    if (!new_memory)
     {
+        // The old memory is still valid
         res = -ENOMEM;
         goto out;
     }
+    vec->memory = new_memory;
 
     // Let's record the increase in size
     vec->tm_elems = final_total_elements_required;
@@ -194,33 +238,21 @@ out:
  */
 int vector_has(struct vector* vec, void* elem_val_ptr, size_t elem_size, size_t* index_out)
 {
-    int res = 0;
     // Safety check.
     if (vec->e_size != elem_size)
     {
         return -EINVARG;
     }
 
-    // By default assume an error
-    res = -EOUTOFRANGE;
-
-    // Should be okay people shouldnt use the vector
-    // for storing massive amounts of data, pointers or small structs.
-    char tmp_buf[elem_size];
-    size_t total_elems = vector_count(vec);
-    size_t i = 0;
-    for(i = 0; i < total_elems; i++)
+    long index = vector_find(vec, elem_val_ptr);
+    if (index < 0)
     {
-        vector_at(vec, i, tmp_buf, elem_size);
-        if (memcmp(elem_val_ptr, tmp_buf, elem_size) == 0)
-        {
-            // Vector has this element
-            res = 0;
-            break;
-        }
+        *index_out = vec->t_elems;
+        return index;
     }
-    *index_out = i;
-    return res;
+
+    *index_out = index;
+    return 0;
 }
 /**
  * Removes an element from the vector
@@ -247,6 +279,182 @@ int vector_back(struct vector *vec, void *data_out, size_t size)
     return vector_at(vec, vec->t_elems - 1, data_out, size);
 }
 
+void vector_swap(struct vector *vec, size_t first_index, size_t second_index)
+{
+    if (first_index == second_index)
+    {
+        return;
+    }
+
+    uint8_t *first = vector_memory_at_index(vec, first_index);
+    uint8_t *second = vector_memory_at_index(vec, second_index);
+    size_t i = 0;
+
+    // Pointer sized elements are the common case, swap a word at a time
+    for (; i + sizeof(uint64_t) <= vec->e_size; i += sizeof(uint64_t))
+    {
+        uint64_t tmp = *(uint64_t *)(first + i);
+        *(uint64_t *)(first + i) = *(uint64_t *)(second + i);
+        *(uint64_t *)(second + i) = tmp;
+    }
+
+    for (; i < vec->e_size; i++)
+    {
+        uint8_t tmp = first[i];
+        first[i] = second[i];
+        second[i] = tmp;
+    }
+}
+
+/**
+ * True when the element at first_index must be ordered before the element at second_index
+ */
+static bool vector_sort_less(struct vector *vec, VECTOR_REORDER_FUNCTION reorder_function, size_t first_index, size_t second_index)
+{
+    return reorder_function(vector_memory_at_index(vec, second_index), vector_memory_at_index(vec, first_index)) > 0;
+}
+
+static void vector_sort_insertion(struct vector *vec, VECTOR_REORDER_FUNCTION reorder_function, size_t start, size_t end)
+{
+    for (size_t i = start + 1; i < end; i++)
+    {
+        for (size_t j = i; j > start && vector_sort_less(vec, reorder_function, j, j - 1); j--)
+        {
+            vector_swap(vec, j, j - 1);
+        }
+    }
+}
+
+static void vector_sort_swap_range(struct vector *vec, size_t first, size_t second, size_t total)
+{
+    for (size_t i = 0; i < total; i++)
+    {
+        vector_swap(vec, first + i, second + i);
+    }
+}
+
+/**
+ * Rotates the elements so the range middle to end comes before start to middle
+ */
+static void vector_sort_rotate(struct vector *vec, size_t start, size_t middle, size_t end)
+{
+    size_t i = middle - start;
+    size_t j = end - middle;
+    while (i != j)
+    {
+        if (i > j)
+        {
+            vector_sort_swap_range(vec, middle - i, middle, j);
+            i -= j;
+        }
+        else
+        {
+            vector_sort_swap_range(vec, middle - i, middle + j - i, i);
+            j -= i;
+        }
+    }
+
+    vector_sort_swap_range(vec, middle - i, middle, i);
+}
+
+/**
+ * Merges the sorted runs start to middle and middle to end in place, keeping
+ * equal elements in their original order
+ */
+static void vector_sort_merge(struct vector *vec, VECTOR_REORDER_FUNCTION reorder_function, size_t start, size_t middle, size_t end)
+{
+    if (middle - start == 1)
+    {
+        // Binary search for where the single element goes, then slide it there
+        size_t i = middle;
+        size_t j = end;
+        while (i < j)
+        {
+            size_t h = (i + j) / 2;
+            if (vector_sort_less(vec, reorder_function, h, start))
+            {
+                i = h + 1;
+            }
+            else
+            {
+                j = h;
+            }
+        }
+
+        for (size_t k = start; k + 1 < i; k++)
+        {
+            vector_swap(vec, k, k + 1);
+        }
+        return;
+    }
+
+    if (end - middle == 1)
+    {
+        size_t i = start;
+        size_t j = middle;
+        while (i < j)
+        {
+            size_t h = (i + j) / 2;
+            if (!vector_sort_less(vec, reorder_function, middle, h))
+            {
+                i = h + 1;
+            }
+            else
+            {
+                j = h;
+            }
+        }
+
+        for (size_t k = middle; k > i; k--)
+        {
+            vector_swap(vec, k, k - 1);
+        }
+        return;
+    }
+
+    size_t half = (start + end) / 2;
+    size_t n = half + middle;
+    size_t lower = start;
+    size_t upper = middle;
+    if (middle > half)
+    {
+        lower = n - end;
+        upper = half;
+    }
+
+    size_t p = n - 1;
+    while (lower < upper)
+    {
+        size_t c = (lower + upper) / 2;
+        if (!vector_sort_less(vec, reorder_function, p - c, c))
+        {
+            lower = c + 1;
+        }
+        else
+        {
+            upper = c;
+        }
+    }
+
+    size_t split_end = n - lower;
+    if (lower < middle && middle < split_end)
+    {
+        vector_sort_rotate(vec, lower, middle, split_end);
+    }
+    if (start < lower && lower < half)
+    {
+        vector_sort_merge(vec, reorder_function, start, lower, half);
+    }
+    if (half < split_end && split_end < end)
+    {
+        vector_sort_merge(vec, reorder_function, half, split_end, end);
+    }
+}
+
+/**
+ * Sorts the vector in place without allocating, elements where reorder_function(a, b) > 0
+ * are moved so that b comes before a. Equal elements keep their order.
+ */
 void vector_reorder(struct vector* vec, VECTOR_REORDER_FUNCTION reorder_function)
 {
     // Sanity checks
@@ -258,48 +466,21 @@ void vector_reorder(struct vector* vec, VECTOR_REORDER_FUNCTION reorder_function
     if (count < 2)
         return;
 
-    // We'll do a simple bubble sort
-    // For that, we need temporary buffers to hold elements while swapping
-    uint8_t* elem1 = kzalloc(vec->e_size);
-    uint8_t* elem2 = kzalloc(vec->e_size);
-
-    if (!elem1 || !elem2)
+    // Insertion sort short runs, they are cheap and usually already in order
+    size_t run_size = VECTOR_SORT_RUN_SIZE;
+    for (size_t start = 0; start < count; start += run_size)
     {
-        if (elem1) kfree(elem1);
-        if (elem2) kfree(elem2);
-        return; // Out of memory
+        vector_sort_insertion(vec, reorder_function, start, MIN(start + run_size, count));
     }
 
-    for (size_t i = 0; i < count - 1; i++)
+    // Then merge neighbouring runs until there is one
+    for (; run_size < count; run_size *= 2)
     {
-        for (size_t j = 0; j < count - i - 1; j++)
+        for (size_t start = 0; start + run_size < count; start += run_size * 2)
         {
-            // Read element j
-            if (vector_at(vec, j, elem1, vec->e_size) < 0)
-                goto cleanup;
-
-            // Read element j+1
-            if (vector_at(vec, j + 1, elem2, vec->e_size) < 0)
-                goto cleanup;
-
-            // If reorder_function(...) > 0, then we swap
-            // Typical meaning: reorder_function(a, b) > 0 implies a > b, so we reorder them
-            if (reorder_function(elem1, elem2) > 0)
-            {
-                // Swap in the vector
-                // (Write elem2 at index j)
-                if (vector_overwrite(vec, j, elem2, vec->e_size) < 0)
-                    goto cleanup;
-                // (Write elem1 at index j+1)
-                if (vector_overwrite(vec, j + 1, elem1, vec->e_size) < 0)
-                    goto cleanup;
-            }
+            vector_sort_merge(vec, reorder_function, start, start + run_size, MIN(start + run_size * 2, count));
         }
     }
-
-cleanup:
-    kfree(elem1);
-    kfree(elem2);
 }
 
 
@@ -356,6 +537,48 @@ out:
     return res;
 }
 
+void *vector_at_ptr(struct vector *vec, size_t index)
+{
+    if (vector_valid_bounds(vec, index) < 0)
+    {
+        return NULL;
+    }
+
+    return vector_memory_at_index(vec, index);
+}
+
+int vector_remove_at(struct vector *vec, size_t index)
+{
+    int res = vector_valid_bounds(vec, index);
+    if (res < 0)
+    {
+        return res;
+    }
+
+    // Shift everything after the index one position to the left
+    size_t total_elements_to_move = (vec->t_elems - index) - 1;
+    memmove(vector_memory_at_index(vec, index), vector_memory_at_index(vec, index + 1), total_elements_to_move * vec->e_size);
+    vec->t_elems--;
+    return 0;
+}
+
+int vector_swap_remove_at(struct vector *vec, size_t index)
+{
+    int res = vector_valid_bounds(vec, index);
+    if (res < 0)
+    {
+        return res;
+    }
+
+    // The last element takes the place of the removed one
+    if (index != vec->t_elems - 1)
+    {
+        memcpy(vector_memory_at_index(vec, index), vector_memory_at_index(vec, vec->t_elems - 1), vec->e_size);
+    }
+    vec->t_elems--;
+    return 0;
+}
+
 /**
  * Pops the element with the given value from the vector.
  * 
@@ -366,74 +589,35 @@ out:
  */
 int vector_pop_element(struct vector* vec, void* mem_val, size_t size)
 {
-    int res = 0;
-
     // Validate size matches the vector element size
     if (size != vec->e_size)
     {
         return -EINVARG;
     }
 
-    size_t total_elements = vector_count(vec);
-    long index_to_remove = -1;
-
-    // Temporary buffer for comparison
-    void* tmp_mem = kzalloc(size);
-    if (!tmp_mem)
+    long index_to_remove = vector_find(vec, mem_val);
+    if (index_to_remove < 0)
     {
-        return -ENOMEM;
-    }
-
-    // Search for the element in the vector
-    for (size_t i = 0; i < total_elements; i++)
-    {
-        res = vector_at(vec, i, tmp_mem, size);
-        if (res < 0)
-        {
-            // Error reading element
-            goto out;
-        }
-
-        // If we found the element, remember its index and break
-        if (memcmp(tmp_mem, mem_val, size) == 0)
-        {
-            index_to_remove = i;
-            break;
-        }
+        return -EIO;
     }
 
-    // If the element wasn't found, bail out
-    if (index_to_remove == -1)
-    {
-        res = -EIO;
-        goto out;
-    }
+    return vector_remove_at(vec, index_to_remove);
+}
 
-    // If the element to remove is the last one, a normal pop is enough
-    if ((size_t)index_to_remove == total_elements - 1)
+int vector_swap_pop_element(struct vector* vec, void* mem_val, size_t size)
+{
+    if (size != vec->e_size)
     {
-        res = vector_pop(vec);
-        goto out;
+        return -EINVARG;
     }
 
-    // Otherwise, shift elements after index_to_remove to the left
+    long index_to_remove = vector_find(vec, mem_val);
+    if (index_to_remove < 0)
     {
-        uint8_t* ptr_to_element_to_delete = (uint8_t*)vec->memory + (index_to_remove * size);
-        uint8_t* ptr_to_next_element     = ptr_to_element_to_delete + size;
-
-        size_t total_elements_to_copy = (vec->t_elems - index_to_remove) - 1;
-        size_t total_bytes_to_copy    = total_elements_to_copy * size;
-
-        // Shift everything after index_to_remove one position to the left
-        memcpy(ptr_to_element_to_delete, ptr_to_next_element, total_bytes_to_copy);
-
-        // Decrement the logical element count
-        vec->t_elems--;
+        return -EIO;
     }
 
-out:
-    kfree(tmp_mem);
-    return res;
+    return vector_swap_remove_at(vec, index_to_remove);
 }
 
 /**
@@ -93,10 +93,17 @@ int vector_push(struct vector* vec, void* elem);
 int vector_pop(struct vector* vec);
 
 /**
- * Reorders the vector.
+ * Sorts the vector in place in O(n log n) comparisons, no memory is allocated.
+ * Elements where reorder_function(a, b) > 0 are moved so that b comes first,
+ * elements that compare equal keep their order.
  */
 void vector_reorder(struct vector* vec, VECTOR_REORDER_FUNCTION reorder_function);
 
+/**
+ * Swaps the elements at the two indexes, both must be in bounds
+ */
+void vector_swap(struct vector* vec, size_t first_index, size_t second_index);
+
 
 /**
  * Returns >= 0 if it exists, negative if not found
@@ -137,6 +144,20 @@ int vector_back(struct vector* vec, void* data_out, size_t size);
  */
 int vector_at(struct vector* vec, size_t index, void* data_out, size_t size);
 
+/**
+ * Returns a pointer to the element at the given index or NULL if it is out of bounds.
+ *
+ * The pointer is only valid until the vector is next pushed to or grown
+ * as the vector memory may move when it is resized.
+ */
+void* vector_at_ptr(struct vector* vec, size_t index);
+
+/**
+ * Returns the element at the given index as the given type, the index must be in bounds
+ * i.e struct window* window = vector_at_as(windows_vector, i, struct window*);
+ */
+#define vector_at_as(vec, index, type) (*((type*) vector_at_ptr(vec, index)))
+
 
 /**
  * Returns the total number of elements within this vector
@@ -157,6 +178,23 @@ size_t vector_count(struct vector* vec);
  */
 int vector_pop_element(struct vector* vec, void* mem_val, size_t size);
 
+/**
+ * Pops the element with the given value from the vector by moving the last
+ * element into its place. Constant time but the order is not kept.
+ */
+int vector_swap_pop_element(struct vector* vec, void* mem_val, size_t size);
+
+/**
+ * Removes the element at the given index, shifting the elements after it to the left
+ */
+int vector_remove_at(struct vector* vec, size_t index);
+
+/**
+ * Removes the element at the given index by moving the last element into its place.
+ * Constant time but the order is not kept.
+ */
+int vector_swap_remove_at(struct vector* vec, size_t index);
+
 
 /**
  * Grows the vector by the given total number of elements
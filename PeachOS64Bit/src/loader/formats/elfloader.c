@@ -33,12 +33,17 @@
 #include "memory/heap/kheap.h"
 #include "string/string.h"
 #include "memory/paging/paging.h"
+#include "lib/vector/vector.h"
 #include "kernel.h"
 #include "config.h"
 
 
 const char elf_signature[] = {0x7f, 'E', 'L', 'F'};
 
+// Every loaded elf file, shared by all the processes running it
+// vector of struct elf_file*
+static struct vector* elf_file_cache = NULL;
+
 static bool elf_valid_signature(void* buffer)
 {
     return memcmp(buffer, (void*) elf_signature, sizeof(elf_signature)) == 0;
@@ -75,11 +80,6 @@ struct elf_header* elf_header(struct elf_file* file)
     return file->elf_memory;
 }
 
-struct elf64_shdr* elf_sheader(struct elf_header* header)
-{
-    return (struct elf64_shdr*)((elf64_off)header+header->e_shoff);
-}
-
 struct elf64_phdr* elf_pheader(struct elf_header* header)
 {
     if(header->e_phoff == 0)
@@ -95,20 +95,58 @@ struct elf64_phdr* elf_program_header(struct elf_header* header, int index)
     return &elf_pheader(header)[index];
 }
 
-struct elf64_shdr* elf_section(struct elf_header* header, int index)
-{
-    return &elf_sheader(header)[index];
-}
-
 
-void* elf_phdr_phys_address(struct elf_file* file, struct elf64_phdr* phdr)
+/**
+ * Returns true if the page aligned virtual address lies within the loaded segment
+ */
+bool elf_phdr_covers_page(struct elf64_phdr* phdr, void* page)
 {
-    return elf_memory(file)+phdr->p_offset;
+    if (phdr->p_type != PT_LOAD || phdr->p_memsz == 0)
+    {
+        return false;
+    }
+
+    uintptr_t page_start = (uintptr_t) page;
+    uintptr_t segment_start = (uintptr_t) paging_align_to_lower_page((void*) phdr->p_vaddr);
+    uintptr_t segment_end = (uintptr_t) paging_align_address((void*)(phdr->p_vaddr + phdr->p_memsz));
+    return page_start >= segment_start && page_start < segment_end;
 }
 
-char* elf_str_table(struct elf_header* header)
+/**
+ * Reads the part of the segment that lives in the given virtual page into page_out.
+ * page_out must be a zeroed page, anything past p_filesz is left as zero which gives us .bss
+ */
+int elf_segment_page_read(struct elf_file* file, struct elf64_phdr* phdr, void* page, void* page_out)
 {
-    return (char*) header + elf_section(header, header->e_shstrndx)->sh_offset;
+    int res = 0;
+    uintptr_t page_start = (uintptr_t) page;
+    uintptr_t page_end = page_start + PAGING_PAGE_SIZE;
+    uintptr_t file_start = phdr->p_vaddr;
+    uintptr_t file_end = phdr->p_vaddr + phdr->p_filesz;
+
+    uintptr_t copy_start = MAX(page_start, file_start);
+    uintptr_t copy_end = MIN(page_end, file_end);
+    if (copy_start >= copy_end)
+    {
+        // Only .bss in this page
+        goto out;
+    }
+
+    res = fseek(file->fd, phdr->p_offset + (copy_start - file_start), SEEK_SET);
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    res = fread((char*) page_out + (copy_start - page_start), copy_end - copy_start, 1, file->fd);
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    res = 0;
+out:
+    return res;
 }
 
 void* elf_virtual_base(struct elf_file* file)
@@ -121,14 +159,134 @@ void* elf_virtual_end(struct elf_file* file)
     return file->virtual_end_address;
 }
 
-void* elf_phys_base(struct elf_file* file)
+/**
+ * Returns the shared page for the page aligned virtual address, loading it
+ * from the file the first time. Returns NULL if no segment covers the page.
+ */
+void* elf_image_page(struct elf_file* file, void* page)
 {
-    return file->physical_base_address;
+    if (page < file->page_base)
+    {
+        return NULL;
+    }
+
+    size_t index = (page - file->page_base) / PAGING_PAGE_SIZE;
+    if (index >= file->total_pages)
+    {
+        return NULL;
+    }
+
+    if (file->pages[index])
+    {
+        return file->pages[index];
+    }
+
+    void* page_data = NULL;
+    struct elf_header* header = elf_header(file);
+    for (int i = 0; i < header->e_phnum; i++)
+    {
+        struct elf64_phdr* phdr = elf_program_header(header, i);
+        if (!elf_phdr_covers_page(phdr, page))
+        {
+            continue;
+        }
+
+        if (!page_data)
+        {
+            page_data = kzalloc(PAGING_PAGE_SIZE);
+            if (!page_data)
+            {
+                return NULL;
+            }
+        }
+
+        if (elf_segment_page_read(file, phdr, page, page_data) < 0)
+        {
+            kfree(page_data);
+            return NULL;
+        }
+    }
+
+    file->pages[index] = page_data;
+    return page_data;
 }
 
-void* elf_phys_end(struct elf_file* file)
+bool elf_page_writeable(struct elf_file* file, void* page)
 {
-    return file->physical_end_address;
+    struct elf_header* header = elf_header(file);
+    for (int i = 0; i < header->e_phnum; i++)
+    {
+        struct elf64_phdr* phdr = elf_program_header(header, i);
+        if (elf_phdr_covers_page(phdr, page) && (phdr->p_flags & PF_W))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static int elf_image_pages_init(struct elf_file* elf_file)
+{
+    int res = 0;
+    uintptr_t start = 0;
+    uintptr_t end = 0;
+    struct elf_header* header = elf_header(elf_file);
+    for (int i = 0; i < header->e_phnum; i++)
+    {
+        struct elf64_phdr* phdr = elf_program_header(header, i);
+        if (phdr->p_type != PT_LOAD || phdr->p_memsz == 0)
+        {
+            continue;
+        }
+
+        uintptr_t segment_start = (uintptr_t) paging_align_to_lower_page((void*) phdr->p_vaddr);
+        uintptr_t segment_end = (uintptr_t) paging_align_address((void*)(phdr->p_vaddr + phdr->p_memsz));
+        if (start == 0 || segment_start < start)
+        {
+            start = segment_start;
+        }
+
+        if (segment_end > end)
+        {
+            end = segment_end;
+        }
+    }
+
+    elf_file->page_base = (void*) start;
+    elf_file->total_pages = (end - start) / PAGING_PAGE_SIZE;
+    if (elf_file->total_pages == 0)
+    {
+        goto out;
+    }
+
+    elf_file->pages = kzalloc(sizeof(void*) * elf_file->total_pages);
+    if (!elf_file->pages)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
+out:
+    return res;
+}
+
+static struct elf_file* elf_cache_get(const char* filename, uint32_t filesize)
+{
+    size_t total_files = vector_count(elf_file_cache);
+    for (size_t i = 0; i < total_files; i++)
+    {
+        struct elf_file* elf_file = NULL;
+        vector_at(elf_file_cache, i, &elf_file, sizeof(elf_file));
+        if (elf_file &&
+            elf_file->filesize == filesize &&
+            strncmp(elf_file->filename, filename, sizeof(elf_file->filename)) == 0)
+        {
+            return elf_file;
+        }
+    }
+
+    return NULL;
 }
 
 int elf_validate_loaded(struct elf_header* header)
@@ -141,21 +299,18 @@ int elf_process_phdr_pt_load(struct elf_file* elf_file, struct elf64_phdr* phdr)
     if (elf_file->virtual_base_address >= (void*) phdr->p_vaddr || elf_file->virtual_base_address == 0x00)
     {
         elf_file->virtual_base_address = (void*)  phdr->p_vaddr;
-        elf_file->physical_base_address = elf_memory(elf_file)+phdr->p_offset;
     }
 
     uintptr_t end_virtual_address = phdr->p_vaddr + phdr->p_filesz;
     if (elf_file->virtual_end_address <= (void*)(end_virtual_address) || elf_file->virtual_end_address == 0x00)
     {
         elf_file->virtual_end_address = (void*) end_virtual_address;
-        elf_file->physical_end_address = elf_memory(elf_file)+phdr->p_offset+phdr->p_filesz;
     }
 
-    size_t filesize = phdr->p_filesz;
-    size_t total_size = phdr->p_memsz;
-    if (total_size > filesize)
+    // Segments are read and .bss zeroed a page at a time when the process first touches them
+    if (phdr->p_filesz > phdr->p_memsz)
     {
-        memset((char*)elf_file->physical_base_address+filesize, 0, total_size-filesize);
+        return -EINFORMAT;
     }
     return 0;
 }
@@ -214,6 +369,23 @@ void elf_file_free(struct elf_file* elf_file)
         kfree(elf_file->elf_memory);
     }
 
+    if (elf_file->pages)
+    {
+        for (size_t i = 0; i < elf_file->total_pages; i++)
+        {
+            if (elf_file->pages[i])
+            {
+                kfree(elf_file->pages[i]);
+            }
+        }
+        kfree(elf_file->pages);
+    }
+
+    if (elf_file->fd > 0)
+    {
+        fclose(elf_file->fd);
+    }
+
     kfree(elf_file);
 }
 struct elf_file* elf_file_new()
@@ -221,9 +393,28 @@ struct elf_file* elf_file_new()
     return (struct elf_file*)kzalloc(sizeof(struct elf_file));
 }
 
+/**
+ * Loads only the elf header and program headers, the file is left
+ * open for elf_segment_page_read. If the same file is already loaded
+ * the loaded elf file is shared, close it with elf_close.
+ */
 int elf_load(const char* filename, struct elf_file** file_out)
 {
+    if (!elf_file_cache)
+    {
+        elf_file_cache = vector_new(sizeof(struct elf_file*), 4, 0);
+        if (!elf_file_cache)
+        {
+            return -ENOMEM;
+        }
+    }
+
     struct elf_file* elf_file = elf_file_new();
+    if (!elf_file)
+    {
+        return -ENOMEM;
+    }
+
     int fd = 0;
     int res = fopen(filename, "r");
     if (res <= 0)
@@ -233,6 +424,7 @@ int elf_load(const char* filename, struct elf_file** file_out)
     }
 
     fd = res;
+    elf_file->fd = fd;
     struct file_stat stat;
     res = fstat(fd, &stat);
     if (res < 0)
@@ -240,8 +432,57 @@ int elf_load(const char* filename, struct elf_file** file_out)
         goto out;
     }
 
-    elf_file->elf_memory = kzalloc(stat.filesize);
-    res = fread(elf_file->elf_memory, stat.filesize, 1, fd);
+    struct elf_file* cached_elf_file = elf_cache_get(filename, stat.filesize);
+    if (cached_elf_file)
+    {
+        // Already loaded, share it
+        cached_elf_file->refcount++;
+        elf_file_free(elf_file);
+        *file_out = cached_elf_file;
+        return 0;
+    }
+
+    struct elf_header header;
+    if (stat.filesize < sizeof(header))
+    {
+        res = -EINFORMAT;
+        goto out;
+    }
+
+    res = fread(&header, sizeof(header), 1, fd);
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    if (!elf_valid_signature(&header) || !elf_has_program_header(&header))
+    {
+        res = -EINFORMAT;
+        goto out;
+    }
+
+    size_t headers_size = header.e_phoff + header.e_phnum * sizeof(struct elf64_phdr);
+    if (headers_size > stat.filesize)
+    {
+        res = -EINFORMAT;
+        goto out;
+    }
+
+    elf_file->in_memory_size = headers_size;
+    elf_file->elf_memory = kzalloc(headers_size);
+    if (!elf_file->elf_memory)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
+    res = fseek(fd, 0, SEEK_SET);
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    res = fread(elf_file->elf_memory, headers_size, 1, fd);
     if (res < 0)
     {
         goto out;
@@ -253,13 +494,22 @@ int elf_load(const char* filename, struct elf_file** file_out)
         goto out;
     }
 
+    res = elf_image_pages_init(elf_file);
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    strncpy(elf_file->filename, filename, sizeof(elf_file->filename));
+    elf_file->filesize = stat.filesize;
+    elf_file->refcount = 1;
+    vector_push(elf_file_cache, &elf_file);
     *file_out = elf_file;
 out:
     if (res < 0)
     {
         elf_file_free(elf_file);
     }
-    fclose(fd);
     return res;
 }
 
@@ -268,6 +518,13 @@ void elf_close(struct elf_file* file)
     if (!file)
         return;
 
-    kfree(file->elf_memory);
-    kfree(file);
+    file->refcount--;
+    if (file->refcount > 0)
+    {
+        // Other processes are still running this file
+        return;
+    }
+
+    vector_swap_pop_element(elf_file_cache, &file, sizeof(file));
+    elf_file_free(file);
 }
\ No newline at end of file
@@ -30,6 +30,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 #include "elf.h"
 #include "config.h"
@@ -41,30 +42,40 @@ struct elf_file
     int in_memory_size;
 
     /**
-     * The physical memory address that this elf file is loaded at
+     * The elf header and program headers, the segments themselves
+     * are not loaded into memory. See elf_segment_page_read
      */
     void* elf_memory;
 
     /**
-     * The virtual base address of this binary
+     * The file stays open for as long as the elf file is loaded
+     * so segment pages can be read when they are first touched.
      */
-    void* virtual_base_address;
+    int fd;
+
+    // Size of the file when it was loaded, with the filename this identifies the cached image
+    uint32_t filesize;
+
+    // Total processes using this elf file, it is closed when this reaches zero
+    int refcount;
 
     /**
-     * The ending virtual address
+     * Pages of the loaded segments shared between every process running
+     * this file, indexed from page_base. Filled in as they are first touched
      */
-    void* virtual_end_address;
+    void* page_base;
+    size_t total_pages;
+    void** pages;
 
     /**
-     * The physical base address of this binary
+     * The virtual base address of this binary
      */
-    void* physical_base_address;
+    void* virtual_base_address;
 
     /**
-     * The physical end address of this bunary
+     * The ending virtual address
      */
-    void* physical_end_address;
-    
+    void* virtual_end_address;
 
 };
 
@@ -75,15 +86,14 @@ void elf_file_free(struct elf_file* file);
 void elf_close(struct elf_file* file);
 void* elf_virtual_base(struct elf_file* file);
 void* elf_virtual_end(struct elf_file* file);
-void* elf_phys_base(struct elf_file* file);
-void* elf_phys_end(struct elf_file* file);
 
 struct elf_header* elf_header(struct elf_file* file);
-struct elf64_shdr* elf_sheader(struct elf_header* header);
 void* elf_memory(struct elf_file* file);
 struct elf64_phdr* elf_pheader(struct elf_header* header);
 struct elf64_phdr* elf_program_header(struct elf_header* header, int index);
-struct elf64_shdr* elf_section(struct elf_header* header, int index);
-void* elf_phdr_phys_address(struct elf_file* file, struct elf64_phdr* phdr);
+bool elf_phdr_covers_page(struct elf64_phdr* phdr, void* page);
+int elf_segment_page_read(struct elf_file* file, struct elf64_phdr* phdr, void* page, void* page_out);
+void* elf_image_page(struct elf_file* file, void* page);
+bool elf_page_writeable(struct elf_file* file, void* page);
 
 #endif
\ No newline at end of file
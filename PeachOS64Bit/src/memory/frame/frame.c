@@ -0,0 +1,517 @@
+/*
+ * PeachOS 64-Bit Kernel Project
+ * Copyright (C) 2026 Daniel McCarthy <daniel@dragonzap.com>
+ *
+ * This file is part of the PeachOS 64-Bit Kernel.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * For full source code, documentation, and structured learning,
+ * see the official kernel development course part one:
+ * https://dragonzap.com/course/developing-a-multithreaded-kernel-from-scratch
+ *
+ * Get part one and part two module one, module two all peachos courses (69 hours of content): https://dragonzap.com/offer/kernel-development-from-scratch-69-hours
+ *
+ * Get the part two course module one and two: https://dragonzap.com/offer/developing-a-multithreaded-kernel-from-scratch-part-two-full-series
+ */
+
+#include "frame.h"
+#include "memory/memory.h"
+#include "memory/paging/paging.h"
+#include "kernel.h"
+#include "status.h"
+
+static struct frame_zone frame_zones[PEACHOS_FRAME_MAX_ZONES];
+static size_t frame_total_zones = 0;
+static struct frame_cpu_cache frame_cpu_caches[PEACHOS_MAX_CPUS];
+static uintptr_t frame_highest_address = 0;
+static struct frame_zero_pool frame_zero_pool;
+
+static struct frame_cpu_cache* frame_cpu_cache()
+{
+    // Only the bootstrap processor runs kernel code
+    return &frame_cpu_caches[0];
+}
+
+static bool frame_bit_get(struct frame_zone* zone, size_t index)
+{
+    return zone->bitmap[index / 8] & (1 << (index % 8));
+}
+
+static void frame_bit_set(struct frame_zone* zone, size_t index, bool free)
+{
+    if (free)
+    {
+        zone->bitmap[index / 8] |= (1 << (index % 8));
+    }
+    else
+    {
+        zone->bitmap[index / 8] &= ~(1 << (index % 8));
+    }
+}
+
+static struct frame_block* frame_block_at(struct frame_zone* zone, size_t index)
+{
+    return (struct frame_block*)(zone->base + index * PAGING_PAGE_SIZE);
+}
+
+static size_t frame_block_index(struct frame_zone* zone, void* ptr)
+{
+    return ((uintptr_t) ptr - zone->base) / PAGING_PAGE_SIZE;
+}
+
+static void frame_list_push(struct frame_zone* zone, size_t index, int order)
+{
+    struct frame_block* block = frame_block_at(zone, index);
+    block->order = order;
+    block->prev = NULL;
+    block->next = zone->free_lists[order];
+    if (block->next)
+    {
+        block->next->prev = block;
+    }
+    zone->free_lists[order] = block;
+    frame_bit_set(zone, index, true);
+}
+
+static void frame_list_remove(struct frame_zone* zone, struct frame_block* block)
+{
+    if (block->prev)
+    {
+        block->prev->next = block->next;
+    }
+    else
+    {
+        zone->free_lists[block->order] = block->next;
+    }
+
+    if (block->next)
+    {
+        block->next->prev = block->prev;
+    }
+
+    frame_bit_set(zone, frame_block_index(zone, block), false);
+}
+
+static struct frame_zone* frame_zone_for_address(void* ptr)
+{
+    uintptr_t addr = (uintptr_t) ptr;
+    for (size_t i = 0; i < frame_total_zones; i++)
+    {
+        struct frame_zone* zone = &frame_zones[i];
+        if (addr >= zone->base && addr < zone->base + zone->total_pages * PAGING_PAGE_SIZE)
+        {
+            return zone;
+        }
+    }
+
+    return NULL;
+}
+
+static void frame_zone_free(struct frame_zone* zone, size_t index, int order)
+{
+    zone->free_pages += ((size_t) 1) << order;
+
+    // Merge with the buddy for as long as it is free and the same size
+    while (order < PEACHOS_FRAME_MAX_ORDER)
+    {
+        size_t buddy = index ^ (((size_t) 1) << order);
+        if (buddy + (((size_t) 1) << order) > zone->total_pages || !frame_bit_get(zone, buddy))
+        {
+            break;
+        }
+
+        struct frame_block* buddy_block = frame_block_at(zone, buddy);
+        if (buddy_block->order != order)
+        {
+            break;
+        }
+
+        frame_list_remove(zone, buddy_block);
+        index = MIN(index, buddy);
+        order++;
+    }
+
+    frame_list_push(zone, index, order);
+}
+
+static void* frame_zone_alloc(struct frame_zone* zone, int order)
+{
+    int current_order = order;
+    while (current_order <= PEACHOS_FRAME_MAX_ORDER && !zone->free_lists[current_order])
+    {
+        current_order++;
+    }
+
+    if (current_order > PEACHOS_FRAME_MAX_ORDER)
+    {
+        return NULL;
+    }
+
+    struct frame_block* block = zone->free_lists[current_order];
+    frame_list_remove(zone, block);
+    size_t index = frame_block_index(zone, block);
+
+    // Split, handing the upper halves back
+    while (current_order > order)
+    {
+        current_order--;
+        frame_list_push(zone, index + (((size_t) 1) << current_order), current_order);
+    }
+
+    zone->free_pages -= ((size_t) 1) << order;
+    return block;
+}
+
+static int frame_zone_add(uintptr_t base, uintptr_t end)
+{
+    base = (uintptr_t) paging_align_address((void*) base);
+    end = (uintptr_t) paging_align_to_lower_page((void*) end);
+    if (end <= base)
+    {
+        return 0;
+    }
+
+    if (frame_total_zones >= PEACHOS_FRAME_MAX_ZONES)
+    {
+        return -ENOMEM;
+    }
+
+    size_t total_pages = (end - base) / PAGING_PAGE_SIZE;
+    size_t bitmap_pages = paging_align_value_to_upper_page((total_pages + 7) / 8) / PAGING_PAGE_SIZE;
+    if (total_pages <= bitmap_pages)
+    {
+        return 0;
+    }
+
+    struct frame_zone* zone = &frame_zones[frame_total_zones];
+    memset(zone, 0, sizeof(struct frame_zone));
+    zone->bitmap = (uint8_t*) base;
+    zone->base = base + bitmap_pages * PAGING_PAGE_SIZE;
+    zone->total_pages = total_pages - bitmap_pages;
+    memset(zone->bitmap, 0, bitmap_pages * PAGING_PAGE_SIZE);
+    frame_total_zones++;
+
+    // Hand out the zone as the largest naturally aligned blocks that fit
+    size_t index = 0;
+    while (index < zone->total_pages)
+    {
+        int order = PEACHOS_FRAME_MAX_ORDER;
+        while (order > 0 &&
+              ((index & ((((size_t) 1) << order) - 1)) != 0 || index + (((size_t) 1) << order) > zone->total_pages))
+        {
+            order--;
+        }
+
+        frame_list_push(zone, index, order);
+        zone->free_pages += ((size_t) 1) << order;
+        index += ((size_t) 1) << order;
+    }
+
+    frame_highest_address = MAX(frame_highest_address, end);
+    return 0;
+}
+
+/**
+ * Adds the part of every usable e820 region between min and max
+ */
+static int frame_add_e820_range(uintptr_t min, uintptr_t max)
+{
+    int res = 0;
+    size_t total_entries = e820_total_entries();
+    for (size_t i = 0; i < total_entries; i++)
+    {
+        struct e820_entry* entry = e820_entry(i);
+        if (entry->type != 1)
+        {
+            continue;
+        }
+
+        uintptr_t base = MAX(entry->base_addr, min);
+        uintptr_t end = MIN(entry->base_addr + entry->length, max);
+        if (end <= base)
+        {
+            continue;
+        }
+
+        res = frame_zone_add(base, end);
+        if (res < 0)
+        {
+            break;
+        }
+    }
+
+    return res;
+}
+
+int frame_system_init()
+{
+    // Nothing below the minimal heap table address, the kernel and boot data live there
+    return frame_add_e820_range(PEACHOS_MINIMAL_HEAP_TABLE_ADDRESS, PEACHOS_BOOT_IDENTITY_MAP_END);
+}
+
+int frame_system_post_paging()
+{
+    return frame_add_e820_range(PEACHOS_BOOT_IDENTITY_MAP_END, UINTPTR_MAX);
+}
+
+static void* frame_buddy_alloc(int order)
+{
+    for (size_t i = 0; i < frame_total_zones; i++)
+    {
+        void* ptr = frame_zone_alloc(&frame_zones[i], order);
+        if (ptr)
+        {
+            return ptr;
+        }
+    }
+
+    return NULL;
+}
+
+static void frame_buddy_free(void* ptr, int order)
+{
+    struct frame_zone* zone = frame_zone_for_address(ptr);
+    if (!zone)
+    {
+        panic("frame_free: Address is not owned by the frame allocator\n");
+    }
+
+    frame_zone_free(zone, frame_block_index(zone, ptr), order);
+}
+
+static void frame_cpu_cache_drain(struct frame_cpu_cache* cache, size_t count)
+{
+    while (count-- > 0 && cache->total > 0)
+    {
+        frame_buddy_free(cache->pages[--cache->total], 0);
+    }
+}
+
+void* frame_alloc(int order)
+{
+    if (order < 0 || order > PEACHOS_FRAME_MAX_ORDER)
+    {
+        return NULL;
+    }
+
+    if (order != 0)
+    {
+        return frame_buddy_alloc(order);
+    }
+
+    struct frame_cpu_cache* cache = frame_cpu_cache();
+    if (cache->total == 0)
+    {
+        // Refill a batch at once
+        while (cache->total < PEACHOS_FRAME_CPU_CACHE_BATCH)
+        {
+            void* page = frame_buddy_alloc(0);
+            if (!page)
+            {
+                break;
+            }
+            cache->pages[cache->total++] = page;
+        }
+
+        if (cache->total == 0)
+        {
+            // Last resort, the zero pool pages are still free memory
+            if (frame_zero_pool.total > 0)
+            {
+                return frame_zero_pool.pages[--frame_zero_pool.total];
+            }
+            return NULL;
+        }
+    }
+
+    return cache->pages[--cache->total];
+}
+
+void* frame_zalloc(int order)
+{
+    if (order == 0 && frame_zero_pool.total > 0)
+    {
+        frame_zero_pool.hits++;
+        return frame_zero_pool.pages[--frame_zero_pool.total];
+    }
+
+    void* ptr = frame_alloc(order);
+    if (ptr)
+    {
+        if (order == 0)
+        {
+            frame_zero_pool.misses++;
+        }
+        memset(ptr, 0, frame_order_bytes(order));
+    }
+    return ptr;
+}
+
+size_t frame_zero_pool_refill(size_t max_pages)
+{
+    size_t total_added = 0;
+    while (total_added < max_pages && frame_zero_pool.total < PEACHOS_FRAME_ZERO_POOL_SIZE)
+    {
+        // Never take back a page from the pool itself
+        if (frame_free_pages() <= frame_zero_pool.total)
+        {
+            break;
+        }
+
+        void* page = frame_alloc(0);
+        if (!page)
+        {
+            break;
+        }
+
+        memset(page, 0, PAGING_PAGE_SIZE);
+        frame_zero_pool.pages[frame_zero_pool.total++] = page;
+        total_added++;
+    }
+
+    return total_added;
+}
+
+void frame_zero_pool_stats(struct frame_zero_pool_stats* stats_out)
+{
+    stats_out->depth = frame_zero_pool.total;
+    stats_out->capacity = PEACHOS_FRAME_ZERO_POOL_SIZE;
+    stats_out->hits = frame_zero_pool.hits;
+    stats_out->misses = frame_zero_pool.misses;
+}
+
+void frame_free(void* ptr, int order)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+    if (order != 0)
+    {
+        frame_buddy_free(ptr, order);
+        return;
+    }
+
+    frame_free_bulk(&ptr, 1);
+}
+
+static void frame_cpu_cache_push(void* page)
+{
+    struct frame_cpu_cache* cache = frame_cpu_cache();
+    if (cache->total == PEACHOS_FRAME_CPU_CACHE_SIZE)
+    {
+        frame_cpu_cache_drain(cache, PEACHOS_FRAME_CPU_CACHE_BATCH);
+    }
+    cache->pages[cache->total++] = page;
+}
+
+/**
+ * Frees total_pages contiguous pages starting at index as the largest
+ * aligned blocks that fit, so the run is merged without going page by page
+ */
+static void frame_zone_free_run(struct frame_zone* zone, size_t index, size_t total_pages)
+{
+    while (total_pages > 0)
+    {
+        int order = 0;
+        while (order < PEACHOS_FRAME_MAX_ORDER &&
+               (index & (((size_t) 1) << order)) == 0 &&
+               (((size_t) 2) << order) <= total_pages)
+        {
+            order++;
+        }
+
+        frame_zone_free(zone, index, order);
+        index += ((size_t) 1) << order;
+        total_pages -= ((size_t) 1) << order;
+    }
+}
+
+void frame_free_bulk(void** pages, size_t count)
+{
+    // Insertion sort by address, pages are usually freed close to in order
+    for (size_t i = 1; i < count; i++)
+    {
+        void* page = pages[i];
+        size_t j = i;
+        for (; j > 0 && (uintptr_t) pages[j - 1] > (uintptr_t) page; j--)
+        {
+            pages[j] = pages[j - 1];
+        }
+        pages[j] = page;
+    }
+
+    size_t i = 0;
+    while (i < count)
+    {
+        if (!pages[i])
+        {
+            i++;
+            continue;
+        }
+
+        // Find the run of pages that follow on from this one in the same zone
+        size_t run = 1;
+        while (i + run < count && pages[i + run] == pages[i] + run * PAGING_PAGE_SIZE)
+        {
+            run++;
+        }
+
+        struct frame_zone* zone = frame_zone_for_address(pages[i]);
+        if (run == 1 || !zone || pages[i + run - 1] >= (void*)(zone->base + zone->total_pages * PAGING_PAGE_SIZE))
+        {
+            // Single pages go through the processor cache
+            for (size_t k = 0; k < run; k++)
+            {
+                frame_cpu_cache_push(pages[i + k]);
+            }
+            i += run;
+            continue;
+        }
+
+        frame_zone_free_run(zone, frame_block_index(zone, pages[i]), run);
+        i += run;
+    }
+}
+
+int frame_order_for_size(size_t size)
+{
+    int order = 0;
+    while (frame_order_bytes(order) < size)
+    {
+        order++;
+    }
+    return order;
+}
+
+size_t frame_order_bytes(int order)
+{
+    return ((size_t) PAGING_PAGE_SIZE) << order;
+}
+
+size_t frame_free_pages()
+{
+    size_t total = frame_cpu_cache()->total + frame_zero_pool.total;
+    for (size_t i = 0; i < frame_total_zones; i++)
+    {
+        total += frame_zones[i].free_pages;
+    }
+    return total;
+}
+
+void* frame_memory_end()
+{
+    return (void*) frame_highest_address;
+}
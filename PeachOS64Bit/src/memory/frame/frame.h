@@ -0,0 +1,128 @@
+/*
+ * PeachOS 64-Bit Kernel Project
+ * Copyright (C) 2026 Daniel McCarthy <daniel@dragonzap.com>
+ *
+ * This file is part of the PeachOS 64-Bit Kernel.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * For full source code, documentation, and structured learning,
+ * see the official kernel development course part one:
+ * https://dragonzap.com/course/developing-a-multithreaded-kernel-from-scratch
+ *
+ * Get part one and part two module one, module two all peachos courses (69 hours of content): https://dragonzap.com/offer/kernel-development-from-scratch-69-hours
+ *
+ * Get the part two course module one and two: https://dragonzap.com/offer/developing-a-multithreaded-kernel-from-scratch-part-two-full-series
+ */
+
+#ifndef KERNEL_FRAME_H
+#define KERNEL_FRAME_H
+#include "config.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FRAME_TOTAL_ORDERS (PEACHOS_FRAME_MAX_ORDER + 1)
+
+/**
+ * Free blocks are linked through their own first page, the zone bitmap
+ * marks which pages start a free block so a buddy is only trusted when its bit is set
+ */
+struct frame_block
+{
+    struct frame_block* next;
+    struct frame_block* prev;
+    int order;
+};
+
+struct frame_zone
+{
+    // First page the zone hands out, the bitmap sits just before it
+    uintptr_t base;
+    size_t total_pages;
+    size_t free_pages;
+
+    // One bit per page, set when the page starts a free block
+    uint8_t* bitmap;
+
+    struct frame_block* free_lists[FRAME_TOTAL_ORDERS];
+};
+
+/**
+ * Order zero pages freed and allocated on a processor are kept here first so
+ * the common case never splits or merges buddies
+ */
+struct frame_cpu_cache
+{
+    void* pages[PEACHOS_FRAME_CPU_CACHE_SIZE];
+    size_t total;
+};
+
+/**
+ * Order zero pages that were zeroed while the processor had nothing else to do
+ */
+struct frame_zero_pool
+{
+    void* pages[PEACHOS_FRAME_ZERO_POOL_SIZE];
+    size_t total;
+
+    // Zeroed allocations served from the pool and those that had to memset
+    size_t hits;
+    size_t misses;
+};
+
+struct frame_zero_pool_stats
+{
+    size_t depth;
+    size_t capacity;
+    size_t hits;
+    size_t misses;
+};
+
+/**
+ * Builds the zones for usable memory inside the boot identity map, call before paging
+ */
+int frame_system_init();
+
+/**
+ * Adds usable memory above the boot identity map, call once the kernel page tables map it
+ */
+int frame_system_post_paging();
+
+void* frame_alloc(int order);
+void* frame_zalloc(int order);
+void frame_free(void* ptr, int order);
+
+/**
+ * Frees count order zero pages, the array is sorted by address in place.
+ * Runs of contiguous pages are given back to the buddy lists as whole blocks,
+ * pages on their own go through the processor cache
+ */
+void frame_free_bulk(void** pages, size_t count);
+
+/**
+ * Zeroes up to max_pages pages into the zero pool, returns how many were added
+ */
+size_t frame_zero_pool_refill(size_t max_pages);
+void frame_zero_pool_stats(struct frame_zero_pool_stats* stats_out);
+
+int frame_order_for_size(size_t size);
+size_t frame_order_bytes(int order);
+size_t frame_free_pages();
+
+/**
+ * The address after the highest page the frame allocator may hand out
+ */
+void* frame_memory_end();
+
+#endif
@@ -259,7 +259,7 @@ out:
     return address;
 }
 
-void heap_mark_blocks_free(struct heap *heap, int64_t starting_block)
+size_t heap_mark_blocks_free(struct heap *heap, int64_t starting_block)
 {
     struct heap_table *table = heap->table;
     size_t total_blocks_freed = 0;
@@ -282,6 +282,7 @@ void heap_mark_blocks_free(struct heap *heap, int64_t starting_block)
 
     heap->used_blocks -= total_blocks_freed;
     heap->free_blocks += total_blocks_freed;
+    return total_blocks_freed;
 }
 
 int64_t heap_address_to_block(struct heap *heap, void *address)
@@ -289,30 +290,52 @@ int64_t heap_address_to_block(struct heap *heap, void *address)
     return ((int64_t)(address - heap->saddr)) / PEACHOS_HEAP_BLOCK_SIZE;
 }
 
-void *heap_malloc(struct heap *heap, size_t size)
+/**
+ * Returns the size class for an allocation of total_blocks, see HEAP_STATS_TOTAL_SIZE_CLASSES
+ */
+int heap_size_class(size_t total_blocks)
 {
-    size_t aligned_size = heap_align_value_to_upper(size);
-    int64_t total_blocks = aligned_size / PEACHOS_HEAP_BLOCK_SIZE;
-    return heap_malloc_blocks(heap, total_blocks);
+    int size_class = 0;
+    size_t class_blocks = 1;
+    while (class_blocks < total_blocks && size_class < HEAP_STATS_TOTAL_SIZE_CLASSES - 1)
+    {
+        class_blocks <<= 1;
+        size_class++;
+    }
+
+    return size_class;
 }
 
-void* heap_realloc(struct heap* heap, void* old_ptr, size_t new_size)
+void *heap_malloc(struct heap *heap, size_t size)
 {
-    // NULL pointer then fresh allocation
-    if (!old_ptr)
-    {
-        return heap_malloc(heap, new_size);
-    }
+    size_t aligned_size = heap_align_value_to_upper(size);
+    int64_t total_blocks = aligned_size / PEACHOS_HEAP_BLOCK_SIZE;
+    void* ptr = heap_malloc_blocks(heap, total_blocks);
 
-    if (new_size == 0)
+    struct heap_size_class_stats* size_class_stats = &heap->stats.size_classes[heap_size_class(total_blocks)];
+    if (!ptr)
     {
-        heap_free(heap, old_ptr);
+        heap->stats.failed_allocations++;
+        size_class_stats->failed_allocations++;
         return NULL;
     }
 
+    heap->stats.allocations++;
+    heap->stats.bytes_requested += size;
+    heap->stats.peak_used_blocks = MAX(heap->stats.peak_used_blocks, heap->used_blocks);
+    size_class_stats->allocations++;
+    return ptr;
+}
+
+/**
+ * Resizes the allocation at ptr without moving it, returns false if the
+ * blocks following it are taken
+ */
+bool heap_resize_in_place(struct heap* heap, void* ptr, size_t new_size)
+{
     // Get the current allocations block count and starting block
-    size_t current_alloc_blocks = heap_allocation_block_count(heap, old_ptr);
-    int64_t starting_block = heap_address_to_block(heap, old_ptr);
+    size_t current_alloc_blocks = heap_allocation_block_count(heap, ptr);
+    int64_t starting_block = heap_address_to_block(heap, ptr);
     // Calculate ending block index
     int64_t ending_block = starting_block + current_alloc_blocks -1;
 
@@ -320,16 +343,14 @@ void* heap_realloc(struct heap* heap, void* old_ptr, size_t new_size)
     size_t new_size_aligned = heap_align_value_to_upper(new_size);
     // Determine how many blocks are needed for the new allocation
     size_t new_total_blocks = new_size_aligned / PEACHOS_HEAP_BLOCK_SIZE;
-    size_t old_total_size = current_alloc_blocks * PEACHOS_HEAP_BLOCK_SIZE;
 
     // Do we need to shrink the allocation
     if (current_alloc_blocks >= new_total_blocks)
     {
         // Is it the same requested size as the memory size?
-        // then return the old pointer
         if (current_alloc_blocks == new_total_blocks)
         {
-            return old_ptr;
+            return true;
         }
 
         int64_t block_to_free = starting_block + new_total_blocks;
@@ -340,50 +361,70 @@ void* heap_realloc(struct heap* heap, void* old_ptr, size_t new_size)
         {
             heap->table->entries[starting_block + new_total_blocks-1] &= ~HEAP_BLOCK_HAS_NEXT;
         }
-
-        // Adjust the counts
-        size_t freed_blocks = current_alloc_blocks - new_total_blocks;
-        heap->used_blocks -= freed_blocks;
-        heap->free_blocks += freed_blocks;
-        return old_ptr;
+        return true;
     }
 
     // Expand the allocation
     size_t extra_blocks = new_total_blocks - current_alloc_blocks;
     size_t extension_start = ending_block +1;
     size_t extension_end = extension_start + extra_blocks -1;
-    if(heap_is_block_range_free(heap, extension_start, extension_end))
+    if (extension_end >= heap->table->total || !heap_is_block_range_free(heap, extension_start, extension_end))
     {
-        // Mark all the extension blocks as taken
-        for(size_t i = extension_start; i < extension_end; i++)
-        {
-            heap->table->entries[i] = HEAP_BLOCK_TABLE_ENTRY_TAKEN | HEAP_BLOCK_HAS_NEXT;
-        }
+        return false;
+    }
+
+    // Mark all the extension blocks as taken
+    for(size_t i = extension_start; i < extension_end; i++)
+    {
+        heap->table->entries[i] = HEAP_BLOCK_TABLE_ENTRY_TAKEN | HEAP_BLOCK_HAS_NEXT;
+    }
 
-        // Mark the final block of the extension as taken
-        heap->table->entries[extension_end] = HEAP_BLOCK_TABLE_ENTRY_TAKEN;
-        // Ensure that the old ending block is marked with has next
-        heap->table->entries[ending_block] |= HEAP_BLOCK_HAS_NEXT;
+    // Mark the final block of the extension as taken
+    heap->table->entries[extension_end] = HEAP_BLOCK_TABLE_ENTRY_TAKEN;
+    // Ensure that the old ending block is marked with has next
+    heap->table->entries[ending_block] |= HEAP_BLOCK_HAS_NEXT;
 
-        // Adjust block counts.
-        heap->used_blocks += extra_blocks;
-        heap->free_blocks -= extra_blocks;
+    // Adjust block counts.
+    heap->used_blocks += extra_blocks;
+    heap->free_blocks -= extra_blocks;
+    heap->stats.peak_used_blocks = MAX(heap->stats.peak_used_blocks, heap->used_blocks);
+    return true;
+}
+
+void* heap_realloc(struct heap* heap, void* old_ptr, size_t new_size)
+{
+    // NULL pointer then fresh allocation
+    if (!old_ptr)
+    {
+        return heap_malloc(heap, new_size);
+    }
+
+    if (new_size == 0)
+    {
+        heap_free(heap, old_ptr);
+        return NULL;
+    }
+
+    size_t old_total_size = heap_allocation_block_count(heap, old_ptr) * PEACHOS_HEAP_BLOCK_SIZE;
+    if (heap_resize_in_place(heap, old_ptr, new_size))
+    {
         return old_ptr;
     }
 
     // We are unable to extend the allocation, due to additional mallocs
     // that have taken place, breaking the free block chain ahead of us
     // the final resort, is to copy all the memory into a new allocation
-
-    void* new_addr = heap_zalloc(heap, new_size_aligned);
+    size_t new_size_aligned = heap_align_value_to_upper(new_size);
+    void* new_addr = heap_malloc(heap, new_size_aligned);
     if(!new_addr)
     {
         // Out of memory
         return NULL;
     }
 
-    // Copy the old data into the new allocation
+    // Copy the old data into the new allocation, only the tail needs zeroing
     memcpy(new_addr, old_ptr, old_total_size);
+    memset(new_addr + old_total_size, 0x00, new_size_aligned - old_total_size);
 
     // Free the old pointer
     heap_free(heap, old_ptr);
@@ -392,7 +433,9 @@ void* heap_realloc(struct heap* heap, void* old_ptr, size_t new_size)
 
 void heap_free(struct heap *heap, void *ptr)
 {
-    heap_mark_blocks_free(heap, heap_address_to_block(heap, ptr));
+    size_t total_blocks = heap_mark_blocks_free(heap, heap_address_to_block(heap, ptr));
+    heap->stats.frees++;
+    heap->stats.size_classes[heap_size_class(total_blocks)].frees++;
 }
 
 size_t heap_total_size(struct heap *heap)
@@ -402,17 +445,35 @@ size_t heap_total_size(struct heap *heap)
 
 size_t heap_total_used(struct heap *heap)
 {
-    size_t total = 0;
-    struct heap_table *table = heap->table;
-    for (size_t i = 0; i < table->total; i++)
+    return heap->used_blocks * PEACHOS_HEAP_BLOCK_SIZE;
+}
+
+void heap_fragmentation_stats(struct heap* heap, struct heap_fragmentation_stats* stats_out)
+{
+    struct heap_table* table = heap->table;
+    size_t current_extent = 0;
+    memset(stats_out, 0, sizeof(struct heap_fragmentation_stats));
+    for (size_t i = 0; i <= table->total; i++)
     {
-        if (heap_get_entry_type(table->entries[i]) == HEAP_BLOCK_TABLE_ENTRY_TAKEN)
+        if (i < table->total && heap_get_entry_type(table->entries[i]) == HEAP_BLOCK_TABLE_ENTRY_FREE)
+        {
+            current_extent++;
+            continue;
+        }
+
+        // A run of free blocks just ended
+        if (current_extent)
         {
-            total += PEACHOS_HEAP_BLOCK_SIZE;
+            stats_out->total_free_extents++;
+            stats_out->largest_free_extent = MAX(stats_out->largest_free_extent, current_extent);
+            current_extent = 0;
         }
     }
 
-    return total;
+    if (heap->free_blocks)
+    {
+        stats_out->fragmentation_index = 100 - ((stats_out->largest_free_extent * 100) / heap->free_blocks);
+    }
 }
 
 size_t heap_total_available(struct heap *heap)
@@ -44,6 +44,43 @@ typedef unsigned char HEAP_BLOCK_TABLE_ENTRY;
 typedef void*(*HEAP_BLOCK_ALLOCATED_CALLBACK_FUNCTION)(void* ptr, size_t size);
 typedef void(*HEAP_BLOCK_FREE_CALLBACK_FUNCTION)(void* ptr);
 
+// Allocations are grouped by block count, 1, 2, 3-4, 5-8 ... the last class holds the rest
+#define HEAP_STATS_TOTAL_SIZE_CLASSES 8
+
+struct heap_size_class_stats
+{
+    size_t allocations;
+    size_t frees;
+    size_t failed_allocations;
+};
+
+struct heap_stats
+{
+    size_t allocations;
+    size_t frees;
+    size_t failed_allocations;
+
+    // Bytes requested by the callers, before rounding up to blocks
+    size_t bytes_requested;
+    // Most blocks that were in use at once
+    size_t peak_used_blocks;
+
+    struct heap_size_class_stats size_classes[HEAP_STATS_TOTAL_SIZE_CLASSES];
+};
+
+/**
+ * Calculated on request as they require a walk of the block table
+ */
+struct heap_fragmentation_stats
+{
+    // Largest run of free blocks
+    size_t largest_free_extent;
+    size_t total_free_extents;
+
+    // 0 when all free blocks are contiguous, approaching 100 as they scatter
+    size_t fragmentation_index;
+};
+
 struct heap_table
 {
     HEAP_BLOCK_TABLE_ENTRY* entries;
@@ -70,6 +107,8 @@ struct heap
 
     // Calback function for a when a block is freed.
     HEAP_BLOCK_FREE_CALLBACK_FUNCTION block_free_callback;
+
+    struct heap_stats stats;
 };
 
 void heap_callbacks_set(struct heap* heap, HEAP_BLOCK_ALLOCATED_CALLBACK_FUNCTION allocated_func, HEAP_BLOCK_FREE_CALLBACK_FUNCTION free_func);
@@ -91,6 +130,10 @@ uintptr_t heap_align_value_to_lower(uintptr_t val);
 
 bool heap_is_address_within_heap(struct heap* heap, void* ptr);
 void* heap_realloc(struct heap* heap, void* old_ptr, size_t new_size);
+bool heap_resize_in_place(struct heap* heap, void* ptr, size_t new_size);
+
+int heap_size_class(size_t total_blocks);
+void heap_fragmentation_stats(struct heap* heap, struct heap_fragmentation_stats* stats_out);
 
 
 #endif
\ No newline at end of file
@@ -29,30 +29,66 @@
 #include "heap.h"
 #include "config.h"
 #include "kernel.h"
+#include "status.h"
 #include "memory/memory.h"
 #include "memory/paging/paging.h"
 #include "multiheap.h"
+#include "memory/frame/frame.h"
 
 struct heap kernel_minimal_heap;
 struct heap_table kernel_minimal_heap_table;
 
 struct multiheap* kernel_multiheap = NULL;
 
-struct e820_entry* kheap_get_allowable_memory_region_for_minimal_heap()
+// Ring of the most recent kernel heap calls, only filled while tracing is enabled
+static struct kheap_trace_entry kheap_trace_ring[PEACHOS_KHEAP_TRACE_ENTRIES];
+static size_t kheap_trace_next = 0;
+static bool kheap_trace_is_enabled = false;
+
+/**
+ * Takes the largest block of page frames no bigger than max_order and no
+ * smaller than min_order, returns NULL if there is none
+ */
+static void* kheap_take_frames(int max_order, int min_order, size_t* size_out)
 {
-    struct e820_entry* entry = 0;
-    size_t total_entries = e820_total_entries();
-    for(size_t i = 0; i < total_entries; i++)
+    for (int order = max_order; order >= min_order; order--)
     {
-        struct e820_entry* current = e820_entry(i);
-        if (current->type == 1 && current->length > PEACHOS_HEAP_MINIMUM_SIZE_BYTES)
+        void* block = frame_alloc(order);
+        if (block)
         {
-            entry  = current;
-            break;
+            *size_out = frame_order_bytes(order);
+            return block;
         }
     }
 
-    return entry;
+    return NULL;
+}
+
+/**
+ * Called by the multiheap when no heap can satisfy an allocation of size bytes
+ */
+static int kheap_grow(struct multiheap* multiheap, size_t size)
+{
+    int res = 0;
+    size_t block_size = 0;
+    // Room for the allocation and its block table
+    int order = MAX(frame_order_for_size(size + size / PEACHOS_HEAP_BLOCK_SIZE), PEACHOS_KHEAP_GROW_ORDER);
+    void* block = kheap_take_frames(order, frame_order_for_size(size), &block_size);
+    if (!block)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
+    res = multiheap_add(multiheap, block, block + block_size, MULTIHEAP_HEAP_FLAG_DEFRAGMENT_WITH_PAGING);
+    if (res < 0)
+    {
+        frame_free(block, frame_order_for_size(block_size));
+        goto out;
+    }
+
+out:
+    return res;
 }
 
 /**
@@ -60,30 +96,99 @@ struct e820_entry* kheap_get_allowable_memory_region_for_minimal_heap()
  */
 void kheap_post_paging()
 {
-    multiheap_ready(kernel_multiheap);
+    // Memory past the boot identity map is reachable now
+    frame_system_post_paging();
+    multiheap_ready(kernel_multiheap, frame_memory_end());
 }
 
-void* krealloc(void* old_ptr, size_t new_size)
+static bool kheap_bytes_equal(uint8_t* ptr, uint8_t value, size_t len)
 {
-    return multiheap_realloc(kernel_multiheap, old_ptr, new_size);
+    for (size_t i = 0; i < len; i++)
+    {
+        if (ptr[i] != value)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int kheap_paging_realloc_check()
+{
+    int res = 0;
+    size_t block = PEACHOS_HEAP_BLOCK_SIZE;
+    uint8_t* ptr = multiheap_alloc_second_pass(kernel_multiheap, block * 2);
+    if (!ptr)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+    memset(ptr, 0xA5, block * 2);
+
+    // Nothing has used the paging heap yet, so the blocker lands straight after ptr
+    uint8_t* blocker = multiheap_alloc_second_pass(kernel_multiheap, block);
+    if (blocker != ptr + block * 2)
+    {
+        res = -EIO;
+        goto out;
+    }
+
+    // Shrinking releases the frames of the second block and keeps the first
+    uint8_t* new_ptr = krealloc(ptr, block);
+    if (new_ptr != ptr || !kheap_bytes_equal(ptr, 0xA5, block))
+    {
+        res = -EIO;
+        goto out;
+    }
+
+    // The second block is free again, growing maps a fresh zeroed frame in place
+    new_ptr = krealloc(ptr, block * 2);
+    if (new_ptr != ptr || !kheap_bytes_equal(ptr, 0xA5, block) || !kheap_bytes_equal(ptr + block, 0, block))
+    {
+        res = -EIO;
+        goto out;
+    }
+
+    // The blocker is in the way, the frames are remapped to a new range
+    new_ptr = krealloc(ptr, block * 3);
+    if (!new_ptr || new_ptr == ptr || !kheap_bytes_equal(new_ptr, 0xA5, block) || !kheap_bytes_equal(new_ptr + block * 2, 0, block))
+    {
+        res = -EIO;
+        goto out;
+    }
+    ptr = new_ptr;
+
+    // A size of zero frees the allocation
+    if (krealloc(ptr, 0) != NULL || krealloc(blocker, 0) != NULL)
+    {
+        res = -EIO;
+    }
+
+out:
+    return res;
 }
 
 void kheap_init()
 {
-    struct e820_entry* entry = kheap_get_allowable_memory_region_for_minimal_heap();
-    if (!entry)
+    if (e820_total_accessible_memory() < PEACHOS_HEAP_MINIMUM_SIZE_BYTES)
     {
         panic("Installed RAM does not meet the requirements for multiheap\n");
     }
 
-    void* address = (void*) entry->base_addr;
-    void* end_address = (void*) (entry->base_addr + entry->length);
-    void* heap_table_address = address;
-    if (heap_table_address < (void*) PEACHOS_MINIMAL_HEAP_TABLE_ADDRESS)
+    // The heap sits on top of the page frame allocator
+    frame_system_init();
+
+    size_t block_size = 0;
+    void* address = kheap_take_frames(PEACHOS_KHEAP_INITIAL_ORDER, PEACHOS_KHEAP_GROW_ORDER, &block_size);
+    if (!address)
     {
-        heap_table_address = (void*) PEACHOS_MINIMAL_HEAP_TABLE_ADDRESS;
+        panic("Not enough contiguous memory for the minimal heap\n");
     }
 
+    void* end_address = address + block_size;
+    void* heap_table_address = address;
+
     size_t total_heap_size = end_address - heap_table_address;
     size_t total_heap_blocks = total_heap_size / PEACHOS_HEAP_BLOCK_SIZE;
     size_t total_heap_entry_table_size = sizeof(HEAP_BLOCK_TABLE_ENTRY) * total_heap_blocks;
@@ -107,12 +212,6 @@ void kheap_init()
         heap_address = paging_align_address(heap_address);
     }
 
-    // Check if the heap end address is aligned
-    if (!paging_is_aligned(heap_end_address))
-    {
-        heap_end_address = paging_align_to_lower_page(heap_end_address);
-    }
-
     size_t size = heap_end_address - heap_address;
     size_t total_table_entries = size / PEACHOS_HEAP_BLOCK_SIZE;
     kernel_minimal_heap_table.entries = (HEAP_BLOCK_TABLE_ENTRY*)(heap_table_address);
@@ -127,60 +226,169 @@ void kheap_init()
     kernel_multiheap = multiheap_new(&kernel_minimal_heap);
     multiheap_add_existing_heap(kernel_multiheap, &kernel_minimal_heap, MULTIHEAP_HEAP_FLAG_EXTERNALLY_OWNED);
 
-    struct e820_entry* used_entry = entry;
+    // Further heaps are taken from the frame allocator as they are needed
+    kernel_multiheap->grow = kheap_grow;
+}
+
+static void kheap_trace_record(void* caller, void* ptr, size_t size)
+{
+    if (!kheap_trace_is_enabled || !ptr)
+    {
+        return;
+    }
+
+    struct kheap_trace_entry* entry = &kheap_trace_ring[kheap_trace_next % PEACHOS_KHEAP_TRACE_ENTRIES];
+    entry->caller = (uint64_t) caller;
+    entry->ptr = (uint64_t) ptr;
+    entry->size = size;
+    entry->flags = 0;
+    kheap_trace_next++;
+}
+
+/**
+ * Marks the newest traced allocation of ptr as freed
+ */
+static void kheap_trace_release(void* ptr)
+{
+    if (!kheap_trace_is_enabled || !ptr)
+    {
+        return;
+    }
+
+    size_t total = MIN(kheap_trace_next, PEACHOS_KHEAP_TRACE_ENTRIES);
+    for (size_t i = 1; i <= total; i++)
+    {
+        struct kheap_trace_entry* entry = &kheap_trace_ring[(kheap_trace_next - i) % PEACHOS_KHEAP_TRACE_ENTRIES];
+        if (entry->ptr == (uint64_t) ptr && !(entry->flags & KHEAP_TRACE_FLAG_FREED))
+        {
+            entry->flags |= KHEAP_TRACE_FLAG_FREED;
+            break;
+        }
+    }
+}
+
+void kheap_trace_enable(bool enabled)
+{
+    if (enabled && !kheap_trace_is_enabled)
+    {
+        // Start from an empty ring so stale entries are not reported as live
+        memset(kheap_trace_ring, 0, sizeof(kheap_trace_ring));
+        kheap_trace_next = 0;
+    }
+    kheap_trace_is_enabled = enabled;
+}
+
+bool kheap_trace_enabled()
+{
+    return kheap_trace_is_enabled;
+}
+
+/**
+ * Copies up to max_entries traced calls newest first, live_only skips
+ * allocations that have since been freed. Returns the total copied
+ */
+size_t kheap_trace_copy(struct kheap_trace_entry* entries_out, size_t max_entries, bool live_only)
+{
+    size_t copied = 0;
+    size_t total = MIN(kheap_trace_next, PEACHOS_KHEAP_TRACE_ENTRIES);
+    for (size_t i = 1; i <= total && copied < max_entries; i++)
+    {
+        struct kheap_trace_entry* entry = &kheap_trace_ring[(kheap_trace_next - i) % PEACHOS_KHEAP_TRACE_ENTRIES];
+        if (live_only && (entry->flags & KHEAP_TRACE_FLAG_FREED))
+        {
+            continue;
+        }
+
+        entries_out[copied++] = *entry;
+    }
+
+    return copied;
+}
+
+static void kheap_heap_stats(struct heap* heap, int flags, struct kheap_heap_stats* stats_out)
+{
+    struct heap_fragmentation_stats fragmentation_stats;
+    heap_fragmentation_stats(heap, &fragmentation_stats);
+
+    stats_out->start_address = (uint64_t) heap->saddr;
+    stats_out->end_address = (uint64_t) heap->eaddr;
+    stats_out->flags = flags;
+    stats_out->total_blocks = heap->total_blocks;
+    stats_out->used_blocks = heap->used_blocks;
+    stats_out->peak_used_blocks = heap->stats.peak_used_blocks;
+    stats_out->allocations = heap->stats.allocations;
+    stats_out->frees = heap->stats.frees;
+    stats_out->failed_allocations = heap->stats.failed_allocations;
+    stats_out->bytes_requested = heap->stats.bytes_requested;
+    stats_out->largest_free_extent = fragmentation_stats.largest_free_extent;
+    stats_out->total_free_extents = fragmentation_stats.total_free_extents;
+    stats_out->fragmentation_index = fragmentation_stats.fragmentation_index;
+}
+
+static void kheap_stats_add(struct kheap_stats* stats_out, struct heap* heap, int flags)
+{
+    if (stats_out->total_heaps < KHEAP_STATS_MAX_HEAPS)
+    {
+        kheap_heap_stats(heap, flags, &stats_out->heaps[stats_out->total_heaps]);
+    }
+    stats_out->total_heaps++;
+
+    for (int i = 0; i < HEAP_STATS_TOTAL_SIZE_CLASSES; i++)
+    {
+        stats_out->size_classes[i].allocations += heap->stats.size_classes[i].allocations;
+        stats_out->size_classes[i].frees += heap->stats.size_classes[i].frees;
+        stats_out->size_classes[i].failed_allocations += heap->stats.size_classes[i].failed_allocations;
+    }
+}
+
+/**
+ * Describes every heap of the kernel multiheap, paging heaps are listed
+ * straight after the heap whose blocks they share
+ */
+void kheap_stats(struct kheap_stats* stats_out)
+{
+    memset(stats_out, 0, sizeof(struct kheap_stats));
+    stats_out->block_size = PEACHOS_HEAP_BLOCK_SIZE;
+    stats_out->failed_allocations = kernel_multiheap->failed_allocations;
 
-    size_t total_entries = e820_total_entries();
-    for(size_t i = 0; i < total_entries; i++)
+    struct multiheap_single_heap* current = kernel_multiheap->first_multiheap;
+    while (current)
     {
-        struct e820_entry* current = e820_entry(i);
-        if (current != used_entry && current->type == 1)
+        kheap_stats_add(stats_out, current->heap, 0);
+        if (current->paging_heap)
         {
-            void* base_addr = (void*) current->base_addr;
-            void* end_addr = (void*) (current->base_addr + current->length);
-
-            // Enforce page alignment
-            if(!paging_is_aligned(base_addr))
-            {
-                base_addr = paging_align_address(base_addr);
-            }
-
-            if (!paging_is_aligned(end_addr))
-            {
-                end_addr = paging_align_to_lower_page(end_addr);
-            }
-
-            if (base_addr < (void*) PEACHOS_MINIMAL_HEAP_ADDRESS)
-            {
-                base_addr = (void*) PEACHOS_MINIMAL_HEAP_ADDRESS;
-            }
-
-            if (end_addr <= base_addr)
-            {
-                continue;
-            }
-
-            // Add the memory region to the multiheap
-            multiheap_add(kernel_multiheap, (void*) base_addr, (void*) end_addr, MULTIHEAP_HEAP_FLAG_DEFRAGMENT_WITH_PAGING);
+            kheap_stats_add(stats_out, current->paging_heap, KHEAP_STATS_HEAP_FLAG_PAGING);
         }
+        current = current->next;
     }
+
+    struct frame_zero_pool_stats zero_pool = {0};
+    frame_zero_pool_stats(&zero_pool);
+    stats_out->zero_pool.depth = zero_pool.depth;
+    stats_out->zero_pool.capacity = zero_pool.capacity;
+    stats_out->zero_pool.hits = zero_pool.hits;
+    stats_out->zero_pool.misses = zero_pool.misses;
 }
 
 void* kmalloc(size_t size)
 {
     void* ptr = multiheap_alloc(kernel_multiheap, size);
+    kheap_trace_record(__builtin_return_address(0), ptr, size);
     return ptr;
 }
+
 void* kzalloc(size_t size)
 {
-    void* ptr = kmalloc(size);
+    void* ptr = multiheap_alloc(kernel_multiheap, size);
     if (!ptr)
         return 0;
 
     memset(ptr, 0x00, size);
+    kheap_trace_record(__builtin_return_address(0), ptr, size);
     return ptr;
 }
 
-void* kpalloc(size_t size)
+static void* kheap_palloc(size_t size)
 {
     void* ptr = multiheap_palloc(kernel_multiheap, size);
     if (!ptr)
@@ -190,19 +398,35 @@ void* kpalloc(size_t size)
     return ptr;
 }
 
-void* kpzalloc(size_t size)
+void* kpalloc(size_t size)
 {
-    void* ptr = kpalloc(size);
-    if (!ptr)
-        return 0;
+    void* ptr = kheap_palloc(size);
+    kheap_trace_record(__builtin_return_address(0), ptr, size);
+    return ptr;
+}
 
+void* kpzalloc(size_t size)
+{
+    void* ptr = kheap_palloc(size);
     memset(ptr, 0x00, size);
+    kheap_trace_record(__builtin_return_address(0), ptr, size);
     return ptr;
 }
 
-
+void* krealloc(void* old_ptr, size_t new_size)
+{
+    void* new_ptr = multiheap_realloc(kernel_multiheap, old_ptr, new_size);
+    if (new_ptr || new_size == 0)
+    {
+        kheap_trace_release(old_ptr);
+        kheap_trace_record(__builtin_return_address(0), new_ptr, new_size);
+    }
+    return new_ptr;
+}
 
 void kfree(void* ptr)
 {
+    // The memory is not given back yet, tracing shows which callers do release it
+    kheap_trace_release(ptr);
     //heap_free(&kernel_heap, ptr);
-}
\ No newline at end of file
+}
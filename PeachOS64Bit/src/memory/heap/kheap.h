@@ -30,6 +30,95 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
+#include "heap.h"
+
+#define KHEAP_STATS_MAX_HEAPS 16
+
+enum
+{
+    // The heap hands out virtual ranges backed by page frames
+    KHEAP_STATS_HEAP_FLAG_PAGING = 0b00000001
+};
+
+/**
+ * The statistics structures are copied to userland as they are,
+ * every field is 64 bits so the layout is the same on both sides
+ */
+struct kheap_heap_stats
+{
+    uint64_t start_address;
+    uint64_t end_address;
+    uint64_t flags;
+
+    uint64_t total_blocks;
+    uint64_t used_blocks;
+    uint64_t peak_used_blocks;
+
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t failed_allocations;
+    uint64_t bytes_requested;
+
+    uint64_t largest_free_extent;
+    uint64_t total_free_extents;
+    uint64_t fragmentation_index;
+};
+
+struct kheap_size_class_stats
+{
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t failed_allocations;
+};
+
+struct kheap_stats
+{
+    uint64_t block_size;
+
+    // Can be more than KHEAP_STATS_MAX_HEAPS, only the first are described
+    uint64_t total_heaps;
+
+    // Allocations that no heap could satisfy, even after growing
+    uint64_t failed_allocations;
+
+    struct kheap_heap_stats heaps[KHEAP_STATS_MAX_HEAPS];
+
+    // Summed over every heap
+    struct kheap_size_class_stats size_classes[HEAP_STATS_TOTAL_SIZE_CLASSES];
+
+    // Pre-zeroed page frames waiting in the zero pool and how zeroed frame allocations were served
+    struct
+    {
+        uint64_t depth;
+        uint64_t capacity;
+        uint64_t hits;
+        uint64_t misses;
+    } zero_pool;
+};
+
+enum
+{
+    KHEAP_TRACE_FLAG_FREED = 0b00000001
+};
+
+// Flags for a userland trace request
+enum
+{
+    KHEAP_TRACE_REQUEST_ENABLE = 0b00000001,
+    KHEAP_TRACE_REQUEST_DISABLE = 0b00000010,
+    // Only report allocations that have not been freed
+    KHEAP_TRACE_REQUEST_LIVE_ONLY = 0b00000100
+};
+
+struct kheap_trace_entry
+{
+    // Return address of the kmalloc, kzalloc, kpalloc or krealloc call
+    uint64_t caller;
+    uint64_t ptr;
+    uint64_t size;
+    uint64_t flags;
+};
 
 void kheap_init();
 void* kmalloc(size_t size);
@@ -43,4 +132,16 @@ struct heap* kheap_get();
 
 void kheap_post_paging();
 
+/**
+ * Reallocates paging heap memory through the shrink, grow in place and remap
+ * paths and checks the data survives each of them
+ * \return Returns zero when every path behaved, -EIO otherwise
+ */
+int kheap_paging_realloc_check();
+
+void kheap_stats(struct kheap_stats* stats_out);
+void kheap_trace_enable(bool enabled);
+bool kheap_trace_enabled();
+size_t kheap_trace_copy(struct kheap_trace_entry* entries_out, size_t max_entries, bool live_only);
+
 #endif
\ No newline at end of file
@@ -28,6 +28,8 @@
 #include "multiheap.h"
 #include "kernel.h"
 #include "memory/paging/paging.h"
+#include "memory/frame/frame.h"
+#include "memory/memory.h"
 #include "status.h"
 #include <stdbool.h>
 #include <stdint.h>
@@ -158,6 +160,99 @@ void multiheap_get_heap_and_paging_heap_for_address(struct multiheap* multiheap,
     *real_phys_addr = real_addr;
 }
 
+void* multiheap_alloc_paging(struct multiheap* multiheap, size_t size, struct multiheap_single_heap** eligible_heap_out);
+
+/**
+ * Maps fresh zeroed page frames behind the blocks from start_block to end_block
+ * of a paging heap allocation at ptr
+ */
+static int multiheap_paging_map_new_frames(void* ptr, size_t start_block, size_t end_block)
+{
+    for (size_t i = start_block; i < end_block; i++)
+    {
+        void* frame = frame_zalloc(0);
+        if (!frame)
+        {
+            return -ENOMEM;
+        }
+
+        paging_map(kernel_desc(), ptr + (i * PEACHOS_HEAP_BLOCK_SIZE), frame, PAGING_IS_WRITEABLE | PAGING_IS_PRESENT);
+    }
+
+    return 0;
+}
+
+static void multiheap_paging_free_frames(void* ptr, size_t start_block, size_t end_block)
+{
+    for (size_t i = start_block; i < end_block; i++)
+    {
+        void* virtual_address_for_block = ptr + (i * PEACHOS_HEAP_BLOCK_SIZE);
+        frame_free(paging_get_physical_address(kernel_desc(), virtual_address_for_block), 0);
+    }
+}
+
+/**
+ * Resizes an allocation made in a paging heap, the data is never copied.
+ * Growing maps new frames after the allocation when the virtual blocks are free,
+ * otherwise the existing frames are remapped into a new virtual range.
+ */
+static void* multiheap_paging_realloc(struct multiheap* multiheap, struct multiheap_single_heap* paging_heap, void* old_ptr, size_t new_size)
+{
+    if (new_size == 0)
+    {
+        // Same as heap_realloc, a size of zero frees the allocation
+        multiheap_free(multiheap, old_ptr);
+        return NULL;
+    }
+
+    struct heap* heap = paging_heap->paging_heap;
+    size_t old_blocks = heap_allocation_block_count(heap, old_ptr);
+    size_t new_blocks = heap_align_value_to_upper(new_size) / PEACHOS_HEAP_BLOCK_SIZE;
+    if (new_blocks <= old_blocks)
+    {
+        // The frames must be released before the blocks unmap them
+        multiheap_paging_free_frames(old_ptr, new_blocks, old_blocks);
+        heap_resize_in_place(heap, old_ptr, new_size);
+        return old_ptr;
+    }
+
+    if (frame_free_pages() < new_blocks - old_blocks)
+    {
+        return NULL;
+    }
+
+    if (heap_resize_in_place(heap, old_ptr, new_size))
+    {
+        if (multiheap_paging_map_new_frames(old_ptr, old_blocks, new_blocks) < 0)
+        {
+            panic("multiheap_paging_realloc: Ran out of frames that were available\n");
+        }
+        return old_ptr;
+    }
+
+    // Move by remapping the frames into a larger virtual range
+    void* new_ptr = multiheap_alloc_paging(multiheap, new_size, NULL);
+    if (!new_ptr)
+    {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < old_blocks; i++)
+    {
+        void* frame = paging_get_physical_address(kernel_desc(), old_ptr + (i * PEACHOS_HEAP_BLOCK_SIZE));
+        paging_map(kernel_desc(), new_ptr + (i * PEACHOS_HEAP_BLOCK_SIZE), frame, PAGING_IS_WRITEABLE | PAGING_IS_PRESENT);
+    }
+
+    if (multiheap_paging_map_new_frames(new_ptr, old_blocks, new_blocks) < 0)
+    {
+        panic("multiheap_paging_realloc: Ran out of frames that were available\n");
+    }
+
+    // Releasing the old range only unmaps it, the frames now live at new_ptr
+    heap_free(heap, old_ptr);
+    return new_ptr;
+}
+
 void* multiheap_realloc(struct multiheap* multiheap, void* old_ptr, size_t new_size)
 {
     struct multiheap_single_heap* paging_heap = NULL;
@@ -168,7 +263,7 @@ void* multiheap_realloc(struct multiheap* multiheap, void* old_ptr, size_t new_s
 
     if (paging_heap)
     {
-        panic("Reallocation not yet supported for virtual addresses whose address differs from physical address\n");
+        return multiheap_paging_realloc(multiheap, paging_heap, old_ptr, new_size);
     }
 
     heap_to_use = phys_heap;
@@ -178,7 +273,23 @@ void* multiheap_realloc(struct multiheap* multiheap, void* old_ptr, size_t new_s
         return multiheap_alloc(multiheap, new_size);
     }
 
-    return heap_realloc(heap_to_use->heap, old_ptr, new_size);
+    void* new_ptr = heap_realloc(heap_to_use->heap, old_ptr, new_size);
+    if (new_ptr || new_size == 0)
+    {
+        return new_ptr;
+    }
+
+    // No room in its own heap, try the others
+    size_t old_size = heap_allocation_block_count(heap_to_use->heap, old_ptr) * PEACHOS_HEAP_BLOCK_SIZE;
+    new_ptr = multiheap_alloc(multiheap, new_size);
+    if (!new_ptr)
+    {
+        return NULL;
+    }
+
+    memcpy(new_ptr, old_ptr, MIN(old_size, new_size));
+    multiheap_free(multiheap, old_ptr);
+    return new_ptr;
 }
 
 size_t multiheap_allocation_block_count(struct multiheap* multiheap, void* ptr)
@@ -209,11 +320,13 @@ size_t multiheap_allocation_byte_count(struct multiheap* multiheap, void* ptr)
     return multiheap_allocation_block_count(multiheap, ptr) * PEACHOS_HEAP_BLOCK_SIZE;
 }
 
+static int multiheap_paging_heap_create(struct multiheap* multiheap, struct multiheap_single_heap* single_heap);
+
 int multiheap_add_heap(struct multiheap* multiheap, struct heap* heap, int flags)
 {
-    // Don't allow heaps to be added if the multi-heap has been marked
-    // as ready.
-    if (!multiheap_can_add_heap(multiheap))
+    // Once ready a heap can only be added if its memory is below the
+    // virtual paging heaps, otherwise the two would overlap
+    if (!multiheap_can_add_heap(multiheap) && heap->eaddr > multiheap->max_end_data_addr)
     {
         return -EINVARG;
     }
@@ -237,6 +350,10 @@ int multiheap_add_heap(struct multiheap* multiheap, struct heap* heap, int flags
     }
 
     multiheap->total_heaps += 1;
+    if (multiheap_is_ready(multiheap) && multiheap_heap_allows_paging(new_heap))
+    {
+        return multiheap_paging_heap_create(multiheap, new_heap);
+    }
     return 0;
 }
 
@@ -255,6 +372,15 @@ int multiheap_add(struct multiheap *multiheap, void *saddr, void *eaddr, int fla
         return -ENOMEM;
     }
 
+    table->total = (eaddr - saddr) / PEACHOS_HEAP_BLOCK_SIZE;
+    table->entries = heap_zalloc(multiheap->starting_heap, table->total * sizeof(HEAP_BLOCK_TABLE_ENTRY));
+    if (!table->entries)
+    {
+        heap_free(multiheap->starting_heap, heap);
+        heap_free(multiheap->starting_heap, table);
+        return -ENOMEM;
+    }
+
     int res = heap_create(heap, saddr, eaddr, table);
     if (res < 0)
     {
@@ -277,15 +403,13 @@ void multiheap_free(struct multiheap* multiheap, void* ptr)
     if (paging_heap)
     {
         size_t total_blocks = heap_allocation_block_count(paging_heap->paging_heap, ptr);
-        size_t starting_block = heap_address_to_block(paging_heap->paging_heap, ptr);
-        size_t ending_block = starting_block+total_blocks;
-        for(size_t i = starting_block; i < ending_block; i++)
+        for(size_t i = 0; i < total_blocks; i++)
         {
             void* virtual_address_for_block = (void*)((uintptr_t) ptr) + (i * PEACHOS_HEAP_BLOCK_SIZE);
-            void* data_phys_addr = paging_get_physical_address(paging_current_descriptor(), virtual_address_for_block);
+            void* data_phys_addr = paging_get_physical_address(kernel_desc(), virtual_address_for_block);
 
-            // We have the physical address now we can call multiheap_free again
-            multiheap_free(multiheap, data_phys_addr);
+            // The blocks behind a paging allocation are page frames
+            frame_free(data_phys_addr, 0);
         }
 
 
@@ -346,7 +470,8 @@ void* multiheap_alloc_paging(struct multiheap* multiheap, size_t size, struct mu
             continue;
         }
 
-        if (current->heap->free_blocks < total_required_blocks)
+        // The paging heap only provides the virtual range, the blocks are page frames
+        if (frame_free_pages() < total_required_blocks)
         {
             current = current->next;
             continue;
@@ -370,7 +495,7 @@ void* multiheap_alloc_paging(struct multiheap* multiheap, size_t size, struct mu
 void* multiheap_alloc_second_pass(struct multiheap* multiheap, size_t size)
 {
     void* allocation_ptr = NULL;
-    struct paging_desc* paging_desc = paging_current_descriptor();
+    struct paging_desc* paging_desc = kernel_desc();
     if (!paging_desc)
     {
         panic("You must setup paging before defragmentation processes can occur\n");
@@ -392,10 +517,10 @@ void* multiheap_alloc_second_pass(struct multiheap* multiheap, size_t size)
 
     for (size_t i = 0; i < total_blocks; i++)
     {
-        void* block_addr = heap_zalloc(chosen_real_heap->heap, PEACHOS_HEAP_BLOCK_SIZE);
+        void* block_addr = frame_zalloc(0);
         if (!block_addr)
         {
-            panic("Something went wrong, is there not enough bytes in physical heap but there is in paging heap, this mus ta bug");
+            panic("Something went wrong, is there not enough page frames but there was before the allocation, this must be a bug");
         }
 
         paging_map(paging_desc, defragmented_virtual_memory_current_addr, block_addr, PAGING_IS_WRITEABLE | PAGING_IS_PRESENT);
@@ -411,20 +536,63 @@ out:
  */
 void multiheap_paging_heap_free_block(void* ptr)
 {
-    paging_map(paging_current_descriptor(), ptr, NULL, 0);
+    paging_map(kernel_desc(), ptr, NULL, 0);
+}
+static int multiheap_paging_heap_create(struct multiheap* multiheap, struct multiheap_single_heap* single_heap)
+{
+    int res = 0;
+    void* max_end_addr = multiheap->max_end_data_addr;
+    void *paging_heap_starting_address = max_end_addr + (uint64_t) single_heap->heap->saddr;
+    void* paging_heap_ending_address = max_end_addr + (uint64_t) single_heap->heap->eaddr;
+
+    struct heap_table* paging_heap_table = heap_zalloc(multiheap->starting_heap, sizeof(struct heap_table));
+    struct heap* paging_heap = heap_zalloc(multiheap->starting_heap, sizeof(struct heap));
+    if (!paging_heap_table || !paging_heap)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
+    paging_heap_table->entries = heap_zalloc(multiheap->starting_heap, single_heap->heap->table->total * sizeof(HEAP_BLOCK_TABLE_ENTRY));
+    if (!paging_heap_table->entries)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+    paging_heap_table->total = single_heap->heap->table->total;
+
+    res = heap_create(paging_heap, paging_heap_starting_address, paging_heap_ending_address, paging_heap_table);
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    paging_map_to(kernel_desc(), paging_heap_starting_address, paging_heap_starting_address, paging_heap_ending_address, 0);
+
+    heap_callbacks_set(paging_heap, NULL, multiheap_paging_heap_free_block);
+    single_heap->paging_heap = paging_heap;
+out:
+    return res;
 }
-int multiheap_ready(struct multiheap* multiheap)
+
+int multiheap_ready(struct multiheap* multiheap, void* max_physical_addr)
 {
     int res = 0;
     multiheap->flags |= MULTIHEAP_FLAG_IS_READY;
 
-    struct paging_desc* paging_desc = paging_current_descriptor();
+    struct paging_desc* paging_desc = kernel_desc();
     if (!paging_desc)
     {
         panic("You must've had paging setup at this point for this to work\n");
     }
 
+    // The paging heaps live above all physical memory, including memory
+    // that may become a heap later on
     void* max_end_addr = multiheap_get_max_memory_end_address(multiheap);
+    if (max_physical_addr > max_end_addr)
+    {
+        max_end_addr = max_physical_addr;
+    }
     multiheap->max_end_data_addr = max_end_addr;
 
     struct multiheap_single_heap* current = multiheap->first_multiheap;
@@ -432,20 +600,11 @@ int multiheap_ready(struct multiheap* multiheap)
     {
         if (multiheap_heap_allows_paging(current))
         {
-            void *paging_heap_starting_address = max_end_addr + (uint64_t) current->heap->saddr;
-            void* paging_heap_ending_address = max_end_addr + (uint64_t) current->heap->eaddr;
-
-            struct heap_table* paging_heap_table = heap_zalloc(multiheap->starting_heap, sizeof(struct heap_table));
-            paging_heap_table->entries = heap_zalloc(multiheap->starting_heap, current->heap->table->total * sizeof(HEAP_BLOCK_TABLE_ENTRY));
-            paging_heap_table->total = current->heap->table->total;
-
-            struct heap* paging_heap = heap_zalloc(multiheap->starting_heap, sizeof(struct heap));
-            heap_create(paging_heap, paging_heap_starting_address, paging_heap_ending_address, paging_heap_table);
-
-            paging_map_to(paging_current_descriptor(), paging_heap_starting_address, paging_heap_starting_address, paging_heap_ending_address, 0);
-
-            heap_callbacks_set(paging_heap, NULL, multiheap_paging_heap_free_block);
-            current->paging_heap = paging_heap;
+            res = multiheap_paging_heap_create(multiheap, current);
+            if (res < 0)
+            {
+                goto out;
+            }
         }
         current = current->next; 
     }
@@ -453,6 +612,22 @@ int multiheap_ready(struct multiheap* multiheap)
 out:
     return res;
 }
+
+static void* multiheap_alloc_grow(struct multiheap* multiheap, size_t size)
+{
+    if (!multiheap->grow)
+    {
+        return NULL;
+    }
+
+    if (multiheap->grow(multiheap, size) < 0)
+    {
+        return NULL;
+    }
+
+    return multiheap_alloc_first_pass(multiheap, size);
+}
+
 void* multiheap_alloc(struct multiheap* multiheap, size_t size)
 {
     void* allocation_ptr = multiheap_alloc_first_pass(multiheap, size);
@@ -462,7 +637,12 @@ void* multiheap_alloc(struct multiheap* multiheap, size_t size)
     }
 
     // Normal alloc does not defragment with paging
-    return NULL;
+    allocation_ptr = multiheap_alloc_grow(multiheap, size);
+    if (!allocation_ptr)
+    {
+        multiheap->failed_allocations++;
+    }
+    return allocation_ptr;
 }
 
 void* multiheap_palloc(struct multiheap* multiheap, size_t size)
@@ -473,10 +653,20 @@ void* multiheap_palloc(struct multiheap* multiheap, size_t size)
         return allocation_ptr;
     }
 
+    allocation_ptr = multiheap_alloc_grow(multiheap, size);
+    if (allocation_ptr)
+    {
+        return allocation_ptr;
+    }
+
     // Possible fragmentation, no pointer able to be found
     // in all heaps.
     // perform second pass..
 
     allocation_ptr = multiheap_alloc_second_pass(multiheap, size);
+    if (!allocation_ptr)
+    {
+        multiheap->failed_allocations++;
+    }
     return allocation_ptr;
 }
\ No newline at end of file
@@ -50,6 +50,11 @@ enum
     MULTIHEAP_FLAG_IS_READY = 0x01
 };
 
+struct multiheap;
+
+// Asked to add memory to the multiheap when an allocation of size bytes cannot be satisfied
+typedef int (*MULTIHEAP_GROW_FUNCTION)(struct multiheap* multiheap, size_t size);
+
 struct multiheap
 {
     // This heap is used to allocate space for the multiheap.
@@ -61,9 +66,14 @@ struct multiheap
     void* max_end_data_addr;
     int flags;
     size_t total_heaps;
+
+    // Allocations that failed in every heap
+    size_t failed_allocations;
+
+    MULTIHEAP_GROW_FUNCTION grow;
 };
 
-int multiheap_ready(struct multiheap* multiheap);
+int multiheap_ready(struct multiheap* multiheap, void* max_physical_addr);
 size_t multiheap_allocation_byte_count(struct multiheap* multiheap, void* ptr);
 size_t multiheap_allocation_block_count(struct multiheap* multiheap, void* ptr);
 bool multiheap_can_add_heap(struct multiheap* multiheap);
@@ -76,6 +86,11 @@ int multiheap_add_existing_heap(struct multiheap* multiheap, struct heap* heap,
 int multiheap_add(struct multiheap* multiheap, void* saddr, void* eaddr, int flags);
 void* multiheap_alloc(struct multiheap* multiheap, size_t size);
 void* multiheap_palloc(struct multiheap* multiheap, size_t size);
+
+/**
+ * Allocates from a paging heap, the blocks are backed by page frames that need not be contiguous
+ */
+void* multiheap_alloc_second_pass(struct multiheap* multiheap, size_t size);
 struct multiheap* multiheap_new(struct heap* starting_heap);
 void multiheap_free(struct multiheap* multiheap, void* ptr);
 void multiheap_free_heap(struct multiheap* multiheap);
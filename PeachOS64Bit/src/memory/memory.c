@@ -126,4 +126,32 @@ void* memcpy(void* dest, void* src, int len)
         *d++ = *s++;
     }
     return dest;
-}
\ No newline at end of file
+}
+
+void* memmove(void* dest, void* src, size_t len)
+{
+    char* d = dest;
+    char* s = src;
+    if (d == s || len == 0)
+    {
+        return dest;
+    }
+
+    if (d < s)
+    {
+        while(len--)
+        {
+            *d++ = *s++;
+        }
+        return dest;
+    }
+
+    // Overlapping with the destination after the source, copy backwards
+    d += len;
+    s += len;
+    while(len--)
+    {
+        *--d = *--s;
+    }
+    return dest;
+}
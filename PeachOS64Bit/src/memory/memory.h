@@ -47,5 +47,6 @@ struct e820_entry* e820_entry(size_t index);
 void* memset(void* ptr, int c, size_t size);
 int memcmp(void* s1, void* s2, int count);
 void* memcpy(void* dest, void* src, int len);
+void* memmove(void* dest, void* src, size_t len);
 
 #endif
\ No newline at end of file
@@ -29,6 +29,13 @@ section .asm
 
 global paging_load_directory
 global paging_invalidate_tlb_entry
+global paging_fault_address
+global paging_pat_write
+global paging_load_cr3
+global paging_cr4_get
+global paging_cr4_set
+global paging_cr0_get
+global paging_cr0_set
 
 ; void paging_load_directory(uintptr_t* directory)
 paging_load_directory:
@@ -36,7 +43,50 @@ paging_load_directory:
     mov cr3, rax  ; LOad the page tables PML4 into CR3
     ret
 
+; void paging_load_cr3(uint64_t cr3)
+paging_load_cr3:
+    mov cr3, rdi  ; PML4 address, PCID and the no flush bit
+    ret
+
+; uint64_t paging_cr4_get()
+paging_cr4_get:
+    mov rax, cr4
+    ret
+
+; void paging_cr4_set(uint64_t cr4)
+paging_cr4_set:
+    mov cr4, rdi
+    ret
+
+; uint64_t paging_cr0_get()
+paging_cr0_get:
+    mov rax, cr0
+    ret
+
+; void paging_cr0_set(uint64_t cr0)
+paging_cr0_set:
+    mov cr0, rdi
+    ret
+
 ; void paging_invalidate_tlb_entry(void* addr)
 paging_invalidate_tlb_entry:
     invlpg [rdi]
-    ret
\ No newline at end of file
+    ret
+
+; void* paging_fault_address()
+paging_fault_address:
+    mov rax, cr2  ; CR2 holds the address that caused the last page fault
+    ret
+
+; void paging_pat_write(uint32_t msr, uint64_t pat)
+paging_pat_write:
+    mov ecx, edi  ; IA32_PAT, PAGING_PAT_MSR
+    mov rax, rsi  ; Low 32 bits of the PAT
+    mov rdx, rsi
+    shr rdx, 32   ; High 32 bits of the PAT
+    wrmsr
+    ; Anything cached under the old memory types must go
+    wbinvd
+    mov rax, cr3
+    mov cr3, rax
+    ret
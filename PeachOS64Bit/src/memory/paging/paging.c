@@ -31,9 +31,50 @@
 #include "memory/heap/heap.h"
 #include "status.h"
 #include "kernel.h"
+#include "memory/frame/frame.h"
+#include "io/cpuid.h"
+#include "config.h"
 
 
 static struct paging_desc* current_paging_desc = 0;
+
+// True once the PAT has been programmed with a write combining entry
+static bool paging_pat_enabled = false;
+
+// PCIDs in use, one bit each
+static bool paging_pcid_enabled = false;
+static uint8_t paging_pcid_bitmap[PAGING_TOTAL_PCIDS / 8];
+static uint16_t paging_pcid_next = 1;
+
+static uint16_t paging_pcid_alloc()
+{
+    if (!paging_pcid_enabled)
+    {
+        return 0;
+    }
+
+    for (size_t i = 0; i < PAGING_TOTAL_PCIDS - 1; i++)
+    {
+        uint16_t pcid = paging_pcid_next;
+        paging_pcid_next = (paging_pcid_next % (PAGING_TOTAL_PCIDS - 1)) + 1;
+        if (!(paging_pcid_bitmap[pcid / 8] & (1 << (pcid % 8))))
+        {
+            paging_pcid_bitmap[pcid / 8] |= (1 << (pcid % 8));
+            return pcid;
+        }
+    }
+
+    // All taken, share zero which is flushed on every load
+    return 0;
+}
+
+static void paging_pcid_free(uint16_t pcid)
+{
+    if (pcid != 0)
+    {
+        paging_pcid_bitmap[pcid / 8] &= ~(1 << (pcid % 8));
+    }
+}
 static bool paging_null_entry(struct paging_desc_entry* entry)
 {
     struct paging_desc_entry null_desc = {0};
@@ -43,14 +84,13 @@ static bool paging_null_entry(struct paging_desc_entry* entry)
 
 struct paging_pml_entries* paging_pml4_entries_new()
 {
-    struct paging_pml_entries* entries_desc = 
-        kzalloc(sizeof(struct paging_pml_entries));
+    struct paging_pml_entries* entries_desc = frame_zalloc(0);
     return entries_desc;
 }
 
 void paging_desc_entry_free(struct paging_desc_entry* table_entry, paging_map_level_t level)
 {
-    if(paging_null_entry(table_entry))
+    if (!table_entry)
     {
         return;
     }
@@ -67,51 +107,75 @@ void paging_desc_entry_free(struct paging_desc_entry* table_entry, paging_map_le
 
     if (level > 1)
     {
-        // Loop through the child tables
+        // Loop through the child tables, borrowed ones belong to someone else
         for(int i = 0; i < PAGING_TOTAL_ENTRIES_PER_TABLE; i++)
         {
             struct paging_desc_entry* entry = &table_entry[i];
-            if (!paging_null_entry(entry))
+            if (!paging_null_entry(entry) && !entry->shared)
             {
                 struct paging_desc_entry* child_entry = 
                     (struct paging_desc_entry*)((uint64_t)(entry->address) << 12);
-                if (child_entry)
-                {
-                    paging_desc_entry_free(child_entry, level-1);
-                }
+                paging_desc_entry_free(child_entry, level-1);
             }
         }
     }
 
-    kfree(table_entry);
+    frame_free(table_entry, 0);
 }
 void paging_desc_free(struct paging_desc* desc)
 {
     paging_map_level_t level = desc->level;
-    // loop through all entires and free
+    // loop through all entires and free, only the private ones are walked
     for(int i = 0; i < PAGING_TOTAL_ENTRIES_PER_TABLE; i++)
     {
         // Free all the root entries PML4 | 5
         struct paging_desc_entry* entry = &desc->pml->entries[i];
-        if(!paging_null_entry(entry))
+        if(!paging_null_entry(entry) && !entry->shared)
         {
             struct paging_desc_entry* child_entry = 
                         (struct paging_desc_entry*)((uint64_t)(entry->address) << 12);
-            if (child_entry)
-            {
-                // MInusone so the level goes down once.
-                paging_desc_entry_free(child_entry, level-1);
-            }
+            // MInusone so the level goes down once.
+            paging_desc_entry_free(child_entry, level-1);
         }
     }
 
     // Free the pml structure
-    kfree(desc->pml);
+    frame_free(desc->pml, 0);
+    paging_pcid_free(desc->pcid);
+
+    if (current_paging_desc == desc)
+    {
+        current_paging_desc = NULL;
+    }
 
     // Free the descriptor
     kfree(desc);
 }
 
+/**
+ * Points every root entry of desc at the tables of source, nothing is copied
+ * until desc maps something over them. Changes source makes afterwards are seen by desc.
+ */
+int paging_desc_share(struct paging_desc* desc, struct paging_desc* source)
+{
+    for (int i = 0; i < PAGING_TOTAL_ENTRIES_PER_TABLE; i++)
+    {
+        struct paging_desc_entry* entry = &source->pml->entries[i];
+        if (paging_null_entry(entry) || !paging_null_entry(&desc->pml->entries[i]))
+        {
+            continue;
+        }
+
+        desc->pml->entries[i] = *entry;
+        desc->pml->entries[i].shared = 1;
+    }
+
+    desc->shared_from = source;
+    desc->shared_generation = source->shared_generation;
+    desc->flush_needed = true;
+    return 0;
+}
+
 static bool paging_map_level_is_valid(paging_map_level_t level)
 {
     // Map level 5 isnt supported at the moment..
@@ -142,8 +206,33 @@ void* paging_align_to_lower_page(void* addr)
 
 void paging_switch(struct paging_desc* desc)
 {
+    uint64_t cr3 = (uint64_t)(uintptr_t)(&desc->pml->entries[0]);
+    if (desc->shared_from && desc->shared_generation != desc->shared_from->shared_generation)
+    {
+        // The lender changed an entry we may have cached under our pcid
+        desc->shared_generation = desc->shared_from->shared_generation;
+        desc->flush_needed = true;
+    }
+
+    if (paging_pcid_enabled)
+    {
+        if (desc == current_paging_desc && !desc->flush_needed)
+        {
+            // Already loaded and nothing went stale
+            return;
+        }
+
+        cr3 |= desc->pcid;
+        // Entries tagged with the pcid are still valid, keep them
+        if (desc->pcid != 0 && !desc->flush_needed)
+        {
+            cr3 |= PAGING_CR3_NO_FLUSH;
+        }
+    }
+
+    desc->flush_needed = false;
     current_paging_desc = desc;
-    paging_load_directory((uint64_t*)(&desc->pml->entries[0]));
+    paging_load_cr3(cr3);
 }
 
 struct paging_desc* paging_desc_new(paging_map_level_t root_map_level)
@@ -163,6 +252,10 @@ struct paging_desc* paging_desc_new(paging_map_level_t root_map_level)
 
     desc->pml = paging_pml4_entries_new();
     desc->level = root_map_level;
+
+    // The pcid may have been used before, flush whatever it left behind
+    desc->pcid = paging_pcid_alloc();
+    desc->flush_needed = true;
     return desc;
 }
 
@@ -172,6 +265,58 @@ bool paging_is_aligned(void* addr)
 }
 
 
+/**
+ * Returns the table an upper level entry points at, ready to be written to.
+ * A missing table is allocated and a table borrowed from another descriptor is
+ * copied first, the copy keeps borrowing the tables below it.
+ */
+static struct paging_desc_entry* paging_table_private(struct paging_desc_entry* entry, bool children_are_tables)
+{
+    struct paging_desc_entry* table = (struct paging_desc_entry*)((uintptr_t)(entry->address) << 12);
+    if (paging_null_entry(entry))
+    {
+        table = frame_zalloc(0);
+        if (!table)
+        {
+            return NULL;
+        }
+
+        entry->address = ((uintptr_t) table) >> 12;
+        entry->present = 1;
+        entry->read_write = 1;
+        entry->user_supervisor = 1;
+        return table;
+    }
+
+    if (!entry->shared)
+    {
+        return table;
+    }
+
+    struct paging_desc_entry* copy = frame_alloc(0);
+    if (!copy)
+    {
+        return NULL;
+    }
+
+    memcpy(copy, table, PAGING_PAGE_SIZE);
+    if (children_are_tables)
+    {
+        for (int i = 0; i < PAGING_TOTAL_ENTRIES_PER_TABLE; i++)
+        {
+            if (!paging_null_entry(&copy[i]))
+            {
+                copy[i].shared = 1;
+            }
+        }
+    }
+
+    // Same translations as before so nothing needs invalidating
+    entry->address = ((uintptr_t) copy) >> 12;
+    entry->shared = 0;
+    return copy;
+}
+
 int paging_map(struct paging_desc* desc, void* virt, void* phys, int flags)
 {
     int res = 0;
@@ -191,68 +336,174 @@ int paging_map(struct paging_desc* desc, void* virt, void* phys, int flags)
 
     struct paging_desc_entry* pml4_entry 
         = &desc->pml->entries[pml4_index];
-    
-    if (paging_null_entry(pml4_entry))
+    struct paging_desc_entry* pdpt_entries = paging_table_private(pml4_entry, true);
+    if (!pdpt_entries)
     {
-        // Allocate a PDPT
-        void* new_pdpt = kzalloc(
-                sizeof(struct paging_desc_entry) * PAGING_TOTAL_ENTRIES_PER_TABLE
-        );
-
-        pml4_entry->address = ((uintptr_t) new_pdpt) >> 12;
-        pml4_entry->present = 1;
-        pml4_entry->read_write = 1;
-        pml4_entry->user_supervisor = 1;
+        res = -ENOMEM;
+        goto out;
     }
 
-    struct paging_desc_entry* pdpt_entries 
-            = (struct paging_desc_entry*)((uintptr_t)(pml4_entry->address) << 12);
-
     struct paging_desc_entry* pdpt_entry = &pdpt_entries[pdpt_index];
-    if (paging_null_entry(pdpt_entry))
+    struct paging_desc_entry* pd_entries = paging_table_private(pdpt_entry, true);
+    if (!pd_entries)
     {
-        void* new_pd = kzalloc(sizeof(struct paging_desc_entry) * PAGING_TOTAL_ENTRIES_PER_TABLE);
-        pdpt_entry->address = ((uintptr_t) new_pd) >> 12;
-        pdpt_entry->present = 1;
-        pdpt_entry->read_write = 1;
-        pdpt_entry->user_supervisor = 1;
+        res = -ENOMEM;
+        goto out;
     }
 
-    struct paging_desc_entry* pd_entries = 
-        (struct paging_desc_entry*)((uintptr_t) (pdpt_entry->address) << 12);
-    
     // pd entry
     struct paging_desc_entry* pd_entry = &pd_entries[pd_index];
-    if (paging_null_entry(pd_entry))
+    struct paging_desc_entry* pt_entries = paging_table_private(pd_entry, false);
+    if (!pt_entries)
     {
-        void* new_pt = 
-            kzalloc(sizeof(struct paging_desc_entry) * PAGING_TOTAL_ENTRIES_PER_TABLE);
-        pd_entry->address = ((uintptr_t) new_pt) >> 12;
-        pd_entry->present = 1;
-        pd_entry->read_write = 1;
-        pd_entry->user_supervisor = 1;
+        res = -ENOMEM;
+        goto out;
     }
 
-    struct paging_desc_entry* pt_entries = 
-        (struct paging_desc_entry*)((uintptr_t)(pd_entry->address) << 12);
-    
     // Final page
     struct paging_desc_entry* pt_entry = &pt_entries[pt_index];
     if (!paging_null_entry(pt_entry))
     {
-        // Invalidate the cache.
-        paging_invalidate_tlb_entry(virt);
+        // Only the loaded descriptor can be invalidated by address, others
+        // are flushed the next time they are loaded
+        if (desc == current_paging_desc)
+        {
+            paging_invalidate_tlb_entry(virt);
+        }
+        else
+        {
+            desc->flush_needed = true;
+        }
+
+        // Descriptors borrowing our tables may have cached it too
+        desc->shared_generation++;
+    }
+    if ((flags & PAGING_PAT) && !paging_pat_enabled)
+    {
+        // Without the PAT we cannot write combine, the closest safe type is uncacheable
+        flags = (flags & ~PAGING_PAT) | PAGING_CACHE_UNCACHEABLE;
     }
+
     pt_entry->address = ((uintptr_t) phys) >> 12;
     pt_entry->present = (flags & PAGING_IS_PRESENT) ? 1 : 0;
     pt_entry->read_write = (flags & PAGING_IS_WRITEABLE) ? 1 : 0;
     pt_entry->user_supervisor = (flags & PAGING_ACCESS_FROM_ALL) ? 1 : 0;
+    pt_entry->pwt = (flags & PAGING_WRITE_THROUGH) ? 1 : 0;
+    pt_entry->pcd = (flags & PAGING_CACHE_DISABLED) ? 1 : 0;
+    pt_entry->pat = (flags & PAGING_PAT) ? 1 : 0;
+    pt_entry->global = (flags & PAGING_GLOBAL) ? 1 : 0;
+out:
+    return res;
+}
+
+/**
+ * Programs the PAT so the PAT, PCD and PWT bits of a page table entry select
+ *   PA0 WB   (none)          PA4 WC (PAT)
+ *   PA1 WT   (PWT)           PA5 WP (PAT|PWT)
+ *   PA2 UC-  (PCD)           PA6 UC- (PAT|PCD)
+ *   PA3 UC   (PCD|PWT)       PA7 UC (PAT|PCD|PWT)
+ * PA0-PA3 match the power on defaults so existing mappings keep their type.
+ */
+int paging_pat_init()
+{
+    int res = 0;
+    uint32_t eax, ebx, ecx, edx;
+    cpuid(1, 0, &eax, &ebx, &ecx, &edx);
+    if (!(edx & (1 << 16)))
+    {
+        // No PAT on this processor
+        res = -EUNIMP;
+        goto out;
+    }
+
+    uint64_t pat = 
+        ((uint64_t) PAGING_PAT_TYPE_WB) |
+        ((uint64_t) PAGING_PAT_TYPE_WT << 8) |
+        ((uint64_t) PAGING_PAT_TYPE_UC_MINUS << 16) |
+        ((uint64_t) PAGING_PAT_TYPE_UC << 24) |
+        ((uint64_t) PAGING_PAT_TYPE_WC << 32) |
+        ((uint64_t) PAGING_PAT_TYPE_WP << 40) |
+        ((uint64_t) PAGING_PAT_TYPE_UC_MINUS << 48) |
+        ((uint64_t) PAGING_PAT_TYPE_UC << 56);
+
+    paging_pat_write(PAGING_PAT_MSR, pat);
+    paging_pat_enabled = true;
+out:
+    return res;
+}
+
+/**
+ * Makes the kernel honour read only pages, a kernel write through the page tables
+ * of a task to a shared elf page then faults and is copied like a user write
+ */
+void paging_write_protect_init()
+{
+    paging_cr0_set(paging_cr0_get() | PAGING_CR0_WP);
+}
+
+/**
+ * Enables global pages and PCIDs when the processor has them. Call once the
+ * kernel descriptor is loaded, it is given the first pcid.
+ */
+int paging_tlb_init()
+{
+    uint32_t eax, ebx, ecx, edx;
+    cpuid(1, 0, &eax, &ebx, &ecx, &edx);
+
+    uint64_t cr4 = paging_cr4_get();
+    if (edx & (1 << 13))
+    {
+        cr4 |= PAGING_CR4_PGE;
+    }
+
+    // CR3 must have a pcid of zero when PCIDE is set, it does as we never set one
+    if (ecx & (1 << 17))
+    {
+        cr4 |= PAGING_CR4_PCIDE;
+        paging_pcid_enabled = true;
+    }
+    paging_cr4_set(cr4);
+
+    if (paging_pcid_enabled && current_paging_desc)
+    {
+        current_paging_desc->pcid = paging_pcid_alloc();
+        current_paging_desc->flush_needed = true;
+        paging_switch(current_paging_desc);
+    }
+
+    return 0;
+}
+
+/**
+ * Everything identity mapped below the lowest user address is the same in
+ * every address space, those entries are global and survive a CR3 load
+ */
+static int paging_map_identity(struct paging_desc* desc, void* base_addr, void* end_addr)
+{
+    int res = 0;
+    void* global_end = (void*) (PEACHOS_PROGRAM_VIRTUAL_STACK_ADDRESS_END);
+    if (base_addr < global_end)
+    {
+        void* split = end_addr < global_end ? end_addr : global_end;
+        res = paging_map_to(desc, base_addr, base_addr, split, PAGING_IS_WRITEABLE | PAGING_IS_PRESENT | PAGING_GLOBAL);
+        if (res < 0)
+        {
+            goto out;
+        }
+        base_addr = split;
+    }
+
+    if (base_addr < end_addr)
+    {
+        res = paging_map_to(desc, base_addr, base_addr, end_addr, PAGING_IS_WRITEABLE | PAGING_IS_PRESENT);
+    }
+out:
     return res;
 }
 
 int paging_map_e820_memory_regions(struct paging_desc* desc)
 {
-    paging_map_to(desc, (void*) 0x00, (void*) 0x00, (void*) 0x100000, PAGING_IS_WRITEABLE | PAGING_IS_PRESENT);
+    paging_map_identity(desc, (void*) 0x00, (void*) 0x100000);
     
     size_t total_entries = e820_total_entries();
     for(size_t i = 0; i < total_entries; i++ )
@@ -274,7 +525,7 @@ int paging_map_e820_memory_regions(struct paging_desc* desc)
                 end_addr = paging_align_to_lower_page(end_addr);
             }
 
-            paging_map_to(desc, base_addr, base_addr, end_addr, PAGING_IS_WRITEABLE | PAGING_IS_PRESENT);
+            paging_map_identity(desc, base_addr, end_addr);
 
         }
     }
@@ -355,11 +606,6 @@ struct paging_desc_entry* paging_get(struct paging_desc* desc, void* virt)
 
     struct paging_desc_entry* pdpt_entries 
         = (struct paging_desc_entry*)(((uint64_t)(pml4_entry->address)) << 12);
-    
-    if (paging_null_entry(pdpt_entries))
-    {
-        return NULL;
-    }
 
     // 2) PDPT Entry
     struct paging_desc_entry* pdpt_entry = &pdpt_entries[pdpt_index];
@@ -370,11 +616,6 @@ struct paging_desc_entry* paging_get(struct paging_desc* desc, void* virt)
 
     struct paging_desc_entry* pd_entries = 
         (struct paging_desc_entry*)(((uint64_t)(pdpt_entry->address)) << 12);
-    
-    if (paging_null_entry(pd_entries))
-    {
-        return NULL;
-    }
 
     // 3) PD Entry
     struct paging_desc_entry* pd_entry = &pd_entries[pd_index];
@@ -385,10 +626,6 @@ struct paging_desc_entry* paging_get(struct paging_desc* desc, void* virt)
 
     struct paging_desc_entry* pt_entries = 
             (struct paging_desc_entry*)((uint64_t)(pd_entry->address) << 12);
-    if (paging_null_entry(pd_entries))
-    {
-        return NULL;
-    }
 
     // 4) PT Entry
     struct paging_desc_entry* pt_entry = &pt_entries[pt_index];
@@ -39,6 +39,8 @@ enum
 };
 typedef uint8_t paging_map_level_t;
 
+#define PAGING_GLOBAL          0b100000000
+#define PAGING_PAT             0b10000000
 #define PAGING_CACHE_DISABLED  0b00010000
 #define PAGING_WRITE_THROUGH   0b00001000
 #define PAGING_ACCESS_FROM_ALL 0b00000100
@@ -46,6 +48,30 @@ typedef uint8_t paging_map_level_t;
 #define PAGING_IS_PRESENT      0b00000001
 
 
+// Memory types selected through the PAT, see paging_pat_init for the table
+#define PAGING_CACHE_WRITE_BACK      0
+#define PAGING_CACHE_WRITE_THROUGH   PAGING_WRITE_THROUGH
+#define PAGING_CACHE_UNCACHEABLE     (PAGING_CACHE_DISABLED | PAGING_WRITE_THROUGH)
+#define PAGING_CACHE_WRITE_COMBINING PAGING_PAT
+
+// IA32_PAT MSR, one byte per entry PA0-PA7
+#define PAGING_PAT_MSR 0x277
+#define PAGING_PAT_TYPE_UC  0x00
+#define PAGING_PAT_TYPE_WC  0x01
+#define PAGING_PAT_TYPE_WT  0x04
+#define PAGING_PAT_TYPE_WP  0x05
+#define PAGING_PAT_TYPE_WB  0x06
+#define PAGING_PAT_TYPE_UC_MINUS 0x07
+
+// Process context identifiers, zero is shared by descriptors that could not get one
+#define PAGING_TOTAL_PCIDS 4096
+#define PAGING_CR3_NO_FLUSH (1ULL << 63)
+#define PAGING_CR4_PGE   (1 << 7)
+#define PAGING_CR4_PCIDE (1 << 17)
+
+// Supervisor writes to read only pages fault too, copy on write depends on it
+#define PAGING_CR0_WP (1 << 16)
+
 #define PAGING_TOTAL_ENTRIES_PER_TABLE 512
 
 // 4K pages.
@@ -79,8 +105,10 @@ struct paging_desc_entry
     uint64_t pcd : 1;             // Bit 4: PCD
     uint64_t accessed : 1;        // Bit 5: Accessed
     uint64_t ignored : 1;         // Bit 6: Ignored
-    uint64_t reserved0 : 1;       // Bit 7: Must be 0 in PML4E
-    uint64_t reserved1 : 4;       // Bits 8:11: Reserved must be 0
+    uint64_t pat : 1;             // Bit 7: PAT in a page table entry, must be 0 in PML4E
+    uint64_t global : 1;          // Bit 8: Global in a page table entry, must be 0 in PML4E
+    uint64_t shared : 1;          // Bit 9: Available, set when the table pointed at is borrowed
+    uint64_t reserved1 : 2;       // Bits 10:11: Available
     uint64_t address   : 40;      // Bits 12-51: PDPT Base address
     uint64_t available : 11;      // Bits 52-62 Available to software
     uint64_t execute_disable : 1; // Bit 63: XD
@@ -98,6 +126,20 @@ struct paging_desc
 
     // Indiciates weather the pml is level 4 or 5 or a future level.
     paging_map_level_t level;
+
+    // TLB entries of this descriptor are tagged with the pcid
+    uint16_t pcid;
+
+    // Set when an entry changed while the descriptor was not loaded, the
+    // next load must flush its TLB entries
+    bool flush_needed;
+
+    // The descriptor whose tables we borrow, see paging_desc_share
+    struct paging_desc* shared_from;
+
+    // Bumped whenever an existing entry changes, borrowers compare it
+    // against the value they last saw to know when to flush
+    uint64_t shared_generation;
 } __attribute__((packed));
 
 void* paging_get_physical_address(struct paging_desc* desc, void* virtual_address);
@@ -112,9 +154,20 @@ int paging_map(struct paging_desc* desc, void* virt, void* phys, int flags);
 void* paging_align_to_lower_page(void* addr);
 void* paging_align_address(void* ptr);
 struct paging_desc* paging_desc_new(paging_map_level_t root_map_level);
+int paging_desc_share(struct paging_desc* desc, struct paging_desc* source);
 
 void paging_load_directory(uintptr_t* directory);
 void paging_invalidate_tlb_entry(void* addr);
+void* paging_fault_address();
+void paging_pat_write(uint32_t msr, uint64_t pat);
+void paging_load_cr3(uint64_t cr3);
+uint64_t paging_cr4_get();
+void paging_cr4_set(uint64_t cr4);
+uint64_t paging_cr0_get();
+void paging_cr0_set(uint64_t cr0);
+int paging_tlb_init();
+void paging_write_protect_init();
+int paging_pat_init();
 void paging_switch(struct paging_desc* desc);
 
 void paging_desc_free(struct paging_desc* desc);
@@ -0,0 +1,380 @@
+/*
+ * PeachOS 64-Bit Kernel Project
+ * Copyright (C) 2026 Daniel McCarthy <daniel@dragonzap.com>
+ *
+ * This file is part of the PeachOS 64-Bit Kernel.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * For full source code, documentation, and structured learning,
+ * see the official kernel development course part one:
+ * https://dragonzap.com/course/developing-a-multithreaded-kernel-from-scratch
+ *
+ * Get part one and part two module one, module two all peachos courses (69 hours of content): https://dragonzap.com/offer/kernel-development-from-scratch-69-hours
+ *
+ * Get the part two course module one and two: https://dragonzap.com/offer/developing-a-multithreaded-kernel-from-scratch-part-two-full-series
+ */
+
+#include "vma.h"
+#include "memory/heap/kheap.h"
+#include "memory/paging/paging.h"
+#include "kernel.h"
+#include "status.h"
+
+struct vma_tree* vma_tree_new(uintptr_t min, uintptr_t max)
+{
+    struct vma_tree* tree = kzalloc(sizeof(struct vma_tree));
+    if (!tree)
+    {
+        return NULL;
+    }
+
+    tree->min = min;
+    tree->max = max;
+    tree->hint = min;
+    return tree;
+}
+
+static void vma_node_free(struct vma_node* node)
+{
+    if (!node)
+    {
+        return;
+    }
+
+    vma_node_free(node->left);
+    vma_node_free(node->right);
+    kfree(node);
+}
+
+void vma_tree_free(struct vma_tree* tree)
+{
+    if (!tree)
+    {
+        return;
+    }
+
+    vma_node_free(tree->root);
+    kfree(tree);
+}
+
+static int vma_node_height(struct vma_node* node)
+{
+    return node ? node->height : 0;
+}
+
+static void vma_node_update(struct vma_node* node)
+{
+    node->height = MAX(vma_node_height(node->left), vma_node_height(node->right)) + 1;
+}
+
+static struct vma_node* vma_rotate_right(struct vma_node* node)
+{
+    struct vma_node* left = node->left;
+    node->left = left->right;
+    left->right = node;
+    vma_node_update(node);
+    vma_node_update(left);
+    return left;
+}
+
+static struct vma_node* vma_rotate_left(struct vma_node* node)
+{
+    struct vma_node* right = node->right;
+    node->right = right->left;
+    right->left = node;
+    vma_node_update(node);
+    vma_node_update(right);
+    return right;
+}
+
+static struct vma_node* vma_balance(struct vma_node* node)
+{
+    vma_node_update(node);
+    int balance = vma_node_height(node->left) - vma_node_height(node->right);
+    if (balance > 1)
+    {
+        if (vma_node_height(node->left->left) < vma_node_height(node->left->right))
+        {
+            node->left = vma_rotate_left(node->left);
+        }
+        return vma_rotate_right(node);
+    }
+
+    if (balance < -1)
+    {
+        if (vma_node_height(node->right->right) < vma_node_height(node->right->left))
+        {
+            node->right = vma_rotate_right(node->right);
+        }
+        return vma_rotate_left(node);
+    }
+
+    return node;
+}
+
+static struct vma_node* vma_node_insert(struct vma_node* root, struct vma_node* node)
+{
+    if (!root)
+    {
+        return node;
+    }
+
+    if (node->region.start < root->region.start)
+    {
+        root->left = vma_node_insert(root->left, node);
+    }
+    else
+    {
+        root->right = vma_node_insert(root->right, node);
+    }
+
+    return vma_balance(root);
+}
+
+static struct vma_node* vma_node_remove_min(struct vma_node* root, struct vma_node** min_out)
+{
+    if (!root->left)
+    {
+        *min_out = root;
+        return root->right;
+    }
+
+    root->left = vma_node_remove_min(root->left, min_out);
+    return vma_balance(root);
+}
+
+static struct vma_node* vma_node_remove(struct vma_node* root, uintptr_t start, struct vma_node** removed_out)
+{
+    if (!root)
+    {
+        return NULL;
+    }
+
+    if (start < root->region.start)
+    {
+        root->left = vma_node_remove(root->left, start, removed_out);
+    }
+    else if (start > root->region.start)
+    {
+        root->right = vma_node_remove(root->right, start, removed_out);
+    }
+    else
+    {
+        *removed_out = root;
+        if (!root->right)
+        {
+            return root->left;
+        }
+
+        // Replace the node with its successor
+        struct vma_node* successor = NULL;
+        struct vma_node* right = vma_node_remove_min(root->right, &successor);
+        successor->right = right;
+        successor->left = root->left;
+        return vma_balance(successor);
+    }
+
+    return vma_balance(root);
+}
+
+/**
+ * Returns the lowest region overlapping start to end, or NULL if the range is free
+ */
+static struct vma_node* vma_overlap(struct vma_tree* tree, uintptr_t start, uintptr_t end)
+{
+    struct vma_node* found = NULL;
+    struct vma_node* node = tree->root;
+    while (node)
+    {
+        if (node->region.end <= start)
+        {
+            node = node->right;
+        }
+        else if (node->region.start >= end)
+        {
+            node = node->left;
+        }
+        else
+        {
+            // Overlaps, keep looking left for a lower one
+            found = node;
+            node = node->left;
+        }
+    }
+
+    return found;
+}
+
+static int vma_insert(struct vma_tree* tree, uintptr_t start, uintptr_t end, size_t size, int type, struct vma_region** region_out)
+{
+    struct vma_node* node = kzalloc(sizeof(struct vma_node));
+    if (!node)
+    {
+        return -ENOMEM;
+    }
+
+    node->region.start = start;
+    node->region.end = end;
+    node->region.size = size;
+    node->region.type = type;
+    node->height = 1;
+    tree->root = vma_node_insert(tree->root, node);
+    tree->total_regions++;
+    if (region_out)
+    {
+        *region_out = &node->region;
+    }
+    return 0;
+}
+
+int vma_reserve_fixed(struct vma_tree* tree, uintptr_t start, size_t size, int type, struct vma_region** region_out)
+{
+    uintptr_t aligned_start = (uintptr_t) paging_align_to_lower_page((void*) start);
+    uintptr_t end = (uintptr_t) paging_align_address((void*)(start + size));
+    if (size == 0 || end <= aligned_start)
+    {
+        return -EINVARG;
+    }
+
+    if (vma_overlap(tree, aligned_start, end))
+    {
+        return -EINVARG;
+    }
+
+    return vma_insert(tree, aligned_start, end, size, type, region_out);
+}
+
+static int vma_search(struct vma_tree* tree, uintptr_t from, uintptr_t to, size_t length, uintptr_t* start_out)
+{
+    uintptr_t start = from;
+    while (start + length <= to && start + length > start)
+    {
+        struct vma_node* overlap = vma_overlap(tree, start, start + length);
+        if (!overlap)
+        {
+            *start_out = start;
+            return 0;
+        }
+
+        // Skip past the region in the way
+        start = overlap->region.end;
+    }
+
+    return -ENOMEM;
+}
+
+int vma_reserve(struct vma_tree* tree, size_t size, int type, struct vma_region** region_out)
+{
+    int res = 0;
+    uintptr_t start = 0;
+    size_t length = paging_align_value_to_upper_page(size);
+    if (size == 0)
+    {
+        res = -EINVARG;
+        goto out;
+    }
+
+    // Next fit from the hint, then wrap around once to the bottom
+    res = vma_search(tree, tree->hint, tree->max, length, &start);
+    if (res < 0)
+    {
+        res = vma_search(tree, tree->min, tree->max, length, &start);
+        if (res < 0)
+        {
+            goto out;
+        }
+    }
+
+    res = vma_insert(tree, start, start + length, size, type, region_out);
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    tree->hint = start + length;
+out:
+    return res;
+}
+
+int vma_release(struct vma_tree* tree, uintptr_t start)
+{
+    struct vma_node* removed = NULL;
+    tree->root = vma_node_remove(tree->root, start, &removed);
+    if (!removed)
+    {
+        return -ENOTFOUND;
+    }
+
+    // Let the next reservation reuse the range if it was the lower one
+    if (removed->region.start >= tree->min && removed->region.start < tree->hint)
+    {
+        tree->hint = removed->region.start;
+    }
+
+    tree->total_regions--;
+    kfree(removed);
+    return 0;
+}
+
+struct vma_region* vma_find(struct vma_tree* tree, uintptr_t addr)
+{
+    struct vma_node* node = tree->root;
+    while (node)
+    {
+        if (addr < node->region.start)
+        {
+            node = node->left;
+        }
+        else if (addr >= node->region.end)
+        {
+            node = node->right;
+        }
+        else
+        {
+            return &node->region;
+        }
+    }
+
+    return NULL;
+}
+
+static int vma_node_walk(struct vma_node* node, VMA_REGION_ITERATOR iterator, void* private)
+{
+    int res = 0;
+    if (!node)
+    {
+        goto out;
+    }
+
+    res = vma_node_walk(node->left, iterator, private);
+    if (res != 0)
+    {
+        goto out;
+    }
+
+    res = iterator(&node->region, private);
+    if (res != 0)
+    {
+        goto out;
+    }
+
+    res = vma_node_walk(node->right, iterator, private);
+out:
+    return res;
+}
+
+int vma_walk(struct vma_tree* tree, VMA_REGION_ITERATOR iterator, void* private)
+{
+    return vma_node_walk(tree->root, iterator, private);
+}
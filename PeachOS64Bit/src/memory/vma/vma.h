@@ -0,0 +1,120 @@
+/*
+ * PeachOS 64-Bit Kernel Project
+ * Copyright (C) 2026 Daniel McCarthy <daniel@dragonzap.com>
+ *
+ * This file is part of the PeachOS 64-Bit Kernel.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ *
+ * For full source code, documentation, and structured learning,
+ * see the official kernel development course part one:
+ * https://dragonzap.com/course/developing-a-multithreaded-kernel-from-scratch
+ *
+ * Get part one and part two module one, module two all peachos courses (69 hours of content): https://dragonzap.com/offer/kernel-development-from-scratch-69-hours
+ *
+ * Get the part two course module one and two: https://dragonzap.com/offer/developing-a-multithreaded-kernel-from-scratch-part-two-full-series
+ */
+
+#ifndef KERNEL_VMA_H
+#define KERNEL_VMA_H
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Virtual memory areas, every reserved range of a process address space is
+ * a region in a balanced (AVL) tree ordered by start address. Reserving a range
+ * does not allocate or map any physical memory, the caller backs it.
+ */
+
+enum
+{
+    VMA_REGION_TYPE_HEAP,
+    VMA_REGION_TYPE_STACK,
+    VMA_REGION_TYPE_PROGRAM,
+    VMA_REGION_TYPE_MAPPING
+};
+
+struct vma_region
+{
+    // Page aligned start, inclusive
+    uintptr_t start;
+    // End of the region, exclusive
+    uintptr_t end;
+
+    // The size originally requested, may be smaller than end-start
+    size_t size;
+
+    int type;
+};
+
+struct vma_node
+{
+    struct vma_region region;
+    struct vma_node* left;
+    struct vma_node* right;
+    int height;
+};
+
+struct vma_tree
+{
+    struct vma_node* root;
+
+    // Range that vma_reserve may hand out, fixed reservations may be anywhere
+    uintptr_t min;
+    uintptr_t max;
+
+    // Where the next search for a free range begins
+    uintptr_t hint;
+
+    size_t total_regions;
+};
+
+typedef int (*VMA_REGION_ITERATOR)(struct vma_region* region, void* private);
+
+/**
+ * Creates a tree whose free range allocator hands out addresses between min and max
+ */
+struct vma_tree* vma_tree_new(uintptr_t min, uintptr_t max);
+
+/**
+ * Frees the tree and all of its regions, backing memory is the callers responsibility
+ */
+void vma_tree_free(struct vma_tree* tree);
+
+/**
+ * Reserves the range start to start+size, fails with -EINVARG if it overlaps a region
+ */
+int vma_reserve_fixed(struct vma_tree* tree, uintptr_t start, size_t size, int type, struct vma_region** region_out);
+
+/**
+ * Finds a free range of size bytes between the trees min and max and reserves it
+ */
+int vma_reserve(struct vma_tree* tree, size_t size, int type, struct vma_region** region_out);
+
+/**
+ * Releases the region that starts at start
+ */
+int vma_release(struct vma_tree* tree, uintptr_t start);
+
+/**
+ * Returns the region containing addr or NULL
+ */
+struct vma_region* vma_find(struct vma_tree* tree, uintptr_t addr);
+
+/**
+ * Calls the iterator for every region in address order, stops when it returns non zero
+ */
+int vma_walk(struct vma_tree* tree, VMA_REGION_ITERATOR iterator, void* private);
+
+#endif
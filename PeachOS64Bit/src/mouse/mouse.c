@@ -29,7 +29,8 @@
 #include "mouse/ps2mouse.h"
 #include "lib/vector/vector.h"
 #include "graphics/graphics.h"
-#include "graphics/window.h"
+#include "graphics/cursor.h"
+#include "memory/heap/kheap.h"
 #include "kernel.h"
 #include "status.h"
 
@@ -67,9 +68,23 @@ void mouse_draw_default_impl(struct mouse* mouse)
 {
     struct framebuffer_pixel pixel_color = {0};
     pixel_color.red = 0xf3;
-    
-    struct terminal* win_term = window_terminal(mouse->graphic.window);
-    terminal_draw_rect(win_term, 0, 0, win_term->bounds.width, win_term->bounds.height, pixel_color);  
+
+    size_t total_pixels = mouse->graphic.width * mouse->graphic.height;
+    struct framebuffer_pixel* pixels = kzalloc(total_pixels * sizeof(struct framebuffer_pixel));
+    if (!pixels)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < total_pixels; i++)
+    {
+        pixels[i] = pixel_color;
+    }
+
+    // Black transparency key, every pixel of the square is drawn
+    struct framebuffer_pixel no_transparency_key = {0};
+    cursor_image_set(pixels, mouse->graphic.width, mouse->graphic.height, no_transparency_key);
+    kfree(pixels);
 }
 
 int mouse_register(struct mouse* mouse)
@@ -123,12 +138,7 @@ int mouse_register(struct mouse* mouse)
         goto out;
     }
 
-    if (!mouse->graphic.window)
-    {
-        mouse->graphic.window = window_create(screen_graphics, NULL, "", mouse->coords.x, mouse->coords.y, mouse->graphic.width, mouse->graphic.height, WINDOW_FLAG_BACKGROUND_TRANSPARENT | WINDOW_FLAG_BORDERLESS | WINDOW_FLAG_CLICK_THROUGH, -1);
-        window_set_z_index(mouse->graphic.window, MOUSE_GRAPHIC_ZINDEX);
-    }
-
+    cursor_move(mouse->coords.x, mouse->coords.y);
     mouse->draw(mouse);
     vector_push(mouse_driver_vector, &mouse);
 out:
@@ -139,7 +149,7 @@ void mouse_position_set(struct mouse* mouse, size_t x, size_t y)
 {
     mouse->coords.x = x;
     mouse->coords.y = y;
-    window_position_set(mouse->graphic.window, x, y);
+    cursor_move(x, y);
 }
 
 void mouse_click(struct mouse* mouse, MOUSE_CLICK_TYPE type)
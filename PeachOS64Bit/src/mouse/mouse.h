@@ -32,7 +32,6 @@
 
 #define MOUSE_GRAPHIC_DEFAULT_WIDTH 10
 #define MOUSE_GRAPHIC_DEFAULT_HEIGHT 10
-#define MOUSE_GRAPHIC_ZINDEX 100000
 
 enum
 {
@@ -64,10 +63,10 @@ struct mouse
         int y;
     } coords;
 
-    // Mouse graphics.
+    // Size of the cursor image, the cursor is drawn as an overlay
+    // on top of the composited screen see graphics/cursor.h
     struct
     {
-        struct window* window;
         int width;
         int height;
     } graphic;
@@ -33,11 +33,16 @@
 #include "string/string.h"
 #include "fs/file.h"
 #include "lib/vector/vector.h"
+#include "lib/list/list.h"
+#include "lib/hashmap/hashmap.h"
+#include "task/userlandptr.h"
 #include "memory/heap/kheap.h"
 #include "memory/paging/paging.h"
+#include "memory/vma/vma.h"
 #include "loader/formats/elfloader.h"
 #include "graphics/graphics.h"
 #include "graphics/window.h"
+#include "boot/boottrace.h"
 #include "kernel.h"
 #include <stdbool.h>
 
@@ -46,6 +51,9 @@ struct process *current_process = 0;
 
 struct vector *process_vector = NULL;
 
+// Maps every kernel window opened by a process to its struct process_window*
+struct hashmap *process_windows_by_kernel_window = NULL;
+
 int process_get_allocation_by_start_addr(struct process *process, void *addr, struct process_allocation *allocation_out);
 
 int process_free_process(struct process *process);
@@ -54,24 +62,93 @@ void process_window_closed(struct process *process, struct process_window *proc_
 
 void *process_virtual_address_to_physical(struct process *process, void *virt_addr)
 {
+    struct paging_desc_entry *entry = paging_get(process->paging_desc, virt_addr);
+    if (!entry || !entry->present)
+    {
+        // Elf pages are only loaded when they are first used, reading may use the shared page
+        process_page_in(process, virt_addr, false);
+    }
+    return paging_get_physical_address(process->paging_desc, virt_addr);
+}
+
+void *process_virtual_address_to_physical_for_write(struct process *process, void *virt_addr)
+{
+    struct paging_desc_entry *entry = paging_get(process->paging_desc, virt_addr);
+    if (!entry || !entry->present || !entry->read_write)
+    {
+        // The caller writes to the physical address so shared pages are copied first
+        process_page_in(process, virt_addr, true);
+        process_page_privatize(process, virt_addr);
+    }
     return paging_get_physical_address(process->paging_desc, virt_addr);
 }
 
-void process_system_init()
+int process_system_init()
 {
+    int res = 0;
     process_vector = vector_new(sizeof(struct process *), 10, 0);
+    process_windows_by_kernel_window = hashmap_new(16);
+    if (!process_vector || !process_windows_by_kernel_window)
+    {
+        res = -ENOMEM;
+    }
+
+    return res;
+}
+
+/**
+ * Frees what process_init allocated, used when the process never got further
+ */
+static void process_init_free(struct process *process)
+{
+    vma_tree_free(process->vmas);
+    if (process->file_handles)
+    {
+        vector_free(process->file_handles);
+    }
+    if (process->kernel_userland_ptrs)
+    {
+        hashmap_free(process->kernel_userland_ptrs);
+    }
+    if (process->windows_by_user_win)
+    {
+        hashmap_free(process->windows_by_user_win);
+    }
+    if (process->window_events.vector)
+    {
+        vector_free(process->window_events.vector);
+    }
+    if (process->elf_pages)
+    {
+        vector_free(process->elf_pages);
+    }
 }
 
-static void process_init(struct process *process)
+static int process_init(struct process *process)
 {
+    int res = 0;
     memset(process, 0, sizeof(struct process));
-    process->allocations = vector_new(sizeof(struct process_allocation), 10, 0);
+    process->vmas = vma_tree_new(PEACHOS_PROCESS_MMAP_START, PEACHOS_PROCESS_MMAP_END);
     process->file_handles = vector_new(sizeof(struct process_file_handle *), 4, 0);
-    process->kernel_userland_ptrs_vector = vector_new(sizeof(struct userland_ptr *), 4, 0);
-    process->windows = vector_new(sizeof(struct process_window *), 4, 0);
+    process->kernel_userland_ptrs = hashmap_new(8);
+    list_init(&process->windows);
+    process->windows_by_user_win = hashmap_new(4);
     process->window_events.vector = vector_new(sizeof(struct window_event), 100, 0);
+    process->elf_pages = vector_new(sizeof(void *), 16, 0);
+    if (!process->vmas || !process->file_handles || !process->kernel_userland_ptrs ||
+        !process->windows_by_user_win || !process->window_events.vector || !process->elf_pages)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
 
-    vector_grow(process->window_events.vector, PROCESS_MAX_WINDOW_EVENTS_RECORDED);
+    res = vector_grow(process->window_events.vector, PROCESS_MAX_WINDOW_EVENTS_RECORDED);
+out:
+    if (res < 0)
+    {
+        process_init_free(process);
+    }
+    return res;
 }
 
 struct process *process_current()
@@ -81,52 +158,24 @@ struct process *process_current()
 
 bool process_owns_kernel_window(struct process *process, struct window *kernel_window)
 {
-    size_t total_windows = vector_count(process->windows);
-    for (size_t i = 0; i < total_windows; i++)
-    {
-        struct process_window *win = NULL;
-        vector_at(process->windows, i, &win, sizeof(win));
-        if (win && win->kernel_win == kernel_window)
-        {
-            return true;
-        }
-    }
-
-    return false;
+    struct process_window *proc_win = hashmap_get(process_windows_by_kernel_window, (uint64_t)kernel_window);
+    return proc_win && proc_win->process == process;
 }
 
 struct process *process_get_from_kernel_window(struct window *window)
 {
-    size_t total_processes = vector_count(process_vector);
-    for (size_t i = 0; i < total_processes; i++)
+    struct process_window *proc_win = hashmap_get(process_windows_by_kernel_window, (uint64_t)window);
+    if (!proc_win)
     {
-        struct process *process = NULL;
-        vector_at(process_vector, i, &process, sizeof(process));
-        if (process)
-        {
-            if (process_owns_kernel_window(process, window))
-            {
-                return process;
-            }
-        }
+        return NULL;
     }
-    return NULL;
+
+    return proc_win->process;
 }
 
 struct process_window *process_window_get_from_user_window(struct process *process, struct process_userspace_window *user_win)
 {
-    size_t total_windows = vector_count(process->windows);
-    for (size_t i = 0; i < total_windows; i++)
-    {
-        struct process_window *win = NULL;
-        vector_at(process->windows, i, &win, sizeof(win));
-        if (win && win->user_win == user_win)
-        {
-            return win;
-        }
-    }
-
-    return NULL;
+    return hashmap_get(process->windows_by_user_win, (uint64_t)user_win);
 }
 
 int process_window_event_get_relative_window_body_coords(struct window_event *event, int *out_x, int *out_y)
@@ -191,21 +240,13 @@ int process_window_event_handler_event_focus(struct window *window, struct proce
 
 struct process_window *process_window_get_from_kernel_window(struct process *process, struct window *kern_win)
 {
-    size_t total_windows = vector_count(process->windows);
-    for (size_t i = 0; i < total_windows; i++)
+    struct process_window *proc_win = hashmap_get(process_windows_by_kernel_window, (uint64_t)kern_win);
+    if (!proc_win || proc_win->process != process)
     {
-        struct process_window *proc_win = NULL;
-        vector_at(process->windows, i, &proc_win, sizeof(proc_win));
-        if (proc_win)
-        {
-            if (proc_win->kernel_win == kern_win)
-            {
-                return proc_win;
-            }
-        }
+        return NULL;
     }
 
-    return NULL;
+    return proc_win;
 }
 
 int process_window_event_handler_event_close(struct window *window, struct process *process, struct window_event *event)
@@ -299,6 +340,88 @@ void process_print(struct process *process, const char *message)
     }
 }
 
+/**
+ * Writes len bytes from the process virtual address to its sysout window,
+ * the span is written a page at a time as the physical pages need not be contiguous.
+ * Returns the total bytes written.
+ */
+int process_write(struct process *process, void *virt_ptr, size_t len)
+{
+    int res = 0;
+    size_t written = 0;
+    struct terminal *win_term = NULL;
+    struct process_window *printing_process_win = process->sysout_win;
+    if (!printing_process_win || !printing_process_win->kernel_win)
+    {
+        // Nowhere to print to
+        res = -EIO;
+        goto out;
+    }
+
+    win_term = window_terminal(printing_process_win->kernel_win);
+    if (!win_term)
+    {
+        res = -EIO;
+        goto out;
+    }
+
+    while (written < len)
+    {
+        uintptr_t virt = (uintptr_t) virt_ptr + written;
+        size_t page_left = PAGING_PAGE_SIZE - (virt % PAGING_PAGE_SIZE);
+        size_t chunk = MIN(page_left, len - written);
+        struct paging_desc_entry *entry = paging_get(process->paging_desc, (void *) virt);
+        if ((!entry || !entry->present) && process_page_in(process, (void *) virt, false) >= 0)
+        {
+            entry = paging_get(process->paging_desc, (void *) virt);
+        }
+
+        if (!entry || !entry->present || !entry->user_supervisor)
+        {
+            res = -EINVARG;
+            goto out;
+        }
+
+        const char *phys = paging_get_physical_address(process->paging_desc, (void *) virt);
+        res = terminal_write_buffer_no_flush(win_term, phys, chunk);
+        if (res < 0)
+        {
+            goto out;
+        }
+        written += chunk;
+    }
+
+    res = (int) written;
+out:
+    if (written > 0)
+    {
+        // Every chunk is presented in a single update
+        terminal_flush(win_term);
+    }
+    return res;
+}
+
+/**
+ * Scrolls the view of the sysout window terminal back over its scrollback,
+ * returns the rows it was scrolled back by
+ */
+int process_terminal_scrollback(struct process *process, size_t rows_back)
+{
+    struct process_window *printing_process_win = process->sysout_win;
+    if (!printing_process_win || !printing_process_win->kernel_win)
+    {
+        return -EIO;
+    }
+
+    struct terminal *win_term = window_terminal(printing_process_win->kernel_win);
+    if (!win_term)
+    {
+        return -EIO;
+    }
+
+    return terminal_scrollback_view(win_term, rows_back);
+}
+
 void process_set_sysout_window(struct process *process, struct process_window *win)
 {
     process->sysout_win = win;
@@ -306,12 +429,13 @@ void process_set_sysout_window(struct process *process, struct process_window *w
 
 void process_close_windows(struct process *process)
 {
-    size_t total_windows = vector_count(process->windows);
-    for (size_t i = 0; i < total_windows; i++)
+    // Closing a window unlinks it from the list
+    struct list_node *node = NULL;
+    struct list_node *tmp = NULL;
+    list_for_each_safe(&process->windows, node, tmp)
     {
-        struct process_window *window = NULL;
-        vector_at(process->windows, i, &window, sizeof(window));
-        if (window && window->kernel_win)
+        struct process_window *window = list_entry(node, struct process_window, list_node);
+        if (window->kernel_win)
         {
             window_close(window->kernel_win);
         }
@@ -363,7 +487,20 @@ struct process_window *process_window_create(struct process *process, char *titl
     window_event_handler_register(proc_win->kernel_win, process_window_event_handler);
 
 
-    vector_push(process->windows, &proc_win);
+    proc_win->process = process;
+    res = hashmap_set(process->windows_by_user_win, (uint64_t)proc_win->user_win, proc_win);
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    res = hashmap_set(process_windows_by_kernel_window, (uint64_t)proc_win->kernel_win, proc_win);
+    if (res < 0)
+    {
+        hashmap_remove(process->windows_by_user_win, (uint64_t)proc_win->user_win);
+        goto out;
+    }
+    list_push_back(&process->windows, &proc_win->list_node);
 out:
     if (res < 0)
     {
@@ -403,130 +540,120 @@ int process_switch(struct process *process)
     return 0;
 }
 
-int process_find_free_allocation_index(struct process *process)
+/**
+ * Maps the kernel heap memory at ptr into the process at the same address and
+ * reserves the range so nothing else can be placed over it
+ */
+static int process_allocation_map(struct process *process, void *ptr, size_t size)
 {
-    int res = 0;
-    bool found = false;
-    size_t allocation_size = vector_count(process->allocations);
-    for (size_t i = 0; i < allocation_size; i++)
+    int res = vma_reserve_fixed(process->vmas, (uintptr_t)ptr, size, VMA_REGION_TYPE_HEAP, NULL);
+    if (res < 0)
     {
-        struct process_allocation allocation;
-        res = vector_at(process->allocations, i, &allocation, sizeof(allocation));
-        if (res < 0)
-        {
-            break;
-        }
-
-        if (allocation.ptr == NULL)
-        {
-            res = i;
-            found = true;
-            break;
-        }
+        goto out;
     }
 
-    if (!found)
+    res = paging_map_to(process->paging_desc, ptr, ptr, paging_align_address(ptr + size), PAGING_IS_WRITEABLE | PAGING_IS_PRESENT | PAGING_ACCESS_FROM_ALL);
+    if (res < 0)
     {
-        struct process_allocation allocation = {0};
-        res = vector_push(process->allocations, &allocation);
+        vma_release(process->vmas, (uintptr_t)ptr);
+        goto out;
     }
+
+out:
     return res;
 }
 
-int process_allocation_set_map(struct process *process, int allocation_entry_index, void *ptr, size_t size)
+static int process_allocation_unmap(struct process *process, struct vma_region *region)
 {
-    int res = paging_map_to(process->paging_desc, ptr, ptr, paging_align_address(ptr + size), PAGING_IS_WRITEABLE | PAGING_IS_PRESENT | PAGING_ACCESS_FROM_ALL);
-    if (res < 0)
-    {
-        goto out;
-    }
-
-    struct process_allocation allocation;
-    res = vector_at(process->allocations, allocation_entry_index, &allocation, sizeof(allocation));
+    int res = paging_map_to(process->paging_desc, (void *)region->start, (void *)region->start, (void *)region->end, 0x00);
     if (res < 0)
     {
         goto out;
     }
 
-    allocation.ptr = ptr;
-    allocation.end = ptr + size;
-    allocation.size = size;
-
-    vector_overwrite(process->allocations, allocation_entry_index, &allocation, sizeof(allocation));
-
+    res = vma_release(process->vmas, region->start);
 out:
     return res;
 }
 
-int process_allocation_exists(struct process *process, void *ptr, size_t *index_out)
+static struct vma_region *process_heap_region(struct process *process, void *ptr)
 {
-    int res = -ENOTFOUND;
-    size_t total_allocations = vector_count(process->allocations);
-    for (size_t i = 0; i < total_allocations; i++)
+    struct vma_region *region = vma_find(process->vmas, (uintptr_t)ptr);
+    if (!region || region->type != VMA_REGION_TYPE_HEAP || region->start != (uintptr_t)ptr)
     {
-        struct process_allocation allocation;
-        res = vector_at(process->allocations, i, &allocation, sizeof(allocation));
-        if (res < 0)
-        {
-            break;
-        }
-
-        if (allocation.ptr == ptr)
-        {
-            if (index_out)
-            {
-                *index_out = i;
-            }
-            res = 0;
-            break;
-        }
+        return NULL;
     }
-    return res;
+
+    return region;
 }
+
 void *process_realloc(struct process *process, void *old_virt_ptr, size_t new_size)
 {
     int res = 0;
     void *new_ptr = NULL;
-    void *old_phys_ptr = NULL;
-    size_t old_allocation_index = 0;
 
     if (old_virt_ptr == NULL)
     {
         return process_malloc(process, new_size);
     }
-    
-    res = process_allocation_exists(process, old_virt_ptr, &old_allocation_index);
-    if (res < 0)
+
+    if (new_size == 0)
     {
-        goto out;
+        // The allocation is released and unmapped, there is nothing to return
+        process_free(process, old_virt_ptr);
+        return NULL;
     }
 
-    old_phys_ptr = old_virt_ptr;
-    if (old_phys_ptr)
+    struct vma_region *region = process_heap_region(process, old_virt_ptr);
+    if (!region)
     {
-        old_phys_ptr = task_virtual_address_to_physical(process->task, old_virt_ptr);
-        if (!old_phys_ptr)
-        {
-            res = -ENOMEM;
-            goto out;
-        }
+        res = -EINVARG;
+        goto out;
     }
-    new_ptr = krealloc(old_phys_ptr, new_size);
+    size_t old_size = region->size;
+
+    // The old allocation stays allocated and mapped until the new one is,
+    // on failure the caller still owns it as it was
+    new_ptr = kzalloc(new_size);
     if (!new_ptr)
     {
         res = -ENOMEM;
         goto out;
     }
 
-    res = process_allocation_set_map(process, old_allocation_index, new_ptr, new_size);
+    // Heap allocations are identity mapped, the virtual address is the kernel address
+    res = process_allocation_map(process, new_ptr, new_size);
     if (res < 0)
     {
         goto out;
     }
 
+    memcpy(new_ptr, old_virt_ptr, MIN(old_size, new_size));
+
+    // Mapping the new range may have rebalanced the tree, look the old region up again
+    region = process_heap_region(process, old_virt_ptr);
+    res = region ? process_allocation_unmap(process, region) : -EINVARG;
+    if (res < 0)
+    {
+        region = process_heap_region(process, new_ptr);
+        if (region)
+        {
+            process_allocation_unmap(process, region);
+        }
+        goto out;
+    }
+
+    kfree(old_virt_ptr);
+
 out:
+    if (res < 0 && new_ptr)
+    {
+        kfree(new_ptr);
+        new_ptr = NULL;
+    }
     return new_ptr;
 }
+
 void *process_malloc(struct process *process, size_t size)
 {
     int res = 0;
@@ -537,14 +664,7 @@ void *process_malloc(struct process *process, size_t size)
         goto out_err;
     }
 
-    int index = process_find_free_allocation_index(process);
-    if (index < 0)
-    {
-        res = -ENOMEM;
-        goto out_err;
-    }
-
-    res = process_allocation_set_map(process, index, ptr, size);
+    res = process_allocation_map(process, ptr, size);
     if (res < 0)
     {
         goto out_err;
@@ -559,86 +679,37 @@ out_err:
     return 0;
 }
 
-static bool process_is_process_pointer(struct process *process, void *ptr)
+int process_get_allocation_by_start_addr(struct process *process, void *addr, struct process_allocation *allocation_out)
 {
-    size_t total_allocations = vector_count(process->allocations);
-    for (size_t i = 0; i < total_allocations; i++)
+    struct vma_region *region = process_heap_region(process, addr);
+    if (!region)
     {
-        struct process_allocation allocation;
-        int res = vector_at(process->allocations, i, &allocation, sizeof(allocation));
-        if (res < 0)
-        {
-            break;
-        }
-
-        if (allocation.ptr == ptr)
-        {
-            return true;
-        }
+        return -EIO;
     }
 
-    return false;
-}
-
-static void process_allocation_unjoin(struct process *process, void *ptr)
-{
-    size_t total_allocations = vector_count(process->allocations);
-    for (size_t i = 0; i < total_allocations; i++)
-    {
-        struct process_allocation allocation;
-        int res = vector_at(process->allocations, i, &allocation, sizeof(allocation));
-        if (res < 0)
-        {
-            break;
-        }
-
-        if (allocation.ptr == ptr)
-        {
-            allocation.ptr = NULL;
-            allocation.end = NULL;
-            allocation.size = 0;
-            vector_overwrite(process->allocations, i, &allocation, sizeof(allocation));
-        }
-    }
+    allocation_out->ptr = (void *)region->start;
+    allocation_out->end = (void *)(region->start + region->size);
+    allocation_out->size = region->size;
+    return 0;
 }
 
-int process_get_allocation_by_start_addr(struct process *process, void *addr, struct process_allocation *allocation_out)
+static int process_first_heap_region(struct vma_region *region, void *private)
 {
-    size_t total_allocations = vector_count(process->allocations);
-    for (size_t i = 0; i < total_allocations; i++)
+    if (region->type != VMA_REGION_TYPE_HEAP)
     {
-        struct process_allocation allocation;
-        int res = vector_at(process->allocations, i, &allocation, sizeof(allocation));
-        if (res < 0)
-        {
-            break;
-        }
-        if (allocation.ptr == addr)
-        {
-            *allocation_out = allocation;
-            return 0;
-        }
+        return 0;
     }
 
-    return -EIO;
+    *(struct vma_region **)private = region;
+    return 1;
 }
 
 int process_terminate_allocations(struct process *process)
 {
-    size_t total_allocations = vector_count(process->allocations);
-    for (size_t i = 0; i < total_allocations; i++)
+    struct vma_region *region = NULL;
+    while (vma_walk(process->vmas, process_first_heap_region, &region) != 0)
     {
-        struct process_allocation allocation;
-        int res = vector_at(process->allocations, i, &allocation, sizeof(allocation));
-        if (res < 0)
-        {
-            break;
-        }
-
-        if (allocation.ptr)
-        {
-            process_free(process, allocation.ptr);
-        }
+        process_free(process, (void *)region->start);
     }
     return 0;
 }
@@ -654,6 +725,19 @@ int process_free_binary_data(struct process *process)
 
 int process_free_elf_data(struct process *process)
 {
+    size_t total_pages = vector_count(process->elf_pages);
+    for (size_t i = 0; i < total_pages; i++)
+    {
+        void *page = NULL;
+        vector_at(process->elf_pages, i, &page, sizeof(page));
+        if (page)
+        {
+            kfree(page);
+        }
+    }
+    vector_free(process->elf_pages);
+    process->elf_pages = NULL;
+
     if (process->elf_file)
     {
         elf_close(process->elf_file);
@@ -713,8 +797,10 @@ static void process_unlink(struct process *process)
 
 void process_window_closed(struct process *process, struct process_window *proc_win)
 {
-    // Pop it from the process window vector
-    vector_pop_element(process->windows, &proc_win, sizeof(proc_win));
+    // Unregister it from the process
+    list_remove(&process->windows, &proc_win->list_node);
+    hashmap_remove(process->windows_by_user_win, (uint64_t)proc_win->user_win);
+    hashmap_remove(process_windows_by_kernel_window, (uint64_t)proc_win->kernel_win);
 
     process_free(process, proc_win->user_win);
     kfree(proc_win);
@@ -728,12 +814,14 @@ int process_free_process(struct process *process)
     process_free_program_data(process);
     process_close_file_handles(process);
 
-    // Free the process allocations
-    vector_free(process->allocations);
-    process->allocations = NULL;
+    // Free the virtual memory areas, the backing memory is already gone
+    vma_tree_free(process->vmas);
+    process->vmas = NULL;
 
-    vector_free(process->kernel_userland_ptrs_vector);
-    process->kernel_userland_ptrs_vector = NULL;
+    process_userland_pointers_free(process);
+
+    hashmap_free(process->windows_by_user_win);
+    process->windows_by_user_win = NULL;
 
     vector_free(process->window_events.vector);
     process->window_events.vector = NULL;
@@ -751,6 +839,13 @@ int process_free_process(struct process *process)
         process->task = NULL;
     }
 
+    // Only the page tables the process made its own are freed
+    if (process->paging_desc)
+    {
+        paging_desc_free(process->paging_desc);
+        process->paging_desc = NULL;
+    }
+
     kfree(process);
 
 out:
@@ -833,24 +928,20 @@ out:
 void process_free(struct process *process, void *ptr)
 {
     int res = 0;
-    // Unlink the pages from the process for the given address
-    struct process_allocation allocation;
-    res = process_get_allocation_by_start_addr(process, ptr, &allocation);
-    if (res < 0)
+    struct vma_region *region = process_heap_region(process, ptr);
+    if (!region)
     {
         // Oops its not our pointer.
         return;
     }
 
-    res = paging_map_to(process->paging_desc, allocation.ptr, allocation.ptr, paging_align_address(allocation.ptr + allocation.size), 0x00);
+    // Unlink the pages from the process and forget the range
+    res = process_allocation_unmap(process, region);
     if (res < 0)
     {
         return;
     }
 
-    // Unjoin the allocation
-    process_allocation_unjoin(process, ptr);
-
     // We can now free the memory.
     kfree(ptr);
 }
@@ -931,14 +1022,140 @@ static int process_load_data(const char *filename, struct process *process)
 
 int process_map_binary(struct process *process)
 {
-    int res = 0;
+    int res = vma_reserve_fixed(process->vmas, PEACHOS_PROGRAM_VIRTUAL_ADDRESS, process->size, VMA_REGION_TYPE_PROGRAM, NULL);
+    if (res < 0)
+    {
+        return res;
+    }
+
     paging_map_to(process->paging_desc, (void *)PEACHOS_PROGRAM_VIRTUAL_ADDRESS, process->ptr, paging_align_address(process->ptr + process->size), PAGING_IS_PRESENT | PAGING_ACCESS_FROM_ALL | PAGING_IS_WRITEABLE);
     return res;
 }
 
+/**
+ * Maps a private copy of the shared elf page at the page address of the process,
+ * the copy is freed with the rest of the elf data of the process
+ */
+static int process_page_copy(struct process *process, void *page, void *shared_page, int flags)
+{
+    int res = 0;
+    void *private_page = kmalloc(PAGING_PAGE_SIZE);
+    if (!private_page)
+    {
+        res = -ENOMEM;
+        goto out;
+    }
+
+    memcpy(private_page, shared_page, PAGING_PAGE_SIZE);
+    // Only pages that are mapped are tracked, a page that failed to map is freed below
+    res = paging_map(process->paging_desc, page, paging_get_physical_address(kernel_desc(), private_page), flags);
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    res = vector_push(process->elf_pages, &private_page);
+    if (res < 0)
+    {
+        // Untracked pages would never be freed, take it away again
+        paging_map(process->paging_desc, page, NULL, 0);
+        goto out;
+    }
+    res = 0;
+out:
+    if (res < 0 && private_page)
+    {
+        kfree(private_page);
+    }
+    return res;
+}
+
+/**
+ * Maps the elf page containing virt into the process. Pages are shared with every
+ * process running the same file and mapped read only, writable pages are copied
+ * the first time they are written to.
+ */
+int process_page_in(struct process *process, void *virt, bool write)
+{
+    int res = 0;
+    if (process->filetype != PROCESS_FILETYPE_ELF || !process->elf_file)
+    {
+        res = -EINVARG;
+        goto out;
+    }
+
+    void *page = paging_align_to_lower_page(virt);
+    void *shared_page = elf_image_page(process->elf_file, page);
+    if (!shared_page)
+    {
+        res = -EINVARG;
+        goto out;
+    }
+
+    bool writeable = elf_page_writeable(process->elf_file, page);
+    struct paging_desc_entry *entry = paging_get(process->paging_desc, page);
+    bool mapped = entry && entry->present && entry->user_supervisor;
+    if (mapped && (!write || !writeable || entry->read_write))
+    {
+        // Already loaded, this is a real access violation
+        res = -EINVARG;
+        goto out;
+    }
+
+    if (!write || !writeable)
+    {
+        res = paging_map(process->paging_desc, page, paging_get_physical_address(kernel_desc(), shared_page), PAGING_IS_PRESENT | PAGING_ACCESS_FROM_ALL);
+        goto out;
+    }
+
+    // Copy on write, this process gets its own copy of the page
+    res = process_page_copy(process, page, shared_page, PAGING_IS_PRESENT | PAGING_ACCESS_FROM_ALL | PAGING_IS_WRITEABLE);
+out:
+    return res;
+}
+
+/**
+ * Gives the process its own copy of the elf page containing virt when it still maps
+ * the shared page. The kernel writes to user memory through physical addresses,
+ * which no page protection catches, so it must never be given a shared page.
+ */
+int process_page_privatize(struct process *process, void *virt)
+{
+    int res = 0;
+    if (process->filetype != PROCESS_FILETYPE_ELF || !process->elf_file)
+    {
+        goto out;
+    }
+
+    void *page = paging_align_to_lower_page(virt);
+    void *shared_page = elf_image_page(process->elf_file, page);
+    struct paging_desc_entry *entry = paging_get(process->paging_desc, page);
+    if (!shared_page || !entry || !entry->present ||
+        paging_get_physical_address(process->paging_desc, page) != paging_get_physical_address(kernel_desc(), shared_page))
+    {
+        // Not an elf page or already private
+        goto out;
+    }
+
+    int flags = PAGING_IS_PRESENT | PAGING_ACCESS_FROM_ALL;
+    if (entry->read_write)
+    {
+        flags |= PAGING_IS_WRITEABLE;
+    }
+    res = process_page_copy(process, page, shared_page, flags);
+out:
+    return res;
+}
+
+/**
+ * The elf segments are not mapped here, every page is left not present
+ * so process_page_in loads it on first touch.
+ */
 static int process_map_elf(struct process *process)
 {
     int res = 0;
+    uintptr_t program_start = UINTPTR_MAX;
+    uintptr_t program_end = 0;
 
     struct elf_file *elf_file = process->elf_file;
     struct elf_header *header = elf_header(elf_file);
@@ -946,27 +1163,42 @@ static int process_map_elf(struct process *process)
     for (int i = 0; i < header->e_phnum; i++)
     {
         struct elf64_phdr *phdr = &phdrs[i];
-        void *phdr_phys_address = elf_phdr_phys_address(elf_file, phdr);
-        int flags = PAGING_IS_PRESENT | PAGING_ACCESS_FROM_ALL;
-        if (phdr->p_flags & PF_W)
+        if (phdr->p_type != PT_LOAD)
         {
-            flags |= PAGING_IS_WRITEABLE;
+            continue;
         }
-        res = paging_map_to(process->paging_desc, paging_align_to_lower_page((void *)(uintptr_t)phdr->p_vaddr), paging_align_to_lower_page(phdr_phys_address), paging_align_address(phdr_phys_address + phdr->p_memsz), flags);
-        if (ISERR(res))
+
+        // Segments may share a page, the image is reserved as one region
+        program_start = MIN(program_start, phdr->p_vaddr);
+        program_end = MAX(program_end, phdr->p_vaddr + phdr->p_memsz);
+
+        // The e820 identity mapping may cover the program addresses, remove it
+        void *virt = paging_align_to_lower_page((void *)(uintptr_t)phdr->p_vaddr);
+        void *virt_end = paging_align_address((void *)(uintptr_t)(phdr->p_vaddr + phdr->p_memsz));
+        for (; virt < virt_end; virt += PAGING_PAGE_SIZE)
         {
-            break;
+            res = paging_map(process->paging_desc, virt, NULL, 0);
+            if (ISERR(res))
+            {
+                goto out;
+            }
         }
     }
+
+    if (program_end > program_start)
+    {
+        res = vma_reserve_fixed(process->vmas, program_start, program_end - program_start, VMA_REGION_TYPE_PROGRAM, NULL);
+    }
+out:
     return res;
 }
 int process_map_memory(struct process *process)
 {
     int res = 0;
 
-    // Map all the e820 memory regions
-    // so the whole address space is mapped
-    paging_map_e820_memory_regions(process->paging_desc);
+    // Borrow the kernel page tables, only what the process maps
+    // over them gets copied
+    paging_desc_share(process->paging_desc, kernel_desc());
 
     switch (process->filetype)
     {
@@ -988,6 +1220,11 @@ int process_map_memory(struct process *process)
     }
 
     // Finally map the stack
+    res = vma_reserve_fixed(process->vmas, PEACHOS_PROGRAM_VIRTUAL_STACK_ADDRESS_END, PEACHOS_USER_PROGRAM_STACK_SIZE, VMA_REGION_TYPE_STACK, NULL);
+    if (res < 0)
+    {
+        goto out;
+    }
     paging_map_to(process->paging_desc, (void *)PEACHOS_PROGRAM_VIRTUAL_STACK_ADDRESS_END, process->stack, paging_align_address(process->stack + PEACHOS_USER_PROGRAM_STACK_SIZE), PAGING_IS_PRESENT | PAGING_ACCESS_FROM_ALL | PAGING_IS_WRITEABLE);
 out:
     return res;
@@ -1061,7 +1298,7 @@ int process_load_switch(const char *filename, struct process **process)
 int process_load_for_slot(const char *filename, struct process **process, int process_slot)
 {
     int res = 0;
-    struct process *_process;
+    struct process *_process = NULL;
 
     if (process_get(process_slot) != 0)
     {
@@ -1076,7 +1313,15 @@ int process_load_for_slot(const char *filename, struct process **process, int pr
         goto out;
     }
 
-    process_init(_process);
+    res = process_init(_process);
+    if (res < 0)
+    {
+        // Nothing else was set up, process_free_process is not needed
+        kfree(_process);
+        _process = NULL;
+        goto out;
+    }
+
     res = process_load_data(filename, _process);
     if (res < 0)
     {
@@ -1167,33 +1412,27 @@ int process_get_allocation_by_addr(struct process *process, void *addr, struct p
         return 0;
     }
 
-    // Not a stack address then check the heap
-    size_t total_allocations = vector_count(process->allocations);
-    for (size_t i = 0; i < total_allocations; i++)
+    // Not a stack address then check the heap and mappings
+    struct vma_region *region = vma_find(process->vmas, (uintptr_t)addr);
+    if (!region || (region->type != VMA_REGION_TYPE_HEAP && region->type != VMA_REGION_TYPE_MAPPING))
     {
-        struct process_allocation allocation;
-        int res = vector_at(process->allocations, i, &allocation, sizeof(allocation));
-        if (res < 0)
-        {
-            break;
-        }
+        return -EIO;
+    }
 
-        uint64_t allocation_addr = (uint64_t)allocation.ptr;
-        uint64_t allocation_addr_end = (uint64_t)allocation.end;
-        if ((uint64_t)addr >= allocation_addr &&
-            ((uint64_t)addr) <= allocation_addr_end)
-        {
-            size_t bytes_used = (uint64_t)addr - allocation_addr;
-            size_t bytes_left = allocation_addr_end - bytes_used;
-            allocation_request_out->allocation = allocation;
-            allocation_request_out->peek.addr = addr;
-            allocation_request_out->peek.end = (void *)allocation_addr_end;
-            allocation_request_out->peek.total_bytes_left = bytes_left;
-            return 0;
-        }
+    uintptr_t region_end = region->start + region->size;
+    if ((uintptr_t)addr >= region_end)
+    {
+        // In the page padding past the requested size
+        return -EIO;
     }
 
-    return -EIO;
+    allocation_request_out->allocation.ptr = (void *)region->start;
+    allocation_request_out->allocation.end = (void *)region_end;
+    allocation_request_out->allocation.size = region->size;
+    allocation_request_out->peek.addr = addr;
+    allocation_request_out->peek.end = (void *)region_end;
+    allocation_request_out->peek.total_bytes_left = region_end - (uintptr_t)addr;
+    return 0;
 }
 
 int process_validate_memory_or_terminate(struct process *process, void *virt_addr, size_t space_needed)
@@ -1227,7 +1466,7 @@ int process_fstat(struct process *process, int fd, struct file_stat *virt_filest
         goto out;
     }
 
-    struct file_stat *phys_filestat_addr = process_virtual_address_to_physical(process, virt_filestat_addr);
+    struct file_stat *phys_filestat_addr = process_virtual_address_to_physical_for_write(process, virt_filestat_addr);
     if (!phys_filestat_addr)
     {
         res = -EINVARG;
@@ -1243,6 +1482,135 @@ int process_fstat(struct process *process, int fd, struct file_stat *virt_filest
 out:
     return res;
 }
+int process_kheap_stats(struct process *process, struct kheap_stats *virt_stats_addr)
+{
+    int res = 0;
+    res = process_validate_memory_or_terminate(process, virt_stats_addr, sizeof(*virt_stats_addr));
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    struct kheap_stats *phys_stats_addr = process_virtual_address_to_physical_for_write(process, virt_stats_addr);
+    if (!phys_stats_addr)
+    {
+        res = -EINVARG;
+        goto out;
+    }
+
+    kheap_stats(phys_stats_addr);
+
+out:
+    return res;
+}
+
+/**
+ * Applies the KHEAP_TRACE_REQUEST flags and copies the traced kernel heap calls
+ * to the process, returns the total entries copied
+ */
+int process_kheap_trace(struct process *process, struct kheap_trace_entry *virt_entries_addr, size_t max_entries, int flags)
+{
+    int res = 0;
+    if (flags & KHEAP_TRACE_REQUEST_ENABLE)
+    {
+        kheap_trace_enable(true);
+    }
+    else if (flags & KHEAP_TRACE_REQUEST_DISABLE)
+    {
+        kheap_trace_enable(false);
+    }
+
+    if (max_entries == 0)
+    {
+        goto out;
+    }
+
+    // No more than the ring holds are ever copied, clamping first also keeps the size from wrapping
+    max_entries = MIN(max_entries, PEACHOS_KHEAP_TRACE_ENTRIES);
+    res = process_validate_memory_or_terminate(process, virt_entries_addr, sizeof(*virt_entries_addr) * max_entries);
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    struct kheap_trace_entry *phys_entries_addr = process_virtual_address_to_physical_for_write(process, virt_entries_addr);
+    if (!phys_entries_addr)
+    {
+        res = -EINVARG;
+        goto out;
+    }
+
+    res = kheap_trace_copy(phys_entries_addr, max_entries, flags & KHEAP_TRACE_REQUEST_LIVE_ONLY);
+
+out:
+    return res;
+}
+
+/**
+ * Copies up to max_phases timed boot phases to the process, returns the total copied
+ */
+int process_boot_trace(struct process *process, struct boot_trace_phase *virt_phases_addr, size_t max_phases)
+{
+    int res = 0;
+    if (max_phases == 0)
+    {
+        goto out;
+    }
+
+    // Clamped before the size is computed so it cannot wrap
+    max_phases = MIN(max_phases, PEACHOS_BOOT_TRACE_MAX_PHASES);
+    res = process_validate_memory_or_terminate(process, virt_phases_addr, sizeof(*virt_phases_addr) * max_phases);
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    struct boot_trace_phase *phys_phases_addr = process_virtual_address_to_physical_for_write(process, virt_phases_addr);
+    if (!phys_phases_addr)
+    {
+        res = -EINVARG;
+        goto out;
+    }
+
+    res = boot_trace_copy(phys_phases_addr, max_phases);
+
+out:
+    return res;
+}
+
+int process_window_redraw_regions(struct process *process, struct window *window, struct window_rect *virt_rects, size_t total_rects)
+{
+    int res = 0;
+    if (total_rects == 0)
+    {
+        goto out;
+    }
+
+    if (total_rects > WINDOW_MAX_REDRAW_RECTS)
+    {
+        res = -EINVARG;
+        goto out;
+    }
+
+    res = process_validate_memory_or_terminate(process, virt_rects, sizeof(*virt_rects) * total_rects);
+    if (res < 0)
+    {
+        goto out;
+    }
+
+    struct window_rect *phys_rects = process_virtual_address_to_physical(process, virt_rects);
+    if (!phys_rects)
+    {
+        res = -EINVARG;
+        goto out;
+    }
+
+    window_redraw_body_regions(window, phys_rects, total_rects);
+
+out:
+    return res;
+}
+
 int process_fseek(struct process *process, int fd, int offset, FILE_SEEK_MODE whence)
 {
     int res = 0;
@@ -1275,7 +1643,7 @@ int process_fread(struct process *process, void *virt_ptr, uint64_t size, uint64
         goto out;
     }
 
-    void *phys_ptr = task_virtual_address_to_physical(process->task, virt_ptr);
+    void *phys_ptr = task_virtual_address_to_physical_for_write(process->task, virt_ptr);
     if (!phys_ptr)
     {
         goto out;
@@ -1391,18 +1759,21 @@ int process_map_into_userspace(struct process* process, void* phys_ptr, size_t t
         goto out;
     }
 
-    virt_ptr = process_malloc(process, t_size);
-    if (!virt_ptr)
+    // Only a virtual range is needed, the physical memory already exists
+    struct vma_region *region = NULL;
+    res = vma_reserve(process->vmas, t_size, VMA_REGION_TYPE_MAPPING, &region);
+    if (res < 0)
     {
-        res = -ENOMEM;
         goto out;
     }
+    virt_ptr = (void *)region->start;
 
     map_flags |= PAGING_ACCESS_FROM_ALL;
-    res = paging_map_range(process->paging_desc, virt_ptr, phys_ptr, t_size, map_flags);
+    res = paging_map_range(process->paging_desc, virt_ptr, phys_ptr, t_size / PAGING_PAGE_SIZE, map_flags);
     if (res < 0)
     {
         // map error
+        vma_release(process->vmas, region->start);
         goto out;
     }
 
@@ -1435,7 +1806,8 @@ int process_map_graphics_framebuffer_pixels_into_userspace(struct process* proce
 
     size_t memory_size = paging_align_value_to_upper_page(graphics_width * graphics_height * sizeof(struct framebuffer_pixel));
 
-    int map_flags = PAGING_ACCESS_FROM_ALL | PAGING_CACHE_DISABLED | PAGING_IS_PRESENT | PAGING_IS_WRITEABLE;
+    // The pixels are ordinary memory, write back caching is safe
+    int map_flags = PAGING_ACCESS_FROM_ALL | PAGING_CACHE_WRITE_BACK | PAGING_IS_PRESENT | PAGING_IS_WRITEABLE;
 
     res = process_map_into_userspace(process, pixels, memory_size, map_flags, (void**) virt_addr_out);
     if (res < 0)
@@ -33,6 +33,7 @@
 #include "task.h"
 #include "fs/file.h"
 #include "config.h"
+#include "lib/list/list.h"
 
 #define PROCESS_FILETYPE_ELF 0
 #define PROCESS_FILETYPE_BINARY 1
@@ -44,6 +45,7 @@ struct window;
 struct graphics_info;
 struct window_event;
 struct framebuffer_pixel;
+struct vma_tree;
 
 struct process_allocation
 {
@@ -106,6 +108,11 @@ struct process_window
 {
     struct process_userspace_window* user_win;
     struct window* kernel_win;
+
+    // The process that owns the window
+    struct process* process;
+    // Node in the process windows list
+    struct list_node list_node;
 };
 
 struct process
@@ -125,11 +132,12 @@ struct process
 
 
 
-    // The memory (malloc) allocations of the process
-    struct vector* allocations;
+    // Every reserved range of the address space, heap allocations, the stack,
+    // the program and mappings such as framebuffers
+    struct vma_tree* vmas;
     
-    // a vector of struct userland_ptr*
-    struct vector* kernel_userland_ptrs_vector;
+    // Every struct userland_ptr* given to the process, keyed by its address
+    struct hashmap* kernel_userland_ptrs;
 
     // File handle vector,
     // vector of struct process_file_handle*
@@ -143,6 +151,10 @@ struct process
         void* ptr;
         struct elf_file* elf_file;
     };
+
+    // Private copies of writable elf pages this process has written to
+    // vector of void*
+    struct vector* elf_pages;
     
 
     // The physical pointer to the stack memory
@@ -158,8 +170,10 @@ struct process
         int head;
     } keyboard;
 
-    // a vector of struct process_window*
-    struct vector* windows;
+    // List of struct process_window
+    struct list windows;
+    // Maps the userspace window to its struct process_window*
+    struct hashmap* windows_by_user_win;
 
     struct
     {
@@ -175,7 +189,7 @@ struct process
     struct process_window* sysout_win;
 };
 
-void process_system_init();
+int process_system_init();
 int process_switch(struct process* process);
 int process_load_switch(const char* filename, struct process** process);
 int process_load(const char* filename, struct process** process);
@@ -197,14 +211,41 @@ int process_fread(struct process* process, void* virt_ptr, uint64_t size, uint64
 int process_fseek(struct process* process, int fd, int offset, FILE_SEEK_MODE whence);
 int process_fstat(struct process* process, int fd, struct file_stat* virt_filestat_addr);
 
+struct kheap_stats;
+struct kheap_trace_entry;
+int process_kheap_stats(struct process* process, struct kheap_stats* virt_stats_addr);
+int process_kheap_trace(struct process* process, struct kheap_trace_entry* virt_entries_addr, size_t max_entries, int flags);
+
+struct boot_trace_phase;
+int process_boot_trace(struct process* process, struct boot_trace_phase* virt_phases_addr, size_t max_phases);
+
 struct process_window* process_window_create(struct process* process, char* title, int width, int height, int flags, int id);
 bool process_owns_kernel_window(struct process* process, struct window* kernel_window);
 struct process* process_get_from_kernel_window(struct window* window);
+struct window_rect;
+
+/**
+ * Redraws the rectangles of the window body held in process memory as one batch
+ */
+int process_window_redraw_regions(struct process* process, struct window* window, struct window_rect* virt_rects, size_t total_rects);
 struct process_window* process_window_get_from_user_window(struct process* process, struct process_userspace_window* user_win);
 void process_close_windows(struct process* process);
 
 void process_print_char(struct process* process, char c);
 void process_print(struct process* process, const char* message);
+int process_write(struct process* process, void* virt_ptr, size_t len);
+int process_terminal_scrollback(struct process* process, size_t rows_back);
+int process_page_in(struct process* process, void* virt, bool write);
+int process_page_privatize(struct process* process, void* virt);
+/**
+ * Translates a process address the kernel only reads through, shared elf pages may be returned
+ */
+void* process_virtual_address_to_physical(struct process* process, void* virt_addr);
+
+/**
+ * Translates a process address the kernel writes through, the page is made private to the process first
+ */
+void* process_virtual_address_to_physical_for_write(struct process* process, void* virt_addr);
 void process_set_sysout_window(struct process* process, struct process_window* win);
 int process_push_window_event(struct process* process, struct window_event* event);
 int process_pop_window_event(struct process* process, struct window_event* event_out);
@@ -33,6 +33,7 @@
 #include "memory/memory.h"
 #include "string/string.h"
 #include "memory/paging/paging.h"
+#include "memory/frame/frame.h"
 #include "loader/formats/elfloader.h"
 #include "idt/idt.h"
 
@@ -143,7 +144,11 @@ void task_next()
         }
         if (!next_task)
         {
-            udelay(100);
+            // Nothing to run, zero some pages for later instead of just waiting
+            if (frame_zero_pool_refill(PEACHOS_FRAME_ZERO_POOL_REFILL_BATCH) == 0)
+            {
+                udelay(100);
+            }
         }
     } while(!next_task);
 
@@ -318,7 +323,12 @@ void* task_get_stack_item(struct task* task, int index)
 
 void* task_virtual_address_to_physical(struct task* task, void* virtual_address)
 {
-    return paging_get_physical_address(task->process->paging_desc, virtual_address);
+    return process_virtual_address_to_physical(task->process, virtual_address);
+}
+
+void* task_virtual_address_to_physical_for_write(struct task* task, void* virtual_address)
+{
+    return process_virtual_address_to_physical_for_write(task->process, virtual_address);
 }
 
 int task_get_next_non_sleeping_task(struct task** task_out)
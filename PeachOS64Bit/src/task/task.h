@@ -96,6 +96,7 @@ void task_current_save_state(struct interrupt_frame *frame);
 int copy_string_from_task(struct task* task, void* virtual, void* phys, int max);
 void* task_get_stack_item(struct task* task, int index);
 void* task_virtual_address_to_physical(struct task* task, void* virtual_address);
+void* task_virtual_address_to_physical_for_write(struct task* task, void* virtual_address);
 void task_next();
 
 struct paging_desc* task_paging_desc(struct task* task);
@@ -27,7 +27,7 @@
 
 #include "userlandptr.h"
 #include "memory/heap/kheap.h"
-#include "lib/vector/vector.h"
+#include "lib/hashmap/hashmap.h"
 #include "task/process.h"
 struct userland_ptr* process_userland_pointer_create(struct process* process, void* kernel_ptr)
 {
@@ -38,7 +38,11 @@ struct userland_ptr* process_userland_pointer_create(struct process* process, vo
     }
 
     userland_ptr->kernel_ptr = kernel_ptr;
-    vector_push(process->kernel_userland_ptrs_vector, &userland_ptr);
+    if (hashmap_set(process->kernel_userland_ptrs, (uint64_t) userland_ptr, userland_ptr) < 0)
+    {
+        kfree(userland_ptr);
+        return NULL;
+    }
     return userland_ptr;
 }
 
@@ -49,24 +53,35 @@ void process_userland_pointer_release(struct process* process, void* userland_pt
         return;
     }
 
-    vector_pop_element(process->kernel_userland_ptrs_vector, &userland_ptr, sizeof(userland_ptr));
+    hashmap_remove(process->kernel_userland_ptrs, (uint64_t) userland_ptr);
     kfree(userland_ptr);
 }
 
 bool process_userland_pointer_registered(struct process* process, void* userland_ptr)
 {
-    size_t total_userland_ptrs = vector_count(process->kernel_userland_ptrs_vector);
-    for(size_t i = 0; i < total_userland_ptrs; i++)
+    return hashmap_has(process->kernel_userland_ptrs, (uint64_t) userland_ptr);
+}
+
+/**
+ * Releases every userland pointer of the process, called as the process is freed
+ */
+void process_userland_pointers_free(struct process* process)
+{
+    if (!process->kernel_userland_ptrs)
+    {
+        return;
+    }
+
+    size_t iterator = 0;
+    uint64_t key = 0;
+    void* userland_ptr = NULL;
+    while(hashmap_next(process->kernel_userland_ptrs, &iterator, &key, &userland_ptr))
     {
-        struct userland_ptr* current_ptr = NULL;
-        vector_at(process->kernel_userland_ptrs_vector, i, &current_ptr, sizeof(current_ptr));
-        if (current_ptr && current_ptr == userland_ptr)
-        {
-            return true;
-        }
+        kfree(userland_ptr);
     }
 
-    return false;
+    hashmap_free(process->kernel_userland_ptrs);
+    process->kernel_userland_ptrs = NULL;
 }
 
 
@@ -41,5 +41,6 @@ struct userland_ptr* process_userland_pointer_create(struct process* process, vo
 void process_userland_pointer_release(struct process* process, void* userland_ptr);
 bool process_userland_pointer_registered(struct process* process, void* userland_ptr);
 void* process_userland_pointer_kernel_ptr(struct process* process, void* userland_ptr);
+void process_userland_pointers_free(struct process* process);
 
 #endif
\ No newline at end of file